@@ -0,0 +1,51 @@
+#ifndef ARCHETYPES_H
+#define ARCHETYPES_H
+
+// Monster archetype table. Adding a monster type is one row here.
+//
+//   X(id, name, textureIndex, texturePath,
+//     healthBase, healthRange, powerBase, powerRange,
+//     behavior, projectileType, moveCooldown, combatCooldown, moveStep)
+//
+// projectileType is only used by BEHAVIOR_RANGED (0=lightning, 1=fireball).
+// Cooldowns are in frames; combatCooldown applies while adjacent to the player.
+#define MONSTER_ARCHETYPES(X)                                                                     \
+  X(DRAGON, "Dragon", 1, "emojis/1f409.png", 20, 30, 3, 5, BEHAVIOR_RANGED, 1, 9, 18, 1)          \
+  X(GOBLIN, "Goblin", 2, "emojis/1f47a.png", 20, 30, 3, 5, BEHAVIOR_WANDER, 0, 12, 24, 1)         \
+  X(OGRE, "Ogre", 3, "emojis/1f479.png", 20, 30, 3, 5, BEHAVIOR_WANDER, 0, 12, 24, 1)             \
+  X(TROLL, "Troll", 4, "emojis/1f47f.png", 20, 30, 3, 5, BEHAVIOR_CHASE, 0, 6, 12, 2)             \
+  X(WIZARD, "Wizard", 5, "emojis/1f9d9.png", 20, 30, 3, 5, BEHAVIOR_RANGED, 0, 9, 18, 1)
+
+typedef enum
+{
+  BEHAVIOR_CHASE,  // Charge straight at the player
+  BEHAVIOR_RANGED, // Shoot at the player while backing away
+  BEHAVIOR_WANDER, // Random walk
+  BEHAVIOR_COUNT
+} MonsterBehavior;
+
+typedef enum
+{
+#define X(id, ...) ARCHETYPE_##id,
+  MONSTER_ARCHETYPES(X)
+#undef X
+  ARCHETYPE_COUNT
+} MonsterArchetype;
+
+typedef struct
+{
+  const char *name;
+  int textureIndex;
+  const char *texturePath;
+  int healthBase, healthRange;
+  int powerBase, powerRange;
+  MonsterBehavior behavior;
+  int projectileType;
+  int moveCooldown;
+  int combatCooldown;
+  int moveStep;
+} ArchetypeInfo;
+
+extern const ArchetypeInfo archetypes[ARCHETYPE_COUNT];
+
+#endif
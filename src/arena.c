@@ -0,0 +1,103 @@
+#include "types.h"
+#include "globals.h"
+#include "arena.h"
+#include "jobs.h"
+#include <stdlib.h>
+
+// Scratch memory for one simulation tick. Every job thread bumps a pointer
+// through its own block, so allocating is an add and a compare with no
+// locking, and the end of the tick resets every arena in O(1) per thread.
+//
+// An allocation that does not fit is served from the heap for the rest of
+// the tick and counted. At the reset the arena grows to the tick's total,
+// so after a few warm-up ticks a steady simulation allocates nothing;
+// frameArenaStats.lastHeapTick shows when it last had to.
+
+void *frameAlloc(size_t size)
+{
+  FrameArena *arena = &world->arenas[jobThreadIndex()];
+  size = (size + FRAME_ARENA_ALIGN - 1) & ~(size_t)(FRAME_ARENA_ALIGN - 1);
+  if (size == 0)
+    size = FRAME_ARENA_ALIGN; // Still a distinct, non-NULL pointer
+  arena->wanted += size;
+  if (arena->used + size <= arena->capacity)
+  {
+    void *memory = arena->base + arena->used;
+    arena->used += size;
+    return memory;
+  }
+
+  arena->overflows++;
+  arena->heapAllocations++;
+  OverflowBlock *block = malloc(sizeof(OverflowBlock) + size);
+  if (block == NULL)
+    return NULL;
+  block->next = arena->overflow;
+  arena->overflow = block;
+  return block + 1;
+}
+
+static void freeOverflow(FrameArena *arena)
+{
+  while (arena->overflow != NULL)
+  {
+    OverflowBlock *next = arena->overflow->next;
+    free(arena->overflow);
+    arena->overflow = next;
+  }
+}
+
+void resetFrameArenas()
+{
+  FrameArenaStats stats = world->frameArenaStats;
+  stats.capacity = 0;
+  stats.used = 0;
+  stats.heapAllocations = 0;
+
+  for (int i = 0; i < jobThreadCount(); i++)
+  {
+    FrameArena *arena = &world->arenas[i];
+    freeOverflow(arena);
+
+    // Grow to fit everything this tick asked for, so next tick fits
+    if (arena->wanted > arena->capacity)
+    {
+      size_t capacity = FRAME_ARENA_MIN_SIZE;
+      while (capacity < arena->wanted)
+        capacity *= 2;
+      free(arena->base);
+      arena->base = malloc(capacity);
+      arena->capacity = arena->base != NULL ? capacity : 0;
+      arena->heapAllocations++;
+    }
+
+    stats.capacity += arena->capacity;
+    stats.used += arena->wanted;
+    if (arena->wanted > stats.highWater)
+      stats.highWater = arena->wanted;
+    stats.overflows += arena->overflows;
+    stats.heapAllocations += arena->heapAllocations;
+    arena->used = 0;
+    arena->wanted = 0;
+    arena->overflows = 0;
+    arena->heapAllocations = 0;
+  }
+
+  if (stats.heapAllocations > 0)
+    stats.lastHeapTick = world->gameTick;
+  world->frameArenaStats = stats;
+}
+
+// Gives every arena's memory back (a batch world being destroyed)
+void freeFrameArenas()
+{
+  for (int i = 0; i < MAX_JOB_THREADS; i++)
+  {
+    freeOverflow(&world->arenas[i]);
+    free(world->arenas[i].base);
+    world->arenas[i].base = NULL;
+    world->arenas[i].capacity = 0;
+    world->arenas[i].used = 0;
+    world->arenas[i].wanted = 0;
+  }
+}
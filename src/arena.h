@@ -0,0 +1,47 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "types.h"
+#include <stddef.h>
+
+#define FRAME_ARENA_MIN_SIZE (64 << 10) // Smallest block a thread's arena grows to
+#define FRAME_ARENA_ALIGN 16            // Every allocation starts on this boundary
+
+// Frame arena statistics (refreshed at the end of every tick)
+typedef struct
+{
+  size_t capacity;           // Bytes reserved across all threads' arenas
+  size_t used;               // Bytes handed out during the last tick
+  size_t highWater;          // Most bytes one thread has used in one tick
+  int overflows;             // Allocations that did not fit their arena, so far
+  int heapAllocations;       // mallocs during the last tick (0 once the arenas have grown to fit)
+  unsigned int lastHeapTick; // Tick of the most recent malloc
+} FrameArenaStats;
+
+typedef struct OverflowBlock
+{
+  struct OverflowBlock *next;
+  size_t padding; // Keeps the allocation after the header FRAME_ARENA_ALIGN aligned
+} OverflowBlock;
+
+// One job thread's arena (World.arenas, indexed by jobThreadIndex)
+typedef struct
+{
+  unsigned char *base;
+  size_t capacity;
+  size_t used;            // Bytes bumped out of base
+  size_t wanted;          // Bytes asked for this tick, including overflow
+  OverflowBlock *overflow; // Heap blocks to free at the reset
+  int overflows;
+  int heapAllocations;
+} FrameArena;
+
+// Function declarations for the per-tick scratch arenas. frameAlloc hands
+// out memory from the calling thread's arena (the simulation thread or a job
+// worker) that stays valid until resetFrameArenas at the end of the tick.
+// It only returns NULL when the process is out of memory.
+void *frameAlloc(size_t size);
+void resetFrameArenas();
+void freeFrameArenas();
+
+#endif
@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+#include "types.h"
+#include "globals.h"
+#include "game.h"
+#include "input.h"
+#include "rng.h"
+#include "savestate.h"
+#include "observation.h"
+#include "batch.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Worlds are heap-allocated World structs stepped by a fixed pool of threads:
+// one per CPU core (fewer if there are fewer worlds), the caller's thread
+// being one of them. For each task the threads take worlds off a shared
+// counter, point world at the one they took and run it there, so a thread
+// steps many worlds and a world costs only its own memory. Worlds never run
+// jobs on the shared pool (initJobs is not called), so parallelFor runs
+// inline on whichever thread has the world and worlds share nothing while
+// they step.
+
+typedef enum
+{
+  BATCH_CREATE, // Seed and generate every world
+  BATCH_STEP,   // Run every world's action
+  BATCH_STOP,   // Helper threads exit
+} BatchTask;
+
+struct WorldBatch
+{
+  int worldCount;
+  World **worlds;
+  int helperCount; // Pool threads besides the caller's
+  pthread_t *helpers;
+
+  // Helpers sleep on wake until generation moves on, run the task, and the
+  // last one to finish signals finished
+  pthread_mutex_t lock;
+  pthread_cond_t wake, finished;
+  unsigned int generation;
+  int running; // Helpers still on the current task
+
+  // The task being run (read by the pool threads while it runs)
+  BatchTask task;
+  int nextWorld; // Next world to take (atomic)
+  const unsigned int *seeds;
+  const unsigned int *actions;
+  int ticks;
+  float *rewards;
+  unsigned char *dones;
+  unsigned char *observations;
+};
+
+// Experience earned since level 1: level n took n * 100 to reach n + 1
+static float totalExperience()
+{
+  return 50.0f * world->player.level * (world->player.level - 1) + world->player.experience;
+}
+
+static void stepWorld(WorldBatch *batch, int index)
+{
+  unsigned int action = batch->actions[index] & ~(unsigned int)INPUT_CLICKED;
+  float reward = 0.0f;
+  int died = 0;
+
+  for (int t = 0; t < batch->ticks && !died; t++)
+  {
+    float experience = totalExperience();
+    int health = world->player.health;
+    inputFromMask(&world->input, action, 0, 0);
+    simulationTick();
+    consumeInput(&world->input);
+
+    float gained = totalExperience() - experience;
+    if (gained > 0.0f) // A restart action resets experience; that is not a loss
+      reward += gained;
+    if (world->player.health < health)
+      reward -= health - world->player.health;
+    died = !world->player.alive;
+  }
+
+  if (died)
+    restartGame();
+  batch->rewards[index] = reward;
+  batch->dones[index] = (unsigned char)died;
+  if (batch->observations != NULL)
+    encodeObservation(batch->observations + (size_t)index * OBSERVATION_BYTES);
+}
+
+// Takes worlds off the counter until the task has run in all of them
+static void runTask(WorldBatch *batch)
+{
+  for (;;)
+  {
+    int index = __atomic_fetch_add(&batch->nextWorld, 1, __ATOMIC_RELAXED);
+    if (index >= batch->worldCount)
+      break;
+    world = batch->worlds[index];
+    if (batch->task == BATCH_CREATE)
+    {
+      seedRandom(batch->seeds[index]);
+      setStateRingDepth(0);
+      initGame();
+    }
+    else
+      stepWorld(batch, index);
+  }
+  world = NULL;
+}
+
+static void *helperMain(void *arg)
+{
+  WorldBatch *batch = arg;
+  unsigned int seen = 0;
+
+  pthread_mutex_lock(&batch->lock);
+  for (;;)
+  {
+    while (batch->generation == seen)
+      pthread_cond_wait(&batch->wake, &batch->lock);
+    seen = batch->generation;
+    if (batch->task == BATCH_STOP)
+      break;
+    pthread_mutex_unlock(&batch->lock);
+    runTask(batch);
+    pthread_mutex_lock(&batch->lock);
+    if (--batch->running == 0)
+      pthread_cond_signal(&batch->finished);
+  }
+  pthread_mutex_unlock(&batch->lock);
+  return NULL;
+}
+
+// Hands a task to the helpers, runs it alongside them and waits for them
+static void runBatchTask(WorldBatch *batch, BatchTask task)
+{
+  pthread_mutex_lock(&batch->lock);
+  batch->task = task;
+  batch->nextWorld = 0;
+  batch->running = batch->helperCount;
+  batch->generation++;
+  pthread_cond_broadcast(&batch->wake);
+  pthread_mutex_unlock(&batch->lock);
+  if (task == BATCH_STOP)
+    return;
+
+  runTask(batch);
+  pthread_mutex_lock(&batch->lock);
+  while (batch->running > 0)
+    pthread_cond_wait(&batch->finished, &batch->lock);
+  pthread_mutex_unlock(&batch->lock);
+}
+
+static void freeBatch(WorldBatch *batch)
+{
+  for (int i = 0; i < batch->worldCount; i++)
+  {
+    if (batch->worlds[i] == NULL)
+      continue;
+    world = batch->worlds[i];
+    freeWorld();
+    free(batch->worlds[i]);
+  }
+  world = NULL;
+  pthread_mutex_destroy(&batch->lock);
+  pthread_cond_destroy(&batch->wake);
+  pthread_cond_destroy(&batch->finished);
+  free(batch->helpers);
+  free(batch->worlds);
+  free(batch);
+}
+
+WorldBatch *createWorldBatch(int worldCount, const unsigned int *seeds)
+{
+  if (worldCount < 1)
+    return NULL;
+  WorldBatch *batch = calloc(1, sizeof(WorldBatch));
+  if (batch == NULL)
+    return NULL;
+  pthread_mutex_init(&batch->lock, NULL);
+  pthread_cond_init(&batch->wake, NULL);
+  pthread_cond_init(&batch->finished, NULL);
+
+  int threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threadCount > worldCount)
+    threadCount = worldCount;
+  if (threadCount < 1)
+    threadCount = 1;
+  batch->worlds = calloc(worldCount, sizeof(World *));
+  batch->helpers = calloc(threadCount, sizeof(pthread_t));
+  if (batch->worlds == NULL || batch->helpers == NULL)
+  {
+    freeBatch(batch);
+    return NULL;
+  }
+  batch->worldCount = worldCount;
+  for (int i = 0; i < worldCount; i++)
+  {
+    batch->worlds[i] = malloc(sizeof(World));
+    if (batch->worlds[i] == NULL)
+    {
+      freeBatch(batch);
+      return NULL;
+    }
+    initWorld(batch->worlds[i]);
+  }
+
+  // A helper that will not start just leaves the others more worlds each
+  while (batch->helperCount < threadCount - 1 &&
+         pthread_create(&batch->helpers[batch->helperCount], NULL, helperMain, batch) == 0)
+    batch->helperCount++;
+
+  batch->seeds = seeds;
+  runBatchTask(batch, BATCH_CREATE);
+  batch->seeds = NULL;
+  return batch;
+}
+
+void stepWorldBatch(WorldBatch *batch, const unsigned int *actions, int ticks, float *rewards,
+                    unsigned char *dones, unsigned char *observations)
+{
+  batch->actions = actions;
+  batch->ticks = ticks;
+  batch->rewards = rewards;
+  batch->dones = dones;
+  batch->observations = observations;
+  runBatchTask(batch, BATCH_STEP);
+}
+
+int worldBatchSize(const WorldBatch *batch)
+{
+  return batch->worldCount;
+}
+
+void destroyWorldBatch(WorldBatch *batch)
+{
+  if (batch == NULL)
+    return;
+  runBatchTask(batch, BATCH_STOP);
+  for (int i = 0; i < batch->helperCount; i++)
+    pthread_join(batch->helpers[i], NULL);
+  freeBatch(batch);
+}
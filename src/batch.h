@@ -0,0 +1,27 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Batch simulation: many independent worlds in one process, stepped in
+// lockstep. Built into libgridlock-batch.a with GRIDLOCK_BATCH defined, where
+// the simulation reaches its state through a per-thread World pointer, so a
+// fixed pool of threads (one per CPU core) can step any number of worlds.
+// Actions are input masks (INPUT_* from input.h); the
+// click bit is ignored, since an action has no cell to click.
+typedef struct WorldBatch WorldBatch;
+
+// Function declarations for batch simulation. createWorldBatch returns NULL
+// if the worlds could not be allocated; seeds holds one seed per world.
+// stepWorldBatch runs every world for up to ticks ticks with its action held
+// and fills one reward and one done flag per world: the reward is experience
+// gained minus health lost, and done means the player died, in which case the
+// world has already restarted (and stopped stepping early) for the next call.
+// Unless observations is NULL, each world then encodes its observation into
+// its own OBSERVATION_BYTES of it (world i at i * OBSERVATION_BYTES); a step
+// of 0 ticks only observes.
+WorldBatch *createWorldBatch(int worldCount, const unsigned int *seeds);
+void stepWorldBatch(WorldBatch *batch, const unsigned int *actions, int ticks, float *rewards,
+                    unsigned char *dones, unsigned char *observations);
+int worldBatchSize(const WorldBatch *batch);
+void destroyWorldBatch(WorldBatch *batch);
+
+#endif
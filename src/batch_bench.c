@@ -0,0 +1,131 @@
+#include "input.h"
+#include "batch.h"
+#include "observation.h"
+#include "platform.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// gridlock-batch: steps a batch of worlds with a fixed action pattern and
+// reports the throughput, as a check on libgridlock-batch.a
+//
+// usage: gridlock-batch [worlds] [ticks] [seed] [--observe]
+//   worlds     Worlds in the batch (default 8)
+//   ticks      Ticks each world runs (default 3600), one tick per step
+//   seed       World i gets seed + i (default 1)
+//   --observe  Encode every world's observation after every step
+
+static void printUsage(FILE *out)
+{
+  fprintf(out, "usage: gridlock-batch [worlds] [ticks] [seed] [--observe]\n");
+}
+
+// A whole decimal number, nothing before or after it
+static int parseCount(const char *text, unsigned long *value)
+{
+  char *end;
+  if (text[0] < '0' || text[0] > '9')
+    return 0;
+  *value = strtoul(text, &end, 10);
+  return *end == '\0';
+}
+
+int main(int argc, char **argv)
+{
+  int worldCount = 8;
+  int ticks = 3600;
+  unsigned int seed = 1;
+  int observe = 0;
+
+  int positional = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    const char *option = argv[i];
+    if (strcmp(option, "--help") == 0 || strcmp(option, "-h") == 0)
+    {
+      printUsage(stdout);
+      return 0;
+    }
+    if (strcmp(option, "--observe") == 0)
+    {
+      observe = 1;
+      continue;
+    }
+    if (option[0] == '-')
+    {
+      fprintf(stderr, "unknown option %s\n", option);
+      printUsage(stderr);
+      return 1;
+    }
+
+    unsigned long number;
+    if (positional == 3 || !parseCount(option, &number))
+    {
+      fprintf(stderr, positional == 3 ? "unexpected argument %s\n" : "%s is not a number\n", option);
+      printUsage(stderr);
+      return 1;
+    }
+    if (positional == 0)
+      worldCount = number > INT_MAX ? INT_MAX : (int)number;
+    else if (positional == 1)
+      ticks = number > INT_MAX ? INT_MAX : (int)number;
+    else
+      seed = (unsigned int)number;
+    positional++;
+  }
+  if (worldCount < 1 || ticks < 1)
+  {
+    fprintf(stderr, "worlds and ticks must be at least 1\n");
+    printUsage(stderr);
+    return 1;
+  }
+
+  unsigned int *seeds = malloc(sizeof(unsigned int) * worldCount);
+  unsigned int *actions = malloc(sizeof(unsigned int) * worldCount);
+  float *rewards = malloc(sizeof(float) * worldCount);
+  unsigned char *dones = malloc(worldCount);
+  unsigned char *observations = observe ? malloc((size_t)worldCount * OBSERVATION_BYTES) : NULL;
+  if (seeds == NULL || actions == NULL || rewards == NULL || dones == NULL || (observe && observations == NULL))
+    return 1;
+  for (int i = 0; i < worldCount; i++)
+    seeds[i] = seed + i;
+
+  double start = platformTimer();
+  WorldBatch *batch = createWorldBatch(worldCount, seeds);
+  if (batch == NULL)
+  {
+    fprintf(stderr, "could not start %d worlds\n", worldCount);
+    return 1;
+  }
+  double created = platformTimer();
+
+  // Each world walks its own turning square (the headless bot's pattern) and shoots
+  static const unsigned int sides[4] = {INPUT_UP, INPUT_RIGHT, INPUT_DOWN, INPUT_LEFT};
+  double totalReward = 0.0;
+  int deaths = 0;
+  for (int tick = 0; tick < ticks; tick++)
+  {
+    for (int i = 0; i < worldCount; i++)
+      actions[i] = sides[(tick / 120 + i) % 4] | INPUT_SHOOT;
+    stepWorldBatch(batch, actions, 1, rewards, dones, observations);
+    for (int i = 0; i < worldCount; i++)
+    {
+      totalReward += rewards[i];
+      deaths += dones[i];
+    }
+  }
+  double elapsed = platformTimer() - created;
+  destroyWorldBatch(batch);
+
+  printf("%d worlds created in %.3f s; %d ticks each in %.3f s (%.0f world-ticks/s)\n", worldCount,
+         created - start, ticks, elapsed, (double)worldCount * ticks / elapsed);
+  printf("total reward %.0f, %d deaths\n", totalReward, deaths);
+
+  free(seeds);
+  free(actions);
+  free(rewards);
+  free(dones);
+  free(observations);
+  return 0;
+}
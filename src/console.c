@@ -0,0 +1,180 @@
+#include "types.h"
+#include "globals.h"
+#include "console.h"
+#include "tunables.h"
+#include "simthread.h"
+#include "replay.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// In-game console for the tunables registry. Commands:
+//   name value   set a tunable (applied on the next tick)
+//   name         show its value, default, range and description
+//   list [text]  every tunable (whose name contains text) with its value
+//   reset [name] back to the default, for one tunable or all of them
+// Values are read from the newest snapshot and changes go to the simulation
+// through submitTunable, so the console never touches simulation state.
+
+static int consoleVisible = 0;
+static char typed[CONSOLE_LINE_SIZE];
+static int typedLength = 0;
+static char lines[CONSOLE_LINES][CONSOLE_LINE_SIZE];
+static int lineCount = 0; // Lines printed so far; the last CONSOLE_LINES are shown
+
+static void print(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  vsnprintf(lines[lineCount++ % CONSOLE_LINES], CONSOLE_LINE_SIZE, format, args);
+  va_end(args);
+}
+
+// A replay holds the settings it was recorded with
+static int replayRunning(const WorldSnapshot *snapshot)
+{
+  if (snapshot->replayStats.mode != REPLAY_RECORDING && snapshot->replayStats.mode != REPLAY_PLAYING)
+    return 0;
+  print("a replay is running with its own settings");
+  return 1;
+}
+
+static void listTunables(const WorldSnapshot *snapshot, const char *filter)
+{
+  char line[CONSOLE_LINE_SIZE] = "";
+  int shown = 0;
+  for (int i = 0; i < TUNABLE_COUNT; i++)
+  {
+    if (filter && !strstr(world->tunables[i].name, filter))
+      continue;
+    char entry[64];
+    snprintf(entry, sizeof(entry), "%s=%d", world->tunables[i].name, snapshot->tunables[i]);
+    if (strlen(line) + strlen(entry) + 2 >= 72)
+    {
+      print("%s", line);
+      line[0] = '\0';
+    }
+    if (line[0])
+      strcat(line, "  ");
+    strcat(line, entry);
+    shown++;
+  }
+  if (line[0])
+    print("%s", line);
+  if (shown == 0)
+    print("no tunable matches %s", filter);
+}
+
+static void execute(const WorldSnapshot *snapshot, char *command)
+{
+  char *name = strtok(command, " \t");
+  char *argument = strtok(NULL, " \t");
+  if (name == NULL)
+    return;
+
+  if (strcmp(name, "help") == 0)
+  {
+    print("name value | name | list [text] | reset [name]");
+    return;
+  }
+  if (strcmp(name, "list") == 0)
+  {
+    listTunables(snapshot, argument);
+    return;
+  }
+
+  int reset = strcmp(name, "reset") == 0;
+  if (reset && argument == NULL)
+  {
+    if (replayRunning(snapshot))
+      return;
+    for (int i = 0; i < TUNABLE_COUNT; i++)
+      submitTunable(i, world->tunables[i].defaultValue);
+    print("every tunable back to its default");
+    return;
+  }
+
+  const char *tunableName = reset ? argument : name;
+  int id = findTunable(tunableName);
+  if (id < 0)
+  {
+    print("unknown tunable %s (try list)", tunableName);
+    return;
+  }
+
+  const Tunable *tunable = &world->tunables[id];
+  if (!reset && argument == NULL)
+  {
+    print("%s = %d (default %d, %d..%d): %s", tunable->name, snapshot->tunables[id], tunable->defaultValue,
+          tunable->min, tunable->max, tunable->description);
+    return;
+  }
+
+  char *end = NULL;
+  long value = reset ? tunable->defaultValue : strtol(argument, &end, 10);
+  if (!reset && (end == argument || *end != '\0'))
+  {
+    print("%s is not a number", argument);
+    return;
+  }
+  if (replayRunning(snapshot))
+    return;
+
+  if (value < tunable->min)
+    value = tunable->min;
+  if (value > tunable->max)
+    value = tunable->max;
+  submitTunable(id, (int)value);
+  print("%s = %ld", tunable->name, value);
+}
+
+void updateConsole(const WorldSnapshot *snapshot)
+{
+  if (IsKeyPressed(KEY_GRAVE))
+  {
+    consoleVisible = !consoleVisible;
+    while (GetCharPressed() != 0)
+      ; // The ` itself
+    return;
+  }
+  if (!consoleVisible)
+    return;
+
+  for (int c = GetCharPressed(); c != 0; c = GetCharPressed())
+  {
+    if (c >= 32 && c < 127 && typedLength < CONSOLE_LINE_SIZE - 1)
+      typed[typedLength++] = (char)c;
+  }
+  typed[typedLength] = '\0';
+
+  if ((IsKeyPressed(KEY_BACKSPACE) || IsKeyPressedRepeat(KEY_BACKSPACE)) && typedLength > 0)
+    typed[--typedLength] = '\0';
+
+  if (IsKeyPressed(KEY_ENTER))
+  {
+    print("> %s", typed);
+    execute(snapshot, typed);
+    typedLength = 0;
+    typed[0] = '\0';
+  }
+}
+
+int consoleOpen()
+{
+  return consoleVisible;
+}
+
+void drawConsole()
+{
+  if (!consoleVisible)
+    return;
+
+  int shown = lineCount < CONSOLE_LINES ? lineCount : CONSOLE_LINES;
+  int height = (shown + 1) * 14 + 8;
+  int top = WINDOW_SIZE - MINIMAP_SIZE - 20 - height;
+  DrawRectangle(0, top, WINDOW_SIZE, height, Fade(BLACK, 0.75f));
+  for (int i = 0; i < shown; i++)
+    DrawText(lines[(lineCount - shown + i) % CONSOLE_LINES], 10, top + 4 + i * 14, 10, WHITE);
+  DrawText(TextFormat("> %s_", typed), 10, top + 4 + shown * 14, 10, YELLOW);
+}
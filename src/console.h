@@ -0,0 +1,15 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "types.h"
+#include "snapshot.h"
+
+#define CONSOLE_LINES 8       // Output lines kept on screen
+#define CONSOLE_LINE_SIZE 128 // Characters per line, typed or printed
+
+// Function declarations for the tunables console (` to open; main thread)
+void updateConsole(const WorldSnapshot *snapshot); // Once per frame
+int consoleOpen();
+void drawConsole();
+
+#endif
@@ -0,0 +1,172 @@
+#include "types.h"
+#include "globals.h"
+#include "world.h"
+#include "fire.h"
+#include "terrain.h"
+#include "particles.h"
+#include "rng.h"
+#include "savestate.h"
+#include "platform.h"
+#include <stdlib.h>
+
+// Fire spread as a cellular automaton that only ever looks at burning cells.
+// The active set is a flat list of burning cells; every fire tick each of
+// them may ignite its four neighbours (the frontier) and counts down until it
+// burns out. Chunks count their burning cells, so a chunk with none costs
+// nothing and unloading it only touches the list when it is actually alight.
+
+#define FIRE_TICK_INTERVAL 8 // Frames between fire ticks
+#define FIRE_SPREAD_CHANCE 30 // Percent chance per tick to light each neighbouring tree
+#define FIRE_BURN_TICKS 6     // Ticks a tree burns (plus up to FIRE_BURN_JITTER)
+#define FIRE_BURN_JITTER 5
+
+static void wakeChunk(int chunkIndex)
+{
+  if (world->loadedChunks[chunkIndex].burningCells++ == 0)
+    world->fireStats.activeChunks++;
+}
+
+static void sleepChunk(int chunkIndex)
+{
+  if (--world->loadedChunks[chunkIndex].burningCells == 0)
+    world->fireStats.activeChunks--;
+}
+
+// Sets a tree on fire; returns 1 if it caught
+int igniteCell(int worldX, int worldY)
+{
+  if (world->burningCount >= MAX_BURNING_CELLS || getTerrainCell(worldX, worldY) != TERRAIN_TREE)
+    return 0;
+
+  WorldPosition pos = worldToChunk(worldX, worldY);
+  int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+  setTerrainCell(worldX, worldY, TERRAIN_BURNING_TREE);
+  wakeChunk(chunkIndex);
+
+  BurningCell *cell = &world->burning[world->burningCount++];
+  cell->x = worldX;
+  cell->y = worldY;
+  cell->chunkIndex = chunkIndex;
+  cell->ticksLeft = FIRE_BURN_TICKS + rngRange(world->fireSeed, rngCellKey(worldX, worldY), world->fireTick, FIRE_BURN_JITTER + 1);
+  world->fireStats.ignited++;
+  return 1;
+}
+
+void igniteArea(int centerX, int centerY, int radius)
+{
+  for (int dy = -radius; dy <= radius; dy++)
+  {
+    for (int dx = -radius; dx <= radius; dx++)
+    {
+      if (dx * dx + dy * dy <= radius * radius + radius)
+        igniteCell(centerX + dx, centerY + dy);
+    }
+  }
+}
+
+static void removeBurning(int i)
+{
+  sleepChunk(world->burning[i].chunkIndex);
+  world->burning[i] = world->burning[--world->burningCount];
+}
+
+void updateFire()
+{
+  if (world->burningCount == 0)
+  {
+    world->fireStats.burningCells = 0;
+    return; // Nothing alight anywhere: the whole simulation sleeps
+  }
+  if (++world->fireFrame < FIRE_TICK_INTERVAL)
+    return;
+  world->fireFrame = 0;
+  world->fireTick++;
+
+  static const int neighbourX[4] = {0, 0, -1, 1};
+  static const int neighbourY[4] = {-1, 1, 0, 0};
+  double tickStart = platformTimer();
+
+  // Cells lit during this tick start spreading next tick
+  int count = world->burningCount;
+  for (int i = 0; i < count; i++)
+  {
+    uint32_t stream = rngCellKey(world->burning[i].x, world->burning[i].y);
+    for (int n = 0; n < 4; n++)
+    {
+      if (rngRange(world->fireSeed, stream + n, world->fireTick, 100) < FIRE_SPREAD_CHANCE)
+        igniteCell(world->burning[i].x + neighbourX[n], world->burning[i].y + neighbourY[n]);
+    }
+    world->burning[i].ticksLeft--;
+  }
+
+  // Burn out, walking backwards so swap-removal never skips a cell
+  for (int i = count - 1; i >= 0; i--)
+  {
+    if (world->burning[i].ticksLeft > 0)
+    {
+      if (abs(world->burning[i].x - world->player.x) <= WINDOW_SIZE / CELL_SIZE &&
+          abs(world->burning[i].y - world->player.y) <= WINDOW_SIZE / CELL_SIZE)
+        emitParticleBurst((world->burning[i].x + 0.5f) * CELL_SIZE, (world->burning[i].y + 0.5f) * CELL_SIZE,
+                          2, 0.8f, 24, 3, ORANGE); // Embers (only near the player)
+      continue;
+    }
+    setTerrainCell(world->burning[i].x, world->burning[i].y, TERRAIN_BURNT_TREE);
+    removeBurning(i);
+  }
+
+  world->fireStats.burningCells = world->burningCount;
+  world->fireStats.lastTickMs = (platformTimer() - tickStart) * 1000.0;
+}
+
+// Called before a chunk unloads: whatever is still burning there goes out
+void extinguishChunk(int chunkIndex)
+{
+  if (world->loadedChunks[chunkIndex].burningCells == 0)
+    return;
+
+  for (int i = world->burningCount - 1; i >= 0; i--)
+  {
+    if (world->burning[i].chunkIndex == chunkIndex)
+    {
+      setTerrainCell(world->burning[i].x, world->burning[i].y, TERRAIN_BURNT_TREE);
+      removeBurning(i);
+    }
+  }
+}
+
+// newIndex maps every old chunk slot to its new one
+void moveFireChunks(const int *newIndex)
+{
+  for (int i = 0; i < world->burningCount; i++)
+    world->burning[i].chunkIndex = newIndex[world->burning[i].chunkIndex];
+}
+
+void clearFires()
+{
+  world->burningCount = 0;
+  world->fireFrame = 0;
+  world->fireTick = 0;
+  world->fireStats.burningCells = 0;
+  world->fireStats.activeChunks = 0;
+  world->fireSeed = rngSeed(RNG_FIRE);
+}
+
+int getBurningCellCount()
+{
+  return world->burningCount;
+}
+
+void getBurningCell(int i, int *worldX, int *worldY)
+{
+  *worldX = world->burning[i].x;
+  *worldY = world->burning[i].y;
+}
+
+void streamFireState(StateStream *stream)
+{
+  stateBlock(stream, &world->burningCount, sizeof(world->burningCount));
+  stateBlock(stream, world->burning, sizeof(world->burning[0]) * world->burningCount);
+  stateBlock(stream, &world->fireFrame, sizeof(world->fireFrame));
+  stateBlock(stream, &world->fireTick, sizeof(world->fireTick));
+  stateBlock(stream, &world->fireSeed, sizeof(world->fireSeed));
+}
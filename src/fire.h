@@ -0,0 +1,35 @@
+#ifndef FIRE_H
+#define FIRE_H
+
+#include "types.h"
+
+#define MAX_BURNING_CELLS 65536
+
+// Fire simulation statistics
+typedef struct
+{
+  int burningCells;  // Cells currently on fire
+  int activeChunks;  // Chunks with at least one burning cell
+  int ignited;       // Cells set alight so far
+  double lastTickMs; // Wall time of the most recent fire tick
+} FireStats;
+
+// One cell of the active fire list (World.burning)
+typedef struct
+{
+  int x, y;
+  int chunkIndex;
+  int ticksLeft;
+} BurningCell;
+
+// Function declarations for fire spread
+int igniteCell(int worldX, int worldY);
+void igniteArea(int centerX, int centerY, int radius);
+void updateFire();
+void extinguishChunk(int chunkIndex);
+void moveFireChunks(const int *newIndex); // After loadedChunks is compacted
+void clearFires();
+int getBurningCellCount();
+void getBurningCell(int i, int *worldX, int *worldY);
+
+#endif
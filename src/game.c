@@ -1,33 +1,78 @@
 #include "types.h"
 #include "globals.h"
+#include "monsters.h"
+#include "archetypes.h"
+#include "projectiles.h"
+#include "particles.h"
+#include "terrain.h"
+#include "fire.h"
+#include "lighting.h"
+#include "world.h"
+#include "player.h"
+#include "input.h"
+#include "jobs.h"
+#include "rng.h"
+#include "replay.h"
+#include "savestate.h"
+#include "arena.h"
+#include "memory.h"
+#include "throttle.h"
+#include "tunables.h"
+#include "platform.h"
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
 #include <string.h>
 
+#define COLLISION_JOB_GRAIN 4096 // Monsters per parallelFor range in checkCollisions
+
 // Function prototypes for functions called before definition
 void initGame();
 void updateChunks();
+void resetChunkLookup();
+
+typedef struct
+{
+  int troll;  // Monster whose gang is being counted
+  int nearby; // Other trolls within 2 cells
+} TrollGang;
 
 void restartGame()
 {
-  // Reset all game state first
-  projectileCount = 0;
-  monsterCount = 0;
-  powerupCount = 0;
-  landmineCount = 0;
-  loadedChunkCount = 0;
+  // Back to the world initGame generated, without generating it again. The
+  // clock and night mode carry over, and the new game gets fresh random
+  // streams (counted from this game's, so a rewind replays restarts exactly).
+  unsigned int tick = world->gameTick;
+  unsigned int game = rngGameNumber();
+  int night = isNightMode();
+  if (restoreStartState())
+  {
+    world->gameTick = tick;
+    setRngGameNumber(game);
+    reseedGame();
+    if (isNightMode() != night)
+      toggleNightMode();
+    return;
+  }
+
+  // No start state (out of memory): reset all game state and generate anew
+  clearProjectiles();
+  clearParticles();
+  clearTerrainEdits();
+  resetMonsters();
+  world->powerupCount = 0;
+  world->landmineCount = 0;
+  world->loadedChunkCount = 0;
 
   // Clear all arrays to prevent stale data issues
-  memset(monsters, 0, sizeof(monsters));
-  memset(powerups, 0, sizeof(powerups));
-  memset(landmines, 0, sizeof(landmines));
-  memset(projectiles, 0, sizeof(projectiles));
+  memset(world->monsters, 0, sizeof(world->monsters));
+  memset(world->powerups, 0, sizeof(world->powerups));
+  memset(world->landmines, 0, sizeof(world->landmines));
 
   // Clear all chunks
-  for (int i = 0; i < MAX_LOADED_CHUNKS; i++)
+  for (int i = 0; i < world->loadedChunkCapacity; i++)
   {
-    loadedChunks[i].loaded = 0;
+    world->loadedChunks[i].loaded = 0;
   }
 
   // Reinitialize game
@@ -36,51 +81,53 @@ void restartGame()
 
 void initGame()
 {
+  // Fresh random streams for this game (the terrain seed stays)
+  reseedGame();
+
   // Initialize player
-  strcpy(player.name, "Knight");
-  player.x = 1; // Start slightly away from origin to avoid spawn conflicts
-  player.y = 1;
-  player.health = 100;
-  player.maxHealth = 100;
-  player.power = 8;
-  player.textureIndex = 0;
-  player.alive = 1;
-  player.speed = 1;
-  player.speedMultiplier = 1.0f;
-  player.damageMultiplier = 1.0f;
-  player.powerupTimer = 0;
-  player.movementCooldown = 0;
-  player.level = 1;
-  player.experience = 0;
-  player.experienceToNext = 100;
-  player.isInCombat = 0;
-  player.invulnerabilityTimer = 180; // 3 seconds at 60 FPS
+  strcpy(world->player.name, "Knight");
+  world->player.x = 1; // Start slightly away from origin to avoid spawn conflicts
+  world->player.y = 1;
+  world->player.previousX = world->player.x;
+  world->player.previousY = world->player.y;
+  world->player.health = 100;
+  world->player.maxHealth = 100;
+  world->player.power = 8;
+  world->player.textureIndex = 0;
+  world->player.alive = 1;
+  world->player.speed = 1;
+  world->player.speedMultiplier = 1.0f;
+  world->player.damageMultiplier = 1.0f;
+  world->player.powerupTimer = 0;
+  world->player.movementCooldown = 0;
+  world->player.level = 1;
+  world->player.experience = 0;
+  world->player.experienceToNext = 100;
+  world->player.isInCombat = 0;
+  world->player.invulnerabilityTimer = 180; // 3 seconds at 60 FPS
 
   // Initialize player abilities and status
-  player.jumpSmashCooldown = 0;
-  player.rushCooldown = 0;
-  player.healCooldown = 0;
-  player.arrowCooldown = 0;
-  player.lastDirX = 0;
-  player.lastDirY = -1; // Default to up
-  player.intendedDirX = 0;
-  player.intendedDirY = -1;
-  player.stunTimer = 0;
-  player.dotTimer = 0;
-  player.dotDamage = 0;
-  player.speedBoostTimer = 0;
-
-  // Initialize camera
-  camera.target = (Vector2){player.x * CELL_SIZE, player.y * CELL_SIZE};
-  camera.offset = (Vector2){WINDOW_SIZE / 2, WINDOW_SIZE / 2};
-  camera.rotation = 0.0f;
-  camera.zoom = 1.0f;
+  world->player.jumpSmashCooldown = 0;
+  world->player.rushCooldown = 0;
+  world->player.healCooldown = 0;
+  world->player.arrowCooldown = 0;
+  world->player.lastDirX = 0;
+  world->player.lastDirY = -1; // Default to up
+  world->player.intendedDirX = 0;
+  world->player.intendedDirY = -1;
+  world->player.stunTimer = 0;
+  world->player.dotTimer = 0;
+  world->player.dotDamage = 0;
+  world->player.speedBoostTimer = 0;
 
   // Initialize chunk system
-  loadedChunkCount = 0;
-  monsterCount = 0;
-  powerupCount = 0;
-  landmineCount = 0;
+  world->loadedChunkCount = 0;
+  resetChunkLookup();
+  setChunkWindow(chunkWindow()); // Allocates the chunk slots on the first game
+  resetMonsters();
+  clearFires();
+  world->powerupCount = 0;
+  world->landmineCount = 0;
 
   // Load initial chunks around player (more aggressively)
   for (int i = 0; i < 3; i++) // Load chunks multiple times to ensure they're ready
@@ -89,210 +136,226 @@ void initGame()
   }
 
   // Initial monster spawn for immediate gameplay
+  RngStream random = rngStream(rngSeed(RNG_GAME), 0);
   for (int i = 0; i < 15; i++) // Spawn 15 monsters initially
   {
-    if (monsterCount < MAX_MONSTERS)
-    {
-      Character *monster = &monsters[monsterCount++];
-      strcpy(monster->name, "Monster");
-
-      // Spawn closer initially: 5-50 units from player
-      int distance = 5 + rand() % 45;
-      float angle = (rand() % 360) * DEG2RAD;
-      monster->x = player.x + (int)(cos(angle) * distance);
-      monster->y = player.y + (int)(sin(angle) * distance);
-
-      monster->health = 20 + rand() % 30;
-      monster->maxHealth = monster->health;
-      monster->power = 3 + rand() % 5;
-      monster->textureIndex = 1 + (rand() % 5); // Random monster texture (1-5: dragon, goblin, ogre, troll, wizard)
-      monster->alive = 1;
-      monster->speed = 1;
-      monster->speedMultiplier = 1.0f;
-      monster->damageMultiplier = 1.0f;
-      monster->powerupTimer = 0;
-      monster->movementCooldown = 0;
-      monster->level = 1;
-      monster->experience = 0;
-      monster->experienceToNext = 0;
-      monster->isInCombat = 0;
-      monster->invulnerabilityTimer = 0;
-    }
+    // Spawn closer initially: 5-50 units from player
+    int distance = 5 + rngNext(&random, 45);
+    float angle = rngNext(&random, 360) * DEG2RAD;
+    spawnMonster(randomArchetype(&random), world->player.x + (int)(cos(angle) * distance),
+                 world->player.y + (int)(sin(angle) * distance));
   }
+
+  saveStartState(); // restartGame comes back here
 }
 
-void checkCollisions()
+// Clears combat flags and collects the monsters touching the player
+static void findAdjacentRange(int begin, int end, void *context)
+{
+  (void)context;
+  for (int i = begin; i < end; i++)
+  {
+    if (!world->monsters[i].alive)
+      continue;
+    world->monsters[i].isInCombat = 0;
+
+    // Check if monster is adjacent to player (including diagonally)
+    int dx = abs(world->player.x - world->monsters[i].x);
+    int dy = abs(world->player.y - world->monsters[i].y);
+    if (dx <= 1 && dy <= 1 && !(dx == 0 && dy == 0))
+      world->adjacentMonsters[__atomic_fetch_add(&world->adjacentCount, 1, __ATOMIC_RELAXED)] = i;
+  }
+}
+
+static void countTrollGangRange(int begin, int end, void *context)
 {
-  // Reset combat flags
-  player.isInCombat = 0;
-  for (int i = 0; i < monsterCount; i++)
+  TrollGang *gang = context;
+  const Character *troll = &world->monsters[gang->troll];
+  int nearby = 0;
+  for (int j = begin; j < end; j++)
   {
-    if (monsters[i].alive)
+    if (j != gang->troll && world->monsters[j].alive && world->monsters[j].archetype == ARCHETYPE_TROLL)
     {
-      monsters[i].isInCombat = 0;
+      int tdx = abs(troll->x - world->monsters[j].x);
+      int tdy = abs(troll->y - world->monsters[j].y);
+      if (tdx <= 2 && tdy <= 2) // Within 2 units
+        nearby++;
     }
   }
+  __atomic_add_fetch(&gang->nearby, nearby, __ATOMIC_RELAXED);
+}
+
+// Finds who is fighting the player and resolves the fights; the scan is
+// parallel, the fights are resolved in monster order as before
+static void fightAdjacentMonsters()
+{
+  world->adjacentCount = 0;
+  world->adjacentMonsters = frameAlloc(sizeof(int) * (size_t)world->monsterCount);
+  if (world->adjacentMonsters == NULL)
+    return; // Out of memory: no fights this tick (pickups and mines still run)
+  parallelFor(world->monsterCount, COLLISION_JOB_GRAIN, findAdjacentRange, NULL);
+  for (int a = 1; a < world->adjacentCount; a++)
+  {
+    int index = world->adjacentMonsters[a];
+    int b = a;
+    for (; b > 0 && world->adjacentMonsters[b - 1] > index; b--)
+      world->adjacentMonsters[b] = world->adjacentMonsters[b - 1];
+    world->adjacentMonsters[b] = index;
+  }
 
   // Check player vs monsters (adjacent cells)
-  for (int i = 0; i < monsterCount; i++)
+  for (int a = 0; a < world->adjacentCount; a++)
   {
-    if (!monsters[i].alive)
+    int i = world->adjacentMonsters[a];
+    if (!world->monsters[i].alive)
       continue;
 
-    // Check if monster is adjacent to player (including diagonally)
-    int dx = abs(player.x - monsters[i].x);
-    int dy = abs(player.y - monsters[i].y);
-
-    if (dx <= 1 && dy <= 1 && !(dx == 0 && dy == 0))
-    {
-      // Adjacent combat!
-      player.isInCombat = 1;
-      monsters[i].isInCombat = 1;
+    // Adjacent combat!
+    world->player.isInCombat = 1;
+    world->monsters[i].isInCombat = 1;
 
-      // Per-tick damage (only if player is not invulnerable)
-      int playerDamage = (int)(player.power * player.damageMultiplier * 0.5f); // Reduced damage per tick
-      int monsterDamage = (int)(monsters[i].power * monsters[i].damageMultiplier * 0.5f);
+    // Per-tick damage (only if player is not invulnerable)
+    int playerDamage = (int)(world->player.power * world->player.damageMultiplier * 0.5f); // Reduced damage per tick
+    int monsterDamage = (int)(world->monsters[i].power * world->monsters[i].damageMultiplier * 0.5f);
 
-      // Troll gang damage multiplier
-      if (monsters[i].textureIndex == 4) // Troll
-      {
-        int nearbyTrolls = 0;
-        for (int j = 0; j < monsterCount; j++)
-        {
-          if (i != j && monsters[j].alive && monsters[j].textureIndex == 4)
-          {
-            int tdx = abs(monsters[i].x - monsters[j].x);
-            int tdy = abs(monsters[i].y - monsters[j].y);
-            if (tdx <= 2 && tdy <= 2) // Within 2 units
-            {
-              nearbyTrolls++;
-            }
-          }
-        }
-        // Damage multiplier: 2x per nearby troll
-        monsterDamage *= (1 << nearbyTrolls); // 2^nearbyTrolls
-      }
+    // Troll gang damage multiplier
+    if (world->monsters[i].archetype == ARCHETYPE_TROLL)
+    {
+      TrollGang gang = {i, 0};
+      parallelFor(world->monsterCount, COLLISION_JOB_GRAIN, countTrollGangRange, &gang);
+      // Damage multiplier: 2x per nearby troll
+      monsterDamage *= (1 << gang.nearby); // 2^nearbyTrolls
+    }
 
-      monsters[i].health -= playerDamage;
+    world->monsters[i].health -= playerDamage;
 
-      // Only damage player if not invulnerable
-      if (player.invulnerabilityTimer <= 0)
-      {
-        player.health -= monsterDamage;
-      }
+    // Only damage player if not invulnerable
+    if (world->player.invulnerabilityTimer <= 0)
+    {
+      world->player.health -= monsterDamage;
+    }
 
-      // Play battle sound (only once per combat tick)
-      if (sounds[0].frameCount > 0 && !player.isInCombat)
-        PlaySound(sounds[0]);
+    // Play battle sound (only once per combat tick)
+    if (sounds[0].frameCount > 0 && !world->player.isInCombat)
+      platformPlaySound(0);
 
-      if (monsters[i].health <= 0)
-      {
-        monsters[i].alive = 0;
-        // Award experience to player
-        player.experience += monsters[i].power * 10;
-        // Play victory sound
-        if (sounds[4].frameCount > 0)
-          PlaySound(sounds[4]);
-
-        // Check for level up
-        if (player.experience >= player.experienceToNext)
-        {
-          player.level++;
-          player.experience -= player.experienceToNext;
-          player.experienceToNext = player.level * 100; // Next level requires more XP
-          player.maxHealth += 20;
-          player.health = player.maxHealth; // Full heal on level up
-          player.power += 2;
-        }
-      }
-      if (player.health <= 0)
+    if (world->monsters[i].health <= 0)
+    {
+      world->monsters[i].alive = 0;
+      emitDeathEffect(world->monsters[i].x, world->monsters[i].y);
+      // Award experience to player
+      world->player.experience += world->monsters[i].power * 10;
+      // Play victory sound
+      if (sounds[4].frameCount > 0)
+        platformPlaySound(4);
+
+      // Check for level up
+      if (world->player.experience >= world->player.experienceToNext)
       {
-        player.alive = 0;
-        // Play death sound
-        if (sounds[3].frameCount > 0)
-          PlaySound(sounds[3]);
+        world->player.level++;
+        world->player.experience -= world->player.experienceToNext;
+        world->player.experienceToNext = world->player.level * 100; // Next level requires more XP
+        world->player.maxHealth += 20;
+        world->player.health = world->player.maxHealth; // Full heal on level up
+        world->player.power += 2;
       }
     }
+    if (world->player.health <= 0)
+    {
+      world->player.alive = 0;
+      emitDeathEffect(world->player.x, world->player.y);
+      // Play death sound
+      if (sounds[3].frameCount > 0)
+        platformPlaySound(3);
+    }
   }
+}
+
+void checkCollisions()
+{
+  world->player.isInCombat = 0;
+  fightAdjacentMonsters();
 
   // Check player vs powerups
-  for (int i = 0; i < powerupCount; i++)
+  for (int i = 0; i < world->powerupCount; i++)
   {
-    if (!powerups[i].active)
+    if (!world->powerups[i].active)
       continue;
 
-    if (player.x == powerups[i].x && player.y == powerups[i].y)
+    if (world->player.x == world->powerups[i].x && world->player.y == world->powerups[i].y)
     {
       // Apply powerup
-      player.activePowerup = powerups[i].type;
-      player.powerupTimer = 300; // 5 seconds at 60 FPS
+      world->player.activePowerup = world->powerups[i].type;
+      world->player.powerupTimer = 300; // 5 seconds at 60 FPS
 
-      switch (powerups[i].type)
+      switch (world->powerups[i].type)
       {
       case POWERUP_DOUBLE_DAMAGE:
-        player.damageMultiplier = 2.0f;
+        world->player.damageMultiplier = 2.0f;
         break;
       case POWERUP_DOUBLE_HEALTH:
-        player.health = player.maxHealth;
+        world->player.health = world->player.maxHealth;
         break;
       case POWERUP_DOUBLE_SPEED:
-        player.speedMultiplier = 2.0f;
+        world->player.speedMultiplier = 2.0f;
         break;
       default:
         break;
       }
 
-      powerups[i].active = 0;
+      world->powerups[i].active = 0;
       // Play powerup sound
       if (sounds[1].frameCount > 0)
-        PlaySound(sounds[1]);
+        platformPlaySound(1);
     }
   }
 
   // Check player vs landmines
-  for (int i = 0; i < landmineCount; i++)
+  for (int i = 0; i < world->landmineCount; i++)
   {
-    if (!landmines[i].active)
+    if (!world->landmines[i].active)
       continue;
 
-    if (player.x == landmines[i].x && player.y == landmines[i].y)
+    if (world->player.x == world->landmines[i].x && world->player.y == world->landmines[i].y)
     {
-      player.health -= landmines[i].damage;
-      landmines[i].active = 0;
+      world->player.health -= world->landmines[i].damage;
+      world->landmines[i].active = 0;
+      emitExplosion(world->landmines[i].x, world->landmines[i].y);
+      blastTerrain(world->landmines[i].x, world->landmines[i].y, 2, 1);
       // Play damage sound
       if (sounds[2].frameCount > 0)
-        PlaySound(sounds[2]);
+        platformPlaySound(2);
     }
   }
 }
 
 void updatePowerups()
 {
-  if (player.powerupTimer > 0)
+  if (world->player.powerupTimer > 0)
   {
-    player.powerupTimer--;
-    if (player.powerupTimer == 0)
+    world->player.powerupTimer--;
+    if (world->player.powerupTimer == 0)
     {
       // Reset powerups
-      player.speedMultiplier = 1.0f;
-      player.damageMultiplier = 1.0f;
+      world->player.speedMultiplier = 1.0f;
+      world->player.damageMultiplier = 1.0f;
     }
   }
 
   // Despawn powerups that are too far from player
-  const int DESPAWN_DISTANCE = 300; // Despawn powerups more than 300 units away
+  int despawnDistance = world->tunables[TUNE_ITEM_DESPAWN_DISTANCE].value;
 
-  for (int i = powerupCount - 1; i >= 0; i--)
+  for (int i = world->powerupCount - 1; i >= 0; i--)
   {
-    int dx = powerups[i].x - player.x;
-    int dy = powerups[i].y - player.y;
+    int dx = world->powerups[i].x - world->player.x;
+    int dy = world->powerups[i].y - world->player.y;
     float distance = sqrt(dx * dx + dy * dy);
 
-    if (distance > DESPAWN_DISTANCE)
+    if (distance > despawnDistance)
     {
       // Remove this powerup by moving the last powerup to this position
-      powerups[i] = powerups[powerupCount - 1];
-      powerupCount--;
+      world->powerups[i] = world->powerups[world->powerupCount - 1];
+      world->powerupCount--;
     }
   }
 }
@@ -300,19 +363,100 @@ void updatePowerups()
 void updateLandmines()
 {
   // Despawn landmines that are too far from player
-  const int DESPAWN_DISTANCE = 300; // Despawn landmines more than 300 units away
+  int despawnDistance = world->tunables[TUNE_ITEM_DESPAWN_DISTANCE].value;
 
-  for (int i = landmineCount - 1; i >= 0; i--)
+  for (int i = world->landmineCount - 1; i >= 0; i--)
   {
-    int dx = landmines[i].x - player.x;
-    int dy = landmines[i].y - player.y;
+    int dx = world->landmines[i].x - world->player.x;
+    int dy = world->landmines[i].y - world->player.y;
     float distance = sqrt(dx * dx + dy * dy);
 
-    if (distance > DESPAWN_DISTANCE)
+    if (distance > despawnDistance)
     {
       // Remove this landmine by moving the last landmine to this position
-      landmines[i] = landmines[landmineCount - 1];
-      landmineCount--;
+      world->landmines[i] = world->landmines[world->landmineCount - 1];
+      world->landmineCount--;
     }
   }
 }
+
+// One fixed simulation step; every gameplay timer and cooldown counts these
+void simulationTick()
+{
+  double tickStart = platformTimer();
+
+  // The governor's level goes in with the input, so a replay records it (or
+  // substitutes the recorded one)
+  world->input.throttle = throttleTarget();
+  replayInput(&world->input); // Record this tick's input, or play back the recorded one
+  setThrottleLevel(world->input.throttle);
+
+  // Rewinding restores an earlier tick, then this one runs on from there.
+  // Replays hold every tick in order, so rewind is off while one runs.
+  if (world->input.rewind && world->replayStats.mode != REPLAY_RECORDING && world->replayStats.mode != REPLAY_PLAYING)
+    rewindState();
+
+  world->gameTick++;
+
+  // Requests that act on the whole game rather than the player
+  if (world->input.restart)
+    restartGame();
+  if (world->input.toggleNight)
+    toggleNightMode();
+
+  // Remember where everything was, so rendering can interpolate from here
+  world->player.previousX = world->player.x;
+  world->player.previousY = world->player.y;
+  for (int i = 0; i < world->monsterCount; i++)
+  {
+    world->monsters[i].previousX = world->monsters[i].x;
+    world->monsters[i].previousY = world->monsters[i].y;
+  }
+
+  if (world->player.alive)
+  {
+    updatePlayer();
+    updateMonsters();
+    checkCollisions();
+    updatePowerups();
+    updateLandmines();
+    updateProjectiles();
+    updateFire();
+    flushTerrainEdits(); // Rebuild caches under cells changed by blasts and fire
+    updateChunks(); // Update chunk loading/unloading
+
+    // Ensure monsters are nearby
+    ensureNearbyMonsters();
+
+    // Ensure powerups are nearby
+    ensureNearbyPowerups();
+
+    // Ensure landmines are nearby
+    ensureNearbyLandmines();
+  }
+
+  // Effects keep playing after death
+  updateParticles();
+  updateLighting();
+
+  // Auto-restart after death (after a short delay)
+  if (!world->player.alive && world->player.deathTimer <= 0)
+  {
+    world->player.deathTimer = 180; // 3 second delay before auto-restart
+  }
+  if (!world->player.alive && world->player.deathTimer > 0)
+  {
+    world->player.deathTimer--;
+    if (world->player.deathTimer <= 0)
+    {
+      restartGame();
+    }
+  }
+
+  replayEndTick();
+  recordStateRing();
+  sampleJobStats();
+  resetFrameArenas(); // Nothing allocated this tick outlives it
+  governMemory();
+  governFrameTime((platformTimer() - tickStart) * 1000.0);
+}
@@ -4,6 +4,7 @@
 #include "types.h"
 
 // Function declarations for game management
+void simulationTick();
 void restartGame();
 void initGame();
 void checkCollisions();
@@ -1,19 +1,49 @@
 #include "globals.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Global game state
-Character player;
-Character monsters[MAX_MONSTERS];
-Powerup powerups[MAX_POWERUPS];
-Landmine landmines[MAX_LANDMINES];
-Projectile projectiles[MAX_PROJECTILES];
-Chunk loadedChunks[MAX_LOADED_CHUNKS];
-int loadedChunkCount = 0;
-int monsterCount = 0;
-int powerupCount = 0;
-int landmineCount = 0;
-int projectileCount = 0;
+#ifdef GRIDLOCK_BATCH
+__thread World *world = NULL;
+#else
+World mainWorld;
+#endif
 
 // Assets
 Texture2D textures[10]; // Player + monsters + powerups + landmines
 Sound sounds[10];       // Various sound effects
 Camera2D camera = {0};
+float renderAlpha = 1.0f;
+
+void initWorld(World *state)
+{
+  memset(state, 0, sizeof(World));
+  state->chunkLoadDistance = CHUNK_LOAD_DISTANCE;
+  state->losCacheStamp = 1;
+  state->cachedChunkIndex = -1;
+  state->ringNewest = -1;
+  state->ringDepth = STATE_RING_SIZE;
+  state->ringFullDepth = -1;
+  state->replayStats.mode = REPLAY_OFF;
+  state->replayStats.divergedTick = -1;
+  state->nextKind = RECORD_NONE;
+  memcpy(state->tunables, defaultTunables, sizeof(defaultTunables));
+}
+
+void freeWorld()
+{
+  free(world->loadedChunks);
+  world->loadedChunks = NULL;
+  world->loadedChunkCapacity = 0;
+  world->loadedChunkCount = 0;
+  free(world->editStore);
+  world->editStore = NULL;
+  world->editStoreCount = 0;
+  world->editStoreCapacity = 0;
+  freeProjectilePool();
+  freeState(&world->startState);
+  for (int i = 0; i < STATE_RING_SIZE; i++)
+    freeState(&world->ring[i]);
+  freeFrameArenas();
+}
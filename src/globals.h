@@ -2,23 +2,239 @@
 #define GLOBALS_H
 
 #include "types.h"
+#include "arena.h"
+#include "fire.h"
+#include "input.h"
+#include "jobs.h"
+#include "lighting.h"
+#include "memory.h"
+#include "monsters.h"
+#include "particles.h"
+#include "pathfinding.h"
+#include "projectiles.h"
+#include "replay.h"
+#include "rng.h"
+#include "savestate.h"
+#include "terrain.h"
+#include "throttle.h"
+#include "tunables.h"
+#include "visibility.h"
+#include "world.h"
 
-// Global game state
-extern Character player;
-extern Character monsters[MAX_MONSTERS];
-extern Powerup powerups[MAX_POWERUPS];
-extern Landmine landmines[MAX_LANDMINES];
-extern Projectile projectiles[MAX_PROJECTILES];
-extern Chunk loadedChunks[MAX_LOADED_CHUNKS];
-extern int loadedChunkCount;
-extern int monsterCount;
-extern int powerupCount;
-extern int landmineCount;
-extern int projectileCount;
+// Everything the simulation keeps between calls, for one world. The game and
+// gridlock-headless run a single world (mainWorld); the batch library steps
+// many, pointing world at each in turn from its worker threads.
+typedef struct
+{
+  // Global game state
+  Character player;
+  Character monsters[MAX_MONSTERS];
+  Powerup powerups[MAX_POWERUPS];
+  Landmine landmines[MAX_LANDMINES];
+  ProjectilePool projectiles;
+  Chunk *loadedChunks; // Sized to the resident chunk window (setChunkWindow)
+  int loadedChunkCapacity;
+  int loadedChunkCount;
+  int monsterCount;
+  int powerupCount;
+  int landmineCount;
+  unsigned int gameTick; // Simulation ticks since startup (the game's clock)
+  InputState input;
+
+  // Random streams: every domain is derived from the world seed and game number
+  uint64_t worldSeed;
+  uint32_t gameNumber;
+  uint64_t domainSeeds[RNG_DOMAIN_COUNT];
+
+  // Chunks (world.c): open-addressed table mapping chunk coordinates to
+  // loadedChunks slots (slot + 1, 0 = empty), the slots updateChunks claimed
+  // this tick, and the resident window (every chunk within this many chunks
+  // of the player's, per axis, stays loaded)
+  int chunkLookup[CHUNK_LOOKUP_SIZE];
+  int pendingChunks[MAX_LOADED_CHUNKS];
+  int chunkLoadDistance;
+
+  // Terrain edits (terrain.c). lastTerrainRevision is the source of
+  // Chunk.revision and is deliberately left out of save states: after a
+  // rewind the restored chunks keep their old revisions and new edits still
+  // get fresh ones, so a revision never names two different terrains.
+  TerrainStats terrainStats;
+  int dirtyChunks[MAX_LOADED_CHUNKS];
+  int dirtyChunkCount;
+  ChunkEdits *editStore;
+  int editStoreCount;
+  int editStoreCapacity;
+  int lastTerrainRevision;
+
+  // Monster AI (monsters.c). monsters[] is kept sorted into contiguous
+  // batches keyed by (AI tier, archetype); monsterBatchEnd[b] is one past the
+  // last monster of batch b.
+  AiStats aiStats;
+  int monsterBatchEnd[AI_BATCH_COUNT];
+  unsigned char batchOf[MAX_MONSTERS]; // Re-tier: new batch per monster (AI_BATCH_COUNT = despawn)
+  int nearbyMonsterCount;
+  int despawnFar;
+  int tierChunkX;
+  int tierChunkY;
+  int framesSinceRetier;
+  int aiFrame;
+  AiSegment aiSegments[AI_BATCH_COUNT];
+  int aiSegmentCount;
+  int aiSlots[MAX_MONSTERS];
+  int aiSlotCount;
+  int slotOfMonster[MAX_MONSTERS];
+  int batchX[MAX_MONSTERS];
+  int batchY[MAX_MONSTERS];
+  int batchCooldown[MAX_MONSTERS];
+  int batchCombat[MAX_MONSTERS];
+  int batchAlive[MAX_MONSTERS];
+  int batchRoll[MAX_MONSTERS];
+  int batchFire[MAX_MONSTERS];
+  int shooterX[MAX_MONSTERS];
+  int shooterY[MAX_MONSTERS];
+  unsigned char shooterVisible[MAX_MONSTERS];
+  MoveClaim moveClaims[MOVE_CLAIM_TABLE_SIZE];
+  unsigned int moveClaimStamp;
+  uint64_t aiSeed; // Per-monster random streams: monster id x AI frame
+  unsigned int nextMonsterId;
+
+  // Monsters next to the player this tick (game.c; collected in parallel, then sorted)
+  int *adjacentMonsters; // Frame arena, one slot per monster
+  int adjacentCount;
+
+  // Click-to-move route (player.c; cells still to walk, in order)
+  PathPoint playerPath[MAX_PATH_LENGTH];
+  int playerPathLength;
+  int playerPathStep;
+
+  // Pathfinding (pathfinding.c): abstract search state, stamped per query so
+  // it never needs clearing
+  PathStats pathStats;
+  int nodeCost[PATH_NODE_COUNT + 1];
+  int nodeParent[PATH_NODE_COUNT + 1];
+  int nodeStamp[PATH_NODE_COUNT + 1];
+  int searchStamp;
+  PathHeapEntry heap[PATH_HEAP_SIZE];
+  int heapSize;
+  PathPoint waypoints[PATH_MAX_WAYPOINTS];
+
+  // Line of sight (visibility.c): results are cached per shooter cell for
+  // one target cell and one terrain version; moving the target or changing
+  // any terrain starts a new stamp
+  LosStats losStats;
+  LosCacheEntry losCache[LOS_CACHE_SIZE];
+  unsigned int losCacheStamp;
+  int losCacheFill;
+  int losCacheTargetX;
+  int losCacheTargetY;
+  unsigned int losCacheVersion;
+  unsigned int terrainVersion;
+
+  // Projectiles (projectiles.c). Monster grid: gridHead[cell] starts a linked
+  // list through gridNext of monsters whose hit area covers that cell (valid
+  // while gridStamp matches). sweepTarget and sweepCell hold what each
+  // projectile's sweep hits first and in which cell (frame arena, sized to
+  // this tick's projectiles).
+  ProjectileStats projectileStats;
+  int gridHead[PROJECTILE_GRID_CELLS];
+  unsigned int gridStamp[PROJECTILE_GRID_CELLS];
+  unsigned int gridFrame;
+  int gridMonster[PROJECTILE_GRID_ENTRIES];
+  int gridNext[PROJECTILE_GRID_ENTRIES];
+  int gridOriginX;
+  int gridOriginY;
+  int *sweepTarget;
+  int *sweepCellX;
+  int *sweepCellY;
+
+  // Particles (particles.c)
+  ParticlePool particles;
+  ParticleStats particleStats;
+  uint32_t burstCount;
+
+  // Fire (fire.c)
+  FireStats fireStats;
+  BurningCell burning[MAX_BURNING_CELLS];
+  int burningCount;
+  int fireFrame;
+  unsigned int fireTick;
+  uint64_t fireSeed;
+
+  // Night lighting (lighting.c). The single-entry chunk cache helps floods,
+  // which touch long runs of cells in one chunk.
+  LightStats lightStats;
+  int nightMode;
+  LightSource sourceLists[2][MAX_LIGHT_SOURCES];
+  int sourceListCounts[2];
+  int currentSources; // Index of last frame's list
+  LightNode removeQueue[LIGHT_QUEUE_SIZE];
+  LightNode addQueue[LIGHT_QUEUE_SIZE];
+  int addHead, addTail;
+  int cachedChunkX, cachedChunkY, cachedChunkIndex;
+
+  // Save states (savestate.c)
+  SaveStateStats saveStateStats;
+  SaveState startState;
+  SaveState ring[STATE_RING_SIZE];
+  int ringNewest;
+  int ringCount;
+  int ringDepth; // Slots in use, from ring[0]
+
+  // Replay (replay.c)
+  ReplayStats replayStats;
+  FILE *replayFile;
+  unsigned int lastRecordTick; // Tick of the previous record (deltas count from here)
+  unsigned int currentMask;    // Input of the previous tick
+  int clickX, clickY;
+  RecordKind nextKind; // Playback lookahead: the next record not yet acted on
+  unsigned int nextTick;
+  unsigned int nextMask;
+  int nextClickX, nextClickY;
+  uint64_t nextHash;
+
+  // Run-time settings (tunables.c)
+  Tunable tunables[TUNABLE_COUNT];
+
+  // Per-tick frame arenas (arena.c), one per job thread
+  FrameArenaStats frameArenaStats;
+  FrameArena arenas[MAX_JOB_THREADS];
+
+  // Memory governor (memory.c)
+  MemoryStats memoryStats;
+  size_t budgetBytes;
+  int ringFullDepth; // Ring depth before the first trim (-1 = untrimmed)
+
+  // Frame throttle (throttle.c)
+  ThrottleStats throttleStats;
+  double drawMs;
+  float windowSlowest;
+  int windowFrames;
+  int windowSlowFrames;
+  int calmWindows;
+
+  // Job statistics (jobs.c; the thread pool itself is shared)
+  JobStats jobStats;
+  double lastSampleTime;
+} World;
+
+// The world the simulation reads and writes. The batch library switches it
+// per worker thread; everywhere else it is the one static world, so every
+// access compiles to a plain global load as before.
+#ifdef GRIDLOCK_BATCH
+extern __thread World *world;
+#else
+extern World mainWorld;
+#define world (&mainWorld)
+#endif
 
 // Assets
 extern Texture2D textures[10]; // Player + monsters + powerups + landmines
 extern Sound sounds[10];       // Various sound effects
 extern Camera2D camera;
+extern float renderAlpha; // Fraction of a tick rendered past the last simulation step
+
+// Function declarations for world storage
+void initWorld(World *state); // Defaults for a world nothing has run in yet
+void freeWorld();             // Gives back the current world's heap memory
 
 #endif // GLOBALS_H
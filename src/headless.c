@@ -0,0 +1,445 @@
+#define _POSIX_C_SOURCE 200809L
+#include "types.h"
+#include "globals.h"
+#include "game.h"
+#include "input.h"
+#include "jobs.h"
+#include "monsters.h"
+#include "rng.h"
+#include "replay.h"
+#include "observation.h"
+#include "arena.h"
+#include "memory.h"
+#include "throttle.h"
+#include "tunables.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// gridlock-headless: the game's simulation with no window, GPU or audio
+// device. Steps fixed ticks back to back as fast as the CPU allows, on the
+// tick counter as its clock, and prints a summary.
+//
+// usage: gridlock-headless [ticks] [seed] [--bot] [--serial] [--observe] [--memory MB]
+//                          [--throttle ms] [--set name=value ...] [--sweep name=a,b,... ...]
+//                          [--record file | --replay file]
+//   ticks  Simulation ticks to run (default 3600, one minute of game time)
+//   seed   World seed; the same seed and flags replay the same run
+//          (default: the current time)
+//   --bot     Drive the player with a scripted input pattern instead of none
+//   --serial  Run every job inline on one thread (for debugging)
+//   --observe Encode the player's observation after every tick and time it
+//   --memory  Heap budget for the memory governor (default: none)
+//   --throttle Frame budget for the frame governor (default: off, so runs
+//             do not depend on the machine; a replay repeats the recorded levels)
+//   --set     Change a tunable (see tunables.c) before the run
+//   --sweep   Run once per combination of the listed values (one process
+//             each, all from the same seed) and print a CSV row per run:
+//             the swept values, tick time percentiles and memory
+//   --record  Save the seed and every tick's input to a replay file
+//   --replay  Rerun a replay file (its seed and length replace the arguments),
+//             checking the simulation state against it; exits 1 on divergence
+// Unknown options, non-numeric arguments and options missing their value
+// print the usage and exit 1, so a typo never runs with the wrong settings.
+
+#define SWEEP_MAX_AXES 4
+#define SWEEP_MAX_VALUES 32
+
+typedef struct
+{
+  int tunable;
+  int count;
+  int values[SWEEP_MAX_VALUES];
+} SweepAxis;
+
+typedef struct
+{
+  float *tickMs;      // Simulation time of every tick
+  double elapsed;     // Seconds simulating (observation excluded)
+  double observeTime; // Seconds encoding observations
+  int deaths;
+} RunResult;
+
+// Walks a slowly turning square, shoots all the time and heals when hurt
+static void scriptInput(unsigned int tick)
+{
+  int side = (tick / 120) % 4;
+  world->input.up = side == 0;
+  world->input.right = side == 1;
+  world->input.down = side == 2;
+  world->input.left = side == 3;
+  world->input.shoot = 1;
+  if (world->player.health < world->player.maxHealth / 2)
+    world->input.heal = 1;
+}
+
+static int compareFloats(const void *a, const void *b)
+{
+  float x = *(const float *)a, y = *(const float *)b;
+  return (x > y) - (x < y);
+}
+
+// Tick time percentiles in ms: mean, p50, p90, p99, max
+static void tickPercentiles(const float *tickMs, unsigned int ticks, double out[5])
+{
+  float *sorted = malloc(sizeof(float) * (ticks ? ticks : 1));
+  double sum = 0.0;
+  for (unsigned int i = 0; i < ticks; i++)
+  {
+    sorted[i] = tickMs[i];
+    sum += tickMs[i];
+  }
+  qsort(sorted, ticks, sizeof(float), compareFloats);
+  out[0] = ticks ? sum / ticks : 0.0;
+  out[1] = ticks ? sorted[(ticks - 1) * 50 / 100] : 0.0;
+  out[2] = ticks ? sorted[(ticks - 1) * 90 / 100] : 0.0;
+  out[3] = ticks ? sorted[(ticks - 1) * 99 / 100] : 0.0;
+  out[4] = ticks ? sorted[ticks - 1] : 0.0;
+  free(sorted);
+}
+
+// Runs the ticks on the world initGame made, timing each one
+static void runTicks(unsigned int ticks, int bot, int observe, RunResult *result)
+{
+  static unsigned char observation[OBSERVATION_BYTES];
+  result->observeTime = 0.0;
+  result->deaths = 0;
+  double start = platformTimer();
+  for (unsigned int tick = 0; tick < ticks; tick++)
+  {
+    pollInput(&world->input);
+    if (bot)
+      scriptInput(tick);
+
+    int wasAlive = world->player.alive;
+    double tickStart = platformTimer();
+    simulationTick();
+    result->tickMs[tick] = (float)((platformTimer() - tickStart) * 1000.0);
+    consumeInput(&world->input);
+    if (wasAlive && !world->player.alive)
+      result->deaths++;
+
+    if (observe)
+    {
+      double observeStart = platformTimer();
+      encodeObservation(observation);
+      result->observeTime += platformTimer() - observeStart;
+    }
+  }
+  result->elapsed = platformTimer() - start - result->observeTime; // Simulation only
+}
+
+// "name=a,b,c" as one sweep axis; 0 if the name or a value is bad
+static int parseSweepAxis(const char *text, SweepAxis *axis)
+{
+  const char *equals = strchr(text, '=');
+  if (equals == NULL)
+    return 0;
+  char name[64];
+  size_t length = (size_t)(equals - text);
+  if (length >= sizeof(name))
+    return 0;
+  memcpy(name, text, length);
+  name[length] = '\0';
+  axis->tunable = findTunable(name);
+  if (axis->tunable < 0)
+    return 0;
+
+  axis->count = 0;
+  const char *cursor = equals + 1;
+  while (axis->count < SWEEP_MAX_VALUES)
+  {
+    char *end;
+    long value = strtol(cursor, &end, 10);
+    if (end == cursor || (*end != ',' && *end != '\0'))
+      return 0;
+    axis->values[axis->count++] = (int)value;
+    if (*end == '\0')
+      return 1;
+    cursor = end + 1;
+  }
+  return 0;
+}
+
+static void printUsage(FILE *out)
+{
+  fprintf(out, "usage: gridlock-headless [ticks] [seed] [--bot] [--serial] [--observe] [--memory MB]\n"
+               "                         [--throttle ms] [--set name=value ...] [--sweep name=a,b,... ...]\n"
+               "                         [--record file | --replay file]\n");
+}
+
+// A whole decimal number, nothing before or after it
+static int parseCount(const char *text, unsigned long *value)
+{
+  char *end;
+  if (text[0] < '0' || text[0] > '9')
+    return 0;
+  *value = strtoul(text, &end, 10);
+  return *end == '\0';
+}
+
+// One child process per grid point, so every run starts from a fresh world
+// and its peak RSS is its own
+static int runSweep(const SweepAxis *axes, int axisCount, unsigned int ticks, unsigned int seed, int bot,
+                    int serial)
+{
+  for (int a = 0; a < axisCount; a++)
+    printf("%s,", world->tunables[axes[a].tunable].name);
+  printf("seed,ticks,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,heap_mb,rss_mb,monsters,chunks,deaths\n");
+
+  int point[SWEEP_MAX_AXES] = {0};
+  int failed = 0;
+  for (;;)
+  {
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0)
+    {
+      fprintf(stderr, "could not start a sweep run\n");
+      return 1;
+    }
+    if (child == 0)
+    {
+      for (int a = 0; a < axisCount; a++)
+        setTunable(axes[a].tunable, axes[a].values[point[a]]);
+      seedRandom(seed);
+      initJobs(0);
+      setSerialJobs(serial);
+      initGame();
+
+      RunResult result = {malloc(sizeof(float) * (ticks ? ticks : 1)), 0.0, 0.0, 0};
+      runTicks(ticks, bot, 0, &result);
+      double percentiles[5];
+      tickPercentiles(result.tickMs, ticks, percentiles);
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+
+      for (int a = 0; a < axisCount; a++)
+        printf("%d,", world->tunables[axes[a].tunable].value);
+      printf("%u,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.2f,%.2f,%d,%d,%d\n", seed, ticks, percentiles[0], percentiles[1],
+             percentiles[2], percentiles[3], percentiles[4], world->memoryStats.total / (1024.0 * 1024.0),
+             usage.ru_maxrss / 1024.0, world->monsterCount, world->loadedChunkCount, result.deaths);
+      fflush(stdout);
+      shutdownJobs();
+      _exit(0);
+    }
+
+    int status;
+    if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      failed = 1;
+
+    // Next grid point, last axis fastest
+    int a = axisCount - 1;
+    while (a >= 0 && ++point[a] == axes[a].count)
+      point[a--] = 0;
+    if (a < 0)
+      break;
+  }
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned int ticks = 3600;
+  unsigned int seed = (unsigned int)time(NULL);
+  int bot = 0;
+  int serial = 0;
+  int observe = 0;
+  const char *recordPath = NULL;
+  const char *replayPath = NULL;
+  SweepAxis axes[SWEEP_MAX_AXES];
+  int axisCount = 0;
+  initWorld(&mainWorld);
+
+  int positional = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    const char *option = argv[i];
+    if (strcmp(option, "--help") == 0 || strcmp(option, "-h") == 0)
+    {
+      printUsage(stdout);
+      return 0;
+    }
+    if (strcmp(option, "--bot") == 0)
+    {
+      bot = 1;
+      continue;
+    }
+    if (strcmp(option, "--serial") == 0)
+    {
+      serial = 1;
+      continue;
+    }
+    if (strcmp(option, "--observe") == 0)
+    {
+      observe = 1;
+      continue;
+    }
+
+    if (option[0] != '-')
+    {
+      unsigned long number;
+      if (positional == 2 || !parseCount(option, &number))
+      {
+        fprintf(stderr, positional == 2 ? "unexpected argument %s\n" : "%s is not a number\n", option);
+        printUsage(stderr);
+        return 1;
+      }
+      if (positional++ == 0)
+        ticks = (unsigned int)number;
+      else
+        seed = (unsigned int)number;
+      continue;
+    }
+
+    // Everything else takes a value
+    int known = strcmp(option, "--memory") == 0 || strcmp(option, "--throttle") == 0 ||
+                strcmp(option, "--set") == 0 || strcmp(option, "--sweep") == 0 || strcmp(option, "--record") == 0 ||
+                strcmp(option, "--replay") == 0;
+    if (!known || i + 1 == argc)
+    {
+      fprintf(stderr, known ? "%s needs a value\n" : "unknown option %s\n", option);
+      printUsage(stderr);
+      return 1;
+    }
+    const char *value = argv[++i];
+
+    if (strcmp(option, "--memory") == 0)
+    {
+      unsigned long megabytes;
+      if (!parseCount(value, &megabytes))
+      {
+        fprintf(stderr, "bad memory budget %s (megabytes)\n", value);
+        return 1;
+      }
+      setMemoryBudget((size_t)megabytes << 20);
+    }
+    else if (strcmp(option, "--throttle") == 0)
+    {
+      char *end;
+      double ms = strtod(value, &end);
+      if (end == value || *end != '\0' || ms < 0.0)
+      {
+        fprintf(stderr, "bad frame budget %s (milliseconds)\n", value);
+        return 1;
+      }
+      setThrottleBudget(ms);
+    }
+    else if (strcmp(option, "--set") == 0)
+    {
+      if (!parseTunableAssignment(value))
+      {
+        fprintf(stderr, "bad tunable setting %s\n", value);
+        return 1;
+      }
+    }
+    else if (strcmp(option, "--sweep") == 0)
+    {
+      if (axisCount == SWEEP_MAX_AXES || !parseSweepAxis(value, &axes[axisCount++]))
+      {
+        fprintf(stderr, "bad sweep %s (name=a,b,..., at most %d axes of %d values)\n", value, SWEEP_MAX_AXES,
+                SWEEP_MAX_VALUES);
+        return 1;
+      }
+    }
+    else if (strcmp(option, "--record") == 0)
+      recordPath = value;
+    else
+      replayPath = value;
+  }
+
+  if (axisCount > 0)
+    return runSweep(axes, axisCount, ticks, seed, bot, serial);
+
+  if (replayPath)
+  {
+    if (!startPlayback(replayPath, &seed))
+    {
+      fprintf(stderr, "could not read replay %s\n", replayPath);
+      return 1;
+    }
+    if (world->replayStats.length > 0)
+      ticks = world->replayStats.length;
+    bot = 0; // The replay supplies the input
+  }
+  else if (recordPath && !startRecording(recordPath, seed))
+  {
+    fprintf(stderr, "could not write replay %s\n", recordPath);
+    return 1;
+  }
+
+  seedRandom(seed);
+  initJobs(0);
+  setSerialJobs(serial);
+  initGame();
+
+  RunResult result = {malloc(sizeof(float) * (ticks ? ticks : 1)), 0.0, 0.0, 0};
+  runTicks(ticks, bot, observe, &result);
+  double elapsed = result.elapsed;
+  double percentiles[5];
+  tickPercentiles(result.tickMs, ticks, percentiles);
+  free(result.tickMs);
+
+  printf("%u ticks in %.3f s (%.0f ticks/s, %.1fx real time), seed %u\n", ticks, elapsed,
+         ticks / elapsed, ticks / elapsed / SIM_TICKS_PER_SECOND, seed);
+  printf("player at (%d,%d) level %d health %d/%d, %d deaths; %d monsters, %d chunks loaded\n",
+         world->player.x, world->player.y, world->player.level, world->player.health, world->player.maxHealth, result.deaths, world->monsterCount,
+         world->loadedChunkCount);
+  printf("tick time: mean %.3f ms, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n", percentiles[0], percentiles[1],
+         percentiles[2], percentiles[3], percentiles[4]);
+  printf("frame arenas: %.0f KB reserved, peak %.0f KB in one tick, %d overflows, last malloc at tick %u\n",
+         world->frameArenaStats.capacity / 1024.0, world->frameArenaStats.highWater / 1024.0, world->frameArenaStats.overflows,
+         world->frameArenaStats.lastHeapTick);
+  printf("memory %.1f MB", world->memoryStats.total / (1024.0 * 1024.0));
+  if (world->memoryStats.budget > 0)
+    printf(" of %.0f MB", world->memoryStats.budget / (1024.0 * 1024.0));
+  for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++)
+    printf("%s %s %.1f", i == 0 ? ":" : ",", memorySubsystemNames[i], world->memoryStats.used[i] / (1024.0 * 1024.0));
+  printf("; window %d, %d rewind saves, %d trims, %d regrows\n", world->memoryStats.chunkWindow, world->memoryStats.ringDepth,
+         world->memoryStats.trims, world->memoryStats.regrows);
+  if (world->throttleStats.budgetMs > 0.0)
+  {
+    printf("throttle: level %d (%s) at the end, %d changes; slowest frame of the last window %.3f of %.3f ms\n",
+           world->throttleStats.level, throttleLevelNames[world->throttleStats.level], world->throttleStats.decisions,
+           world->throttleStats.slowestMs, world->throttleStats.budgetMs);
+    int first = world->throttleStats.decisions > THROTTLE_LOG_SIZE ? world->throttleStats.decisions - THROTTLE_LOG_SIZE : 0;
+    for (int i = first; i < world->throttleStats.decisions; i++)
+    {
+      const ThrottleDecision *decision = &world->throttleStats.log[i % THROTTLE_LOG_SIZE];
+      printf("  tick %u: level %d (%s), slowest frame %.3f ms\n", decision->tick, decision->level,
+             throttleLevelNames[decision->level], decision->slowestMs);
+    }
+  }
+  if (observe)
+    printf("observation %dx%dx%d encoded in %.2f us on average\n", OBSERVATION_SIZE, OBSERVATION_SIZE,
+           OBSERVATION_CHANNELS, result.observeTime * 1e6 / ticks);
+
+  int diverged = 0;
+  if (world->replayStats.mode != REPLAY_OFF)
+  {
+    // A damaged file either has records it never reached or ends early
+    diverged = world->replayStats.divergedTick >= 0 || world->replayStats.mode == REPLAY_PLAYING ||
+               (replayPath && world->replayStats.tick < world->replayStats.length);
+    if (replayPath && world->replayStats.divergedTick >= 0)
+      printf("replay diverged: state differs at tick %d (within the %d ticks before it)\n",
+             world->replayStats.divergedTick, REPLAY_CHECK_INTERVAL);
+    else if (replayPath && diverged)
+      printf("replay damaged: playback stopped at tick %u of %u\n", world->replayStats.tick, world->replayStats.length);
+    else if (replayPath)
+      printf("replay matched: %d checkpoints over %u ticks, state hash %016llx%s\n", world->replayStats.checkpoints,
+             world->replayStats.tick, (unsigned long long)world->replayStats.stateHash,
+             world->replayStats.buildMismatch ? " (recorded by another build)" : "");
+    stopReplay();
+    if (recordPath)
+      printf("recorded %u ticks, %d checkpoints, %ld bytes, state hash %016llx\n", world->replayStats.tick,
+             world->replayStats.checkpoints, world->replayStats.bytes, (unsigned long long)world->replayStats.stateHash);
+  }
+
+  shutdownJobs();
+  return diverged;
+}
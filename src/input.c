@@ -0,0 +1,66 @@
+#include "types.h"
+#include "input.h"
+
+// Takes the held keys from a newer poll and adds its latched presses
+void mergeInput(InputState *into, const InputState *from)
+{
+  into->up = from->up;
+  into->down = from->down;
+  into->left = from->left;
+  into->right = from->right;
+  into->shoot = from->shoot;
+
+  into->jumpSmash |= from->jumpSmash;
+  into->rush |= from->rush;
+  into->heal |= from->heal;
+  into->restart |= from->restart;
+  into->toggleNight |= from->toggleNight;
+  into->rewind |= from->rewind;
+  if (from->clicked)
+  {
+    into->clicked = 1;
+    into->clickX = from->clickX;
+    into->clickY = from->clickY;
+  }
+}
+
+// Clears the latched presses once they have been acted on
+void consumeInput(InputState *state)
+{
+  state->jumpSmash = 0;
+  state->rush = 0;
+  state->heal = 0;
+  state->restart = 0;
+  state->toggleNight = 0;
+  state->rewind = 0;
+  state->clicked = 0;
+}
+
+unsigned int inputMask(const InputState *state)
+{
+  return (state->up ? INPUT_UP : 0) | (state->down ? INPUT_DOWN : 0) | (state->left ? INPUT_LEFT : 0) |
+         (state->right ? INPUT_RIGHT : 0) | (state->shoot ? INPUT_SHOOT : 0) |
+         (state->jumpSmash ? INPUT_JUMP_SMASH : 0) | (state->rush ? INPUT_RUSH : 0) |
+         (state->heal ? INPUT_HEAL : 0) | (state->restart ? INPUT_RESTART : 0) |
+         (state->toggleNight ? INPUT_TOGGLE_NIGHT : 0) | (state->clicked ? INPUT_CLICKED : 0) |
+         ((unsigned int)state->throttle << INPUT_THROTTLE_SHIFT & INPUT_THROTTLE);
+}
+
+// Replaces everything but rewind with the packed input
+void inputFromMask(InputState *state, unsigned int mask, int clickX, int clickY)
+{
+  state->up = (mask & INPUT_UP) != 0;
+  state->down = (mask & INPUT_DOWN) != 0;
+  state->left = (mask & INPUT_LEFT) != 0;
+  state->right = (mask & INPUT_RIGHT) != 0;
+  state->shoot = (mask & INPUT_SHOOT) != 0;
+  state->jumpSmash = (mask & INPUT_JUMP_SMASH) != 0;
+  state->rush = (mask & INPUT_RUSH) != 0;
+  state->heal = (mask & INPUT_HEAL) != 0;
+  state->restart = (mask & INPUT_RESTART) != 0;
+  state->toggleNight = (mask & INPUT_TOGGLE_NIGHT) != 0;
+  state->clicked = (mask & INPUT_CLICKED) != 0;
+  state->throttle = (int)((mask & INPUT_THROTTLE) >> INPUT_THROTTLE_SHIFT);
+  state->clickX = clickX;
+  state->clickY = clickY;
+}
@@ -0,0 +1,50 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "types.h"
+
+// Player input as the simulation sees it. Held keys reflect the latest
+// rendered frame; presses and clicks are latched until a simulation tick
+// consumes them, so none are lost when a frame runs no tick.
+typedef struct
+{
+  int up, down, left, right; // Movement keys held
+  int shoot;                 // Arrow key held
+  int jumpSmash, rush, heal; // Ability keys pressed since the last tick
+  int restart;               // Restart pressed since the last tick
+  int toggleNight;           // Night mode toggled since the last tick
+  int rewind;                // Rewind pressed since the last tick
+  int clicked;               // Left click since the last tick
+  int clickX, clickY;        // World cell of the most recent click
+  int throttle;              // Frame governor level this tick runs at (set by simulationTick)
+} InputState;
+
+// The same input packed into bits, as replays store it and batch worlds take
+// it (rewind is left out: it is not an input a replay can hold). The frame
+// governor's level rides along in the top bits, so replays repeat it.
+enum
+{
+  INPUT_UP = 1 << 0,
+  INPUT_DOWN = 1 << 1,
+  INPUT_LEFT = 1 << 2,
+  INPUT_RIGHT = 1 << 3,
+  INPUT_SHOOT = 1 << 4,
+  INPUT_JUMP_SMASH = 1 << 5,
+  INPUT_RUSH = 1 << 6,
+  INPUT_HEAL = 1 << 7,
+  INPUT_RESTART = 1 << 8,
+  INPUT_TOGGLE_NIGHT = 1 << 9,
+  INPUT_CLICKED = 1 << 10,
+  INPUT_THROTTLE_SHIFT = 11,
+  INPUT_THROTTLE = 7 << INPUT_THROTTLE_SHIFT,
+};
+
+// Function declarations for input latching (pollInput is provided by the
+// platform layer)
+void pollInput(InputState *state);
+void mergeInput(InputState *into, const InputState *from);
+void consumeInput(InputState *state);
+unsigned int inputMask(const InputState *state);
+void inputFromMask(InputState *state, unsigned int mask, int clickX, int clickY);
+
+#endif
@@ -0,0 +1,390 @@
+#define _POSIX_C_SOURCE 200809L
+#include "jobs.h"
+#include "globals.h"
+#include "platform.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// Work-stealing scheduler: every thread owns a deque of jobs. It pushes and
+// pops at the bottom (newest first, still warm in cache) while idle threads
+// steal from the top (oldest, usually the biggest piece left). parallelFor
+// splits its range lazily: a range only halves while other threads could
+// pick up the half, so a busy pool runs a few big ranges and an idle one
+// spreads out down to the grain. Threads with nothing to run or steal sleep
+// on jobWake. Deque 0 belongs to the submitting thread, which works too, so
+// a pool of N threads starts N-1 workers.
+
+#define JOB_DEQUE_SIZE 1024 // Jobs per deque (power of two); a full deque runs new jobs inline
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  Job jobs[JOB_DEQUE_SIZE];
+  unsigned int top, bottom; // Thieves take at top, the owner pushes and pops at bottom
+
+  // Utilization counters, reset by sampleJobStats (atomic)
+  long long busyNs;
+  int jobsRun;
+  int steals;
+} JobDeque;
+
+static JobDeque deques[MAX_JOB_THREADS];
+static pthread_t workers[MAX_JOB_THREADS];
+static int workerCount = 0;
+static int dequesReady = 0;
+static __thread int threadIndex = 0; // Own deque; 0 for threads outside the pool
+
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobWake = PTHREAD_COND_INITIALIZER; // New jobs, a counter reached zero, or shutdown
+static int queuedJobs = 0;      // Jobs waiting in any deque (atomic)
+static int sleepingThreads = 0; // Threads blocked on jobWake (atomic)
+static int jobStopping = 0;
+static int serial = 0; // Debugging: run every job inline on the submitting thread
+
+static void executeJob(Job *job);
+
+static int pushJob(JobDeque *deque, const Job *job)
+{
+  pthread_mutex_lock(&deque->lock);
+  if (deque->bottom - deque->top == JOB_DEQUE_SIZE)
+  {
+    pthread_mutex_unlock(&deque->lock);
+    return 0;
+  }
+  deque->jobs[deque->bottom & (JOB_DEQUE_SIZE - 1)] = *job;
+  deque->bottom++;
+  pthread_mutex_unlock(&deque->lock);
+
+  // Pairs with the sleeper's check in sleepUntilWork: one of us sees the other
+  __atomic_add_fetch(&queuedJobs, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&sleepingThreads, __ATOMIC_SEQ_CST) > 0)
+  {
+    pthread_mutex_lock(&jobLock);
+    pthread_cond_signal(&jobWake); // One job, one thread; whoever wakes takes it
+    pthread_mutex_unlock(&jobLock);
+  }
+  return 1;
+}
+
+static int popJob(JobDeque *deque, Job *job)
+{
+  pthread_mutex_lock(&deque->lock);
+  if (deque->bottom == deque->top)
+  {
+    pthread_mutex_unlock(&deque->lock);
+    return 0;
+  }
+  deque->bottom--;
+  *job = deque->jobs[deque->bottom & (JOB_DEQUE_SIZE - 1)];
+  pthread_mutex_unlock(&deque->lock);
+  __atomic_sub_fetch(&queuedJobs, 1, __ATOMIC_SEQ_CST);
+  return 1;
+}
+
+static int stealJob(JobDeque *deque, Job *job)
+{
+  pthread_mutex_lock(&deque->lock);
+  if (deque->bottom == deque->top)
+  {
+    pthread_mutex_unlock(&deque->lock);
+    return 0;
+  }
+  *job = deque->jobs[deque->top & (JOB_DEQUE_SIZE - 1)];
+  deque->top++;
+  pthread_mutex_unlock(&deque->lock);
+  __atomic_sub_fetch(&queuedJobs, 1, __ATOMIC_SEQ_CST);
+  return 1;
+}
+
+// Own deque first, then every other thread's, starting with the next one
+static int findJob(Job *job)
+{
+  if (popJob(&deques[threadIndex], job))
+    return 1;
+  if (__atomic_load_n(&queuedJobs, __ATOMIC_SEQ_CST) == 0)
+    return 0;
+
+  int threads = workerCount + 1;
+  for (int n = 1; n < threads; n++)
+  {
+    int victim = (threadIndex + n) % threads;
+    if (stealJob(&deques[victim], job))
+    {
+      __atomic_add_fetch(&deques[threadIndex].steals, 1, __ATOMIC_RELAXED);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Blocks until there is a job to take, the counter (if any) reaches zero or
+// the pool shuts down
+static void sleepUntilWork(JobCounter *counter)
+{
+  pthread_mutex_lock(&jobLock);
+  __atomic_add_fetch(&sleepingThreads, 1, __ATOMIC_SEQ_CST);
+  while (!jobStopping && __atomic_load_n(&queuedJobs, __ATOMIC_SEQ_CST) == 0 &&
+         (counter == NULL || __atomic_load_n(&counter->pending, __ATOMIC_SEQ_CST) > 0))
+    pthread_cond_wait(&jobWake, &jobLock);
+  __atomic_sub_fetch(&sleepingThreads, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&jobLock);
+}
+
+static void submitJob(const Job *job)
+{
+  Job copy = *job;
+  if (serialJobs() || workerCount == 0 || !pushJob(&deques[threadIndex], &copy))
+    executeJob(&copy);
+}
+
+// One job of the counter is done; the last one starts its continuations
+static void finishJob(JobCounter *counter)
+{
+  if (counter == NULL)
+    return;
+
+  // Without workers every job ran inline on this thread, so nobody else can
+  // be waiting on the counter (the batch library's pool threads all get here)
+  if (workerCount == 0)
+  {
+    if (__atomic_sub_fetch(&counter->pending, 1, __ATOMIC_SEQ_CST) > 0)
+      return;
+    int count = counter->continuationCount;
+    counter->continuationCount = 0;
+    for (int i = 0; i < count; i++)
+      submitJob(&counter->continuations[i]);
+    return;
+  }
+
+  // Decremented under the lock so a waiter that sees zero can't return (and
+  // free the counter) before this thread is done with it
+  Job continuations[MAX_JOB_CONTINUATIONS];
+  pthread_mutex_lock(&jobLock);
+  if (__atomic_sub_fetch(&counter->pending, 1, __ATOMIC_SEQ_CST) > 0)
+  {
+    pthread_mutex_unlock(&jobLock);
+    return;
+  }
+  int count = counter->continuationCount;
+  for (int i = 0; i < count; i++)
+    continuations[i] = counter->continuations[i];
+  counter->continuationCount = 0;
+  pthread_cond_broadcast(&jobWake); // Wake anyone in waitForJobs
+  pthread_mutex_unlock(&jobLock);
+
+  for (int i = 0; i < count; i++)
+    submitJob(&continuations[i]);
+}
+
+// Hands the upper half of a range to whoever is idle, while anyone could be
+static void runRange(Job *job)
+{
+  int threads = workerCount + 1;
+  while (!serialJobs() && workerCount > 0 && job->end - job->begin > job->grain &&
+         __atomic_load_n(&queuedJobs, __ATOMIC_RELAXED) < threads)
+  {
+    Job half = *job;
+    half.begin = job->begin + (job->end - job->begin) / 2;
+    __atomic_add_fetch(&job->counter->pending, 1, __ATOMIC_SEQ_CST);
+    if (!pushJob(&deques[threadIndex], &half))
+    {
+      __atomic_sub_fetch(&job->counter->pending, 1, __ATOMIC_SEQ_CST);
+      break;
+    }
+    job->end = half.begin;
+  }
+  job->rangeFn(job->begin, job->end, job->data);
+}
+
+static void executeJob(Job *job)
+{
+  double start = platformTimer();
+  if (job->rangeFn != NULL)
+    runRange(job);
+  else
+    job->fn(job->data);
+
+  JobDeque *deque = &deques[threadIndex];
+  __atomic_add_fetch(&deque->busyNs, (long long)((platformTimer() - start) * 1e9), __ATOMIC_RELAXED);
+  __atomic_add_fetch(&deque->jobsRun, 1, __ATOMIC_RELAXED);
+  finishJob(job->counter);
+}
+
+static void *workerMain(void *arg)
+{
+  threadIndex = (int)(intptr_t)arg;
+  for (;;)
+  {
+    Job job;
+    if (findJob(&job))
+    {
+      executeJob(&job);
+      continue;
+    }
+
+    pthread_mutex_lock(&jobLock);
+    int stopping = jobStopping;
+    pthread_mutex_unlock(&jobLock);
+    if (stopping)
+      break;
+    sleepUntilWork(NULL);
+  }
+  return NULL;
+}
+
+void initJobs(int threadCount)
+{
+  if (threadCount <= 0)
+    threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threadCount < 1)
+    threadCount = 1;
+  if (threadCount > MAX_JOB_THREADS)
+    threadCount = MAX_JOB_THREADS;
+
+  if (!dequesReady)
+  {
+    for (int i = 0; i < MAX_JOB_THREADS; i++)
+      pthread_mutex_init(&deques[i].lock, NULL);
+    dequesReady = 1;
+  }
+
+  jobStopping = 0;
+  workerCount = 0;
+  for (int i = 0; i < threadCount - 1; i++)
+  {
+    if (pthread_create(&workers[workerCount], NULL, workerMain, (void *)(intptr_t)(workerCount + 1)) != 0)
+      break; // Run with whatever we got
+    workerCount++;
+  }
+  world->lastSampleTime = platformTimer();
+}
+
+void shutdownJobs()
+{
+  pthread_mutex_lock(&jobLock);
+  jobStopping = 1;
+  pthread_cond_broadcast(&jobWake);
+  pthread_mutex_unlock(&jobLock);
+
+  for (int i = 0; i < workerCount; i++)
+    pthread_join(workers[i], NULL);
+  workerCount = 0;
+}
+
+int jobThreadCount()
+{
+  return workerCount + 1;
+}
+
+int jobThreadIndex()
+{
+  return threadIndex;
+}
+
+// Debugging aid: with serial set every job and range runs inline, in order,
+// on the submitting thread
+void setSerialJobs(int enabled)
+{
+  __atomic_store_n(&serial, enabled != 0, __ATOMIC_SEQ_CST);
+}
+
+int serialJobs()
+{
+  return __atomic_load_n(&serial, __ATOMIC_SEQ_CST);
+}
+
+void runJob(JobFn fn, void *data, JobCounter *counter)
+{
+  Job job = {0};
+  job.fn = fn;
+  job.data = data;
+  job.counter = counter;
+  if (counter != NULL)
+    __atomic_add_fetch(&counter->pending, 1, __ATOMIC_SEQ_CST);
+  submitJob(&job);
+}
+
+// Starts fn once every job of dependency has finished
+void runJobAfter(JobCounter *dependency, JobFn fn, void *data, JobCounter *counter)
+{
+  Job job = {0};
+  job.fn = fn;
+  job.data = data;
+  job.counter = counter;
+  if (counter != NULL)
+    __atomic_add_fetch(&counter->pending, 1, __ATOMIC_SEQ_CST);
+
+  pthread_mutex_lock(&jobLock);
+  if (__atomic_load_n(&dependency->pending, __ATOMIC_SEQ_CST) > 0 &&
+      dependency->continuationCount < MAX_JOB_CONTINUATIONS)
+  {
+    dependency->continuations[dependency->continuationCount++] = job;
+    pthread_mutex_unlock(&jobLock);
+    return;
+  }
+  pthread_mutex_unlock(&jobLock);
+
+  waitForJobs(dependency); // No-op unless the continuation list was full
+  submitJob(&job);
+}
+
+// Runs other jobs until the counter drops to zero
+void waitForJobs(JobCounter *counter)
+{
+  while (__atomic_load_n(&counter->pending, __ATOMIC_SEQ_CST) > 0)
+  {
+    Job job;
+    if (findJob(&job))
+      executeJob(&job);
+    else
+      sleepUntilWork(counter);
+  }
+
+  // The thread that finished the last job may still be reading the
+  // continuations; it is done once it has released the lock
+  if (workerCount == 0)
+    return;
+  pthread_mutex_lock(&jobLock);
+  pthread_mutex_unlock(&jobLock);
+}
+
+void parallelFor(int count, int grain, JobRangeFn fn, void *context)
+{
+  if (count <= 0)
+    return;
+  if (grain < 1)
+    grain = 1;
+
+  // The whole range starts on this thread and is split up as others go idle
+  JobCounter counter = {0};
+  Job job = {0};
+  job.rangeFn = fn;
+  job.data = context;
+  job.begin = 0;
+  job.end = count;
+  job.grain = grain;
+  job.counter = &counter;
+  counter.pending = 1;
+  executeJob(&job);
+  waitForJobs(&counter);
+}
+
+// Once per simulation tick: turns the counters into per-thread utilization
+void sampleJobStats()
+{
+  double now = platformTimer();
+  double elapsed = now - world->lastSampleTime;
+  world->lastSampleTime = now;
+
+  world->jobStats.threads = workerCount + 1;
+  world->jobStats.serial = serialJobs();
+  world->jobStats.steals = 0;
+  for (int i = 0; i < world->jobStats.threads; i++)
+  {
+    long long busyNs = __atomic_exchange_n(&deques[i].busyNs, 0, __ATOMIC_RELAXED);
+    world->jobStats.utilization[i] = elapsed > 0.0 ? (float)(busyNs * 1e-9 / elapsed) : 0.0f;
+    world->jobStats.jobsRun[i] = __atomic_exchange_n(&deques[i].jobsRun, 0, __ATOMIC_RELAXED);
+    world->jobStats.steals += __atomic_exchange_n(&deques[i].steals, 0, __ATOMIC_RELAXED);
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include "types.h"
+
+#define MAX_JOB_THREADS 32
+#define MAX_JOB_CONTINUATIONS 8 // Jobs that can wait on one counter
+
+// Work function for parallelFor: handles items [begin, end)
+typedef void (*JobRangeFn)(int begin, int end, void *context);
+
+// Work function for a single job
+typedef void (*JobFn)(void *data);
+
+typedef struct JobCounter JobCounter;
+
+typedef struct
+{
+  JobFn fn;
+  void *data;
+  JobRangeFn rangeFn; // Set for parallelFor ranges instead of fn
+  int begin, end;
+  int grain;
+  JobCounter *counter; // Decremented when the job finishes (may be NULL)
+} Job;
+
+// Counts unfinished jobs. Jobs started with runJobAfter wait here until it
+// drops to zero; waitForJobs helps with other work until then.
+struct JobCounter
+{
+  int pending;
+  int continuationCount;
+  Job continuations[MAX_JOB_CONTINUATIONS];
+};
+
+// Scheduler statistics (refreshed every tick by sampleJobStats)
+typedef struct
+{
+  int threads;                        // Pool size, including the submitting thread
+  int serial;                         // Everything runs inline on the submitting thread
+  float utilization[MAX_JOB_THREADS]; // Share of the last tick each thread spent running jobs
+  int jobsRun[MAX_JOB_THREADS];       // Jobs (or ranges) each thread ran last tick
+  int steals;                         // Jobs taken from another thread's deque last tick
+} JobStats;
+
+// Function declarations for the work-stealing job scheduler. Jobs are
+// submitted from one thread outside the pool (the simulation) or from jobs.
+void initJobs(int threadCount); // 0 = one thread per CPU core
+void shutdownJobs();
+int jobThreadCount();
+int jobThreadIndex(); // 0 outside the pool, 1..jobThreadCount()-1 on workers
+void setSerialJobs(int serial);
+int serialJobs();
+void runJob(JobFn fn, void *data, JobCounter *counter);
+void runJobAfter(JobCounter *dependency, JobFn fn, void *data, JobCounter *counter);
+void waitForJobs(JobCounter *counter);
+void parallelFor(int count, int grain, JobRangeFn fn, void *context);
+void sampleJobStats();
+
+#endif
@@ -0,0 +1,306 @@
+#include "types.h"
+#include "globals.h"
+#include "world.h"
+#include "lighting.h"
+#include "fire.h"
+#include "savestate.h"
+#include "platform.h"
+#include <stdlib.h>
+#include <math.h>
+
+// Night mode. Every loaded chunk keeps a light level per cell. Light spreads
+// from each source by breadth-first flood, losing one level per step; a cell
+// keeps the brightest light that reaches it and mountains stop it.
+//
+// Nothing is recomputed from scratch. Each frame the source list is diffed
+// against last frame's: a source that dimmed, moved or vanished is removed by
+// a reverse flood that darkens exactly the cells it lit (collecting the edge
+// where other light still shines), then every source and that edge are
+// flooded outwards again. Only cells whose level actually changes are written.
+
+#define TORCH_LIGHT MAX_LIGHT_LEVEL // Player's torch
+#define LIGHTNING_LIGHT 8           // Lightning bolt in flight
+#define FIREBALL_LIGHT 7            // Fireball in flight
+#define BURNING_LIGHT 6             // Burning tree
+
+void forgetLightChunk()
+{
+  world->cachedChunkIndex = -1;
+}
+
+static Chunk *lightChunk(int worldX, int worldY, int *localX, int *localY)
+{
+  WorldPosition pos = worldToChunk(worldX, worldY);
+  if (world->cachedChunkIndex == -1 || pos.chunkX != world->cachedChunkX || pos.chunkY != world->cachedChunkY ||
+      world->loadedChunks[world->cachedChunkIndex].chunkX != pos.chunkX || world->loadedChunks[world->cachedChunkIndex].chunkY != pos.chunkY)
+  {
+    world->cachedChunkX = pos.chunkX;
+    world->cachedChunkY = pos.chunkY;
+    world->cachedChunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+  }
+  if (world->cachedChunkIndex == -1)
+    return NULL;
+
+  *localX = pos.localX;
+  *localY = pos.localY;
+  return &world->loadedChunks[world->cachedChunkIndex];
+}
+
+// Light level at a cell, or -1 if the cell isn't loaded
+static int getLight(int worldX, int worldY)
+{
+  int lx, ly;
+  Chunk *chunk = lightChunk(worldX, worldY, &lx, &ly);
+  return chunk ? chunk->light[lx][ly] : -1;
+}
+
+static void setLight(int worldX, int worldY, int level)
+{
+  int lx, ly;
+  Chunk *chunk = lightChunk(worldX, worldY, &lx, &ly);
+  if (chunk == NULL)
+    return;
+
+  chunk->light[lx][ly] = (unsigned char)level;
+  world->lightStats.cellsUpdated++;
+}
+
+static int blocksLight(int worldX, int worldY)
+{
+  int lx, ly;
+  Chunk *chunk = lightChunk(worldX, worldY, &lx, &ly);
+  return chunk == NULL || chunk->terrain[lx][ly] == TERRAIN_MOUNTAIN;
+}
+
+static void pushAdd(int x, int y, int level)
+{
+  if (((world->addTail + 1) & (LIGHT_QUEUE_SIZE - 1)) == world->addHead)
+    return; // Queue full; the light stays a little short until its source changes
+  world->addQueue[world->addTail].x = x;
+  world->addQueue[world->addTail].y = y;
+  world->addQueue[world->addTail].level = (unsigned char)level;
+  world->addTail = (world->addTail + 1) & (LIGHT_QUEUE_SIZE - 1);
+}
+
+static const int stepX[4] = {0, 0, -1, 1};
+static const int stepY[4] = {-1, 1, 0, 0};
+
+// Darkens everything lit from the seeded cells; cells lit from elsewhere
+// are queued so the add flood can refill the darkened area
+static void floodRemove(int seeds)
+{
+  int head = 0, tail = seeds;
+
+  while (head != tail)
+  {
+    LightNode node = world->removeQueue[head];
+    head = (head + 1) & (LIGHT_QUEUE_SIZE - 1);
+
+    for (int n = 0; n < 4; n++)
+    {
+      int x = node.x + stepX[n];
+      int y = node.y + stepY[n];
+      int level = getLight(x, y);
+      if (level <= 0)
+        continue;
+
+      if (level < node.level)
+      {
+        setLight(x, y, 0);
+        if (((tail + 1) & (LIGHT_QUEUE_SIZE - 1)) == head)
+          continue;
+        world->removeQueue[tail].x = x;
+        world->removeQueue[tail].y = y;
+        world->removeQueue[tail].level = (unsigned char)level;
+        tail = (tail + 1) & (LIGHT_QUEUE_SIZE - 1);
+      }
+      else
+      {
+        pushAdd(x, y, level);
+      }
+    }
+  }
+}
+
+static void floodAdd()
+{
+  while (world->addHead != world->addTail)
+  {
+    LightNode node = world->addQueue[world->addHead];
+    world->addHead = (world->addHead + 1) & (LIGHT_QUEUE_SIZE - 1);
+
+    int level = getLight(node.x, node.y);
+    if (level <= 1 || blocksLight(node.x, node.y))
+      continue;
+
+    for (int n = 0; n < 4; n++)
+    {
+      int x = node.x + stepX[n];
+      int y = node.y + stepY[n];
+      int neighbour = getLight(x, y);
+      if (neighbour >= 0 && neighbour < level - 1)
+      {
+        setLight(x, y, level - 1);
+        pushAdd(x, y, level - 1);
+      }
+    }
+  }
+}
+
+static int compareSources(const void *a, const void *b)
+{
+  const LightSource *sa = a;
+  const LightSource *sb = b;
+  if (sa->y != sb->y)
+    return sa->y < sb->y ? -1 : 1;
+  if (sa->x != sb->x)
+    return sa->x < sb->x ? -1 : 1;
+  return 0;
+}
+
+static void addSource(LightSource *list, int *count, int x, int y, int level)
+{
+  if (*count >= MAX_LIGHT_SOURCES)
+    return;
+  list[*count].x = x;
+  list[*count].y = y;
+  list[*count].level = level;
+  (*count)++;
+}
+
+// This frame's sources, sorted by cell with one entry (the brightest) per cell
+static int gatherSources(LightSource *list)
+{
+  int count = 0;
+
+  if (world->player.alive)
+    addSource(list, &count, world->player.x, world->player.y, TORCH_LIGHT);
+  for (int i = 0; i < world->projectiles.count; i++)
+  {
+    if (world->projectiles.type[i] == 0 || world->projectiles.type[i] == 1)
+      addSource(list, &count, (int)floorf(world->projectiles.x[i]), (int)floorf(world->projectiles.y[i]),
+                world->projectiles.type[i] == 0 ? LIGHTNING_LIGHT : FIREBALL_LIGHT);
+  }
+  for (int i = 0; i < getBurningCellCount(); i++)
+  {
+    int x, y;
+    getBurningCell(i, &x, &y);
+    addSource(list, &count, x, y, BURNING_LIGHT);
+  }
+
+  qsort(list, count, sizeof(LightSource), compareSources);
+  int unique = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (unique > 0 && compareSources(&list[unique - 1], &list[i]) == 0)
+    {
+      if (list[i].level > list[unique - 1].level)
+        list[unique - 1].level = list[i].level;
+      continue;
+    }
+    list[unique++] = list[i];
+  }
+  return unique;
+}
+
+void updateLighting()
+{
+  if (!world->nightMode)
+    return;
+
+  double updateStart = platformTimer();
+  const LightSource *previous = world->sourceLists[world->currentSources];
+  int previousCount = world->sourceListCounts[world->currentSources];
+  LightSource *next = world->sourceLists[world->currentSources ^ 1];
+  int nextCount = gatherSources(next);
+
+  world->lightStats.cellsUpdated = 0;
+  world->lightStats.changedSources = 0;
+
+  // Walk both sorted lists; every source that got dimmer or vanished seeds the removal flood
+  int seeds = 0;
+  int p = 0, q = 0;
+  while (p < previousCount || q < nextCount)
+  {
+    int order = p == previousCount ? 1 : (q == nextCount ? -1 : compareSources(&previous[p], &next[q]));
+    int oldLevel = order <= 0 ? previous[p].level : 0;
+    int newLevel = order >= 0 ? next[q].level : 0;
+    const LightSource *source = order <= 0 ? &previous[p] : &next[q];
+
+    if (oldLevel != newLevel)
+      world->lightStats.changedSources++;
+
+    // Only the source that set a cell's level can have lit anything uniquely
+    if (newLevel < oldLevel && getLight(source->x, source->y) == oldLevel && seeds < LIGHT_QUEUE_SIZE - 1)
+    {
+      setLight(source->x, source->y, 0);
+      world->removeQueue[seeds].x = source->x;
+      world->removeQueue[seeds].y = source->y;
+      world->removeQueue[seeds].level = (unsigned char)oldLevel;
+      seeds++;
+    }
+
+    if (order <= 0)
+      p++;
+    if (order >= 0)
+      q++;
+  }
+  floodRemove(seeds);
+
+  // Re-seed every source: the removal flood may have darkened one it overlapped
+  for (int i = 0; i < nextCount; i++)
+  {
+    int level = getLight(next[i].x, next[i].y);
+    if (level >= 0 && level < next[i].level)
+    {
+      setLight(next[i].x, next[i].y, next[i].level);
+      pushAdd(next[i].x, next[i].y, next[i].level);
+    }
+  }
+  floodAdd();
+
+  world->sourceListCounts[world->currentSources ^ 1] = nextCount;
+  world->currentSources ^= 1;
+  world->lightStats.sources = nextCount;
+  world->lightStats.lastUpdateMs = (platformTimer() - updateStart) * 1000.0;
+}
+
+// A chunk slot got new terrain: start it dark
+void resetChunkLight(int chunkIndex)
+{
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+  for (int x = 0; x < CHUNK_SIZE; x++)
+  {
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      chunk->light[x][y] = 0;
+    }
+  }
+}
+
+void toggleNightMode()
+{
+  world->nightMode = !world->nightMode;
+
+  // Start from darkness; the first update floods every source in
+  for (int i = 0; i < world->loadedChunkCount; i++)
+    resetChunkLight(i);
+  world->sourceListCounts[0] = world->sourceListCounts[1] = 0;
+  world->addHead = world->addTail = 0;
+}
+
+int isNightMode()
+{
+  return world->nightMode;
+}
+
+void streamLightingState(StateStream *stream)
+{
+  stateBlock(stream, &world->nightMode, sizeof(world->nightMode));
+  stateBlock(stream, &world->currentSources, sizeof(world->currentSources));
+  stateBlock(stream, world->sourceListCounts, sizeof(world->sourceListCounts));
+  for (int list = 0; list < 2; list++)
+    stateBlock(stream, world->sourceLists[list], sizeof(LightSource) * world->sourceListCounts[list]);
+  if (stream->restoring)
+    forgetLightChunk();
+}
@@ -0,0 +1,39 @@
+#ifndef LIGHTING_H
+#define LIGHTING_H
+
+#include "types.h"
+
+#define MAX_LIGHT_LEVEL 10 // Brightest light (the player's torch); no darkness at all
+#define MAX_LIGHT_SOURCES 4096
+#define LIGHT_QUEUE_SIZE (1 << 18) // Flood queue entries (power of two)
+
+// Lighting statistics (refreshed every frame while night mode is on)
+typedef struct
+{
+  int sources;         // Light-emitting cells this frame
+  int changedSources;  // Sources that appeared, moved, dimmed or vanished
+  int cellsUpdated;    // Light map writes this frame
+  double lastUpdateMs; // Wall time of the most recent updateLighting
+} LightStats;
+
+typedef struct
+{
+  int x, y;
+  int level;
+} LightSource;
+
+// Light flood queue entry
+typedef struct
+{
+  int x, y;
+  unsigned char level;
+} LightNode;
+
+// Function declarations for night lighting
+void toggleNightMode();
+int isNightMode();
+void resetChunkLight(int chunkIndex);
+void forgetLightChunk(); // Chunk slots were moved or reloaded
+void updateLighting();
+
+#endif
@@ -12,26 +12,74 @@
 #include "projectiles.h"
 #include "player.h"
 #include "monsters.h"
+#include "archetypes.h"
 #include "ui.h"
 #include "game.h"
-
-int main()
+#include "jobs.h"
+#include "particles.h"
+#include "terrain.h"
+#include "lighting.h"
+#include "fire.h"
+#include "input.h"
+#include "render.h"
+#include "snapshot.h"
+#include "simthread.h"
+#include "rng.h"
+#include "replay.h"
+#include "memory.h"
+#include "throttle.h"
+#include "tunables.h"
+#include "console.h"
+#include "platform.h"
+
+// usage: gridlock-arena [--record file | --replay file] [--memory MB] [--no-throttle] [--set name=value ...]
+int main(int argc, char **argv)
 {
+  initWorld(&mainWorld);
   SetConfigFlags(FLAG_WINDOW_HIGHDPI);
   InitWindow(WINDOW_SIZE, WINDOW_SIZE, "Gridlock Arena - Player Control");
   InitAudioDevice(); // Initialize audio device
-  SetTargetFPS(60);
+  int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+  SetTargetFPS(refreshRate > 0 ? refreshRate : 60); // Render at the display's rate
+
+  // Tunables and the memory budget first, so a recording stores them (a
+  // replay brings its own)
+  for (int i = 1; i + 1 < argc; i++)
+  {
+    if (strcmp(argv[i], "--set") == 0 && !parseTunableAssignment(argv[i + 1]))
+      TraceLog(LOG_WARNING, "TUNABLES: Could not set %s", argv[i + 1]);
+    else if (strcmp(argv[i], "--memory") == 0)
+      setMemoryBudget((size_t)strtoul(argv[i + 1], NULL, 10) << 20);
+  }
+
+  // Initialize random seed (a replay brings its own)
+  unsigned int seed = (unsigned int)time(NULL);
+  for (int i = 1; i + 1 < argc; i++)
+  {
+    if (strcmp(argv[i], "--replay") == 0 && !startPlayback(argv[i + 1], &seed))
+      TraceLog(LOG_WARNING, "REPLAY: Could not read %s", argv[i + 1]);
+    else if (strcmp(argv[i], "--record") == 0 && !startRecording(argv[i + 1], seed))
+      TraceLog(LOG_WARNING, "REPLAY: Could not write %s", argv[i + 1]);
+  }
+  seedRandom(seed);
+
+  // Shed load when frames run over one tick, unless told not to (benchmarks)
+  setThrottleBudget(SIM_TICK_SECONDS * 1000.0);
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--no-throttle") == 0)
+      setThrottleBudget(0.0);
+  }
 
-  // Initialize random seed
-  srand(time(NULL));
+  // Worker threads for monster AI
+  initJobs(0);
 
   // Load textures
   textures[0] = LoadTexture("emojis/2694.png");  // Knight (player)
-  textures[1] = LoadTexture("emojis/1f409.png"); // Dragon
-  textures[2] = LoadTexture("emojis/1f47a.png"); // Goblin
-  textures[3] = LoadTexture("emojis/1f479.png"); // Ogre
-  textures[4] = LoadTexture("emojis/1f47f.png"); // Troll
-  textures[5] = LoadTexture("emojis/1f9d9.png"); // Wizard
+  for (int i = 0; i < ARCHETYPE_COUNT; i++) // Monsters (see archetypes.h)
+  {
+    textures[archetypes[i].textureIndex] = LoadTexture(archetypes[i].texturePath);
+  }
   textures[6] = LoadTexture("emojis/26a1.png");  // Lightning bolt
   textures[7] = LoadTexture("emojis/1f525.png"); // Fireball
   textures[8] = LoadTexture("emojis/27a1.png");  // Arrow (right arrow)
@@ -43,72 +91,91 @@ int main()
   sounds[3] = LoadSound("sounds/death.wav");    // Death sound
   sounds[4] = LoadSound("sounds/victory.wav");  // Victory sound
 
+  // Camera follows the player; centred on the window
+  camera.offset = (Vector2){WINDOW_SIZE / 2.0f, WINDOW_SIZE / 2.0f};
+  camera.rotation = 0.0f;
+  camera.zoom = 1.0f;
+
   initGame();
 
   // No need for initial spawning - chunks will generate content
 
-  int spawnTimer = 0;
+  // From here on the simulation runs on its own thread; this one only
+  // polls input, plays sounds and draws snapshots
+  startSimulationThread();
+  int loggedDecisions = 0;
 
   while (!WindowShouldClose())
   {
-    // Update
-    if (player.alive)
+    // Hand this frame's input to the simulation (R restart and N night mode
+    // are handled there, on the next tick)
+    submitInput(renderStats.lastDrawMs);
+    playQueuedSounds();
+
+    if (IsKeyPressed(KEY_F3))
     {
-      updatePlayer();
-      updateMonsters();
-      checkCollisions();
-      updatePowerups();
-      updateLandmines();
-      updateProjectiles();
-      updateChunks(); // Update chunk loading/unloading
-
-      // Ensure monsters are nearby
-      ensureNearbyMonsters();
-
-      // Ensure powerups are nearby
-      ensureNearbyPowerups();
-
-      // Ensure landmines are nearby
-      ensureNearbyLandmines();
+      toggleDebugOverlay();
     }
 
-    // Auto-restart after death (after a short delay)
-    if (!player.alive && player.deathTimer <= 0)
+    if (IsKeyPressed(KEY_G) && !consoleOpen())
     {
-      player.deathTimer = 180; // 3 second delay before auto-restart
+      toggleGrid();
     }
-    if (!player.alive && player.deathTimer > 0)
+
+    // Debugging: run every job on the simulation thread, one after another
+    if (IsKeyPressed(KEY_F4))
     {
-      player.deathTimer--;
-      if (player.deathTimer <= 0)
-      {
-        restartGame();
-        spawnTimer = 0;
-      }
+      setSerialJobs(!serialJobs());
     }
 
-    // Manual restart on R key (works anytime)
-    if (IsKeyPressed(KEY_R))
+    // Draw the newest finished tick, interpolated by the time since it was published
+    const WorldSnapshot *snapshot = acquireSnapshot();
+
+    // ` opens the tunables console
+    updateConsole(snapshot);
+
+    // Log the frame governor's decisions as they show up
+    const ThrottleStats *throttle = &snapshot->throttleStats;
+    for (; loggedDecisions < throttle->decisions; loggedDecisions++)
     {
-      restartGame();
-      spawnTimer = 0;
+      if (throttle->decisions - loggedDecisions > THROTTLE_LOG_SIZE)
+        continue; // Overwritten before this frame saw it
+      const ThrottleDecision *decision = &throttle->log[loggedDecisions % THROTTLE_LOG_SIZE];
+      TraceLog(LOG_INFO, "THROTTLE: Tick %u: level %d (%s), slowest frame %.1f ms", decision->tick,
+               decision->level, throttleLevelNames[decision->level], decision->slowestMs);
     }
+    double sinceTick = (platformTimer() - snapshot->publishTime) / SIM_TICK_SECONDS;
+    renderAlpha = (float)(sinceTick < 0.0 ? 0.0 : sinceTick > 1.0 ? 1.0 : sinceTick);
 
-    // Draw
+    double drawStart = platformTimer();
     BeginDrawing();
     ClearBackground(WHITE);
 
+    // Follow the player between ticks, not in whole-cell steps
+    const Character *shown = &snapshot->player;
+    camera.target = interpolatedPosition(shown->x, shown->y, shown->previousX, shown->previousY);
+
     BeginMode2D(camera);
-    drawWorld();
-    drawProjectiles();
+    drawWorld(snapshot);
+    drawProjectiles(snapshot);
+    drawParticles(snapshot);
+    drawLighting(snapshot);
     EndMode2D();
 
-    drawUI();
+    drawUI(snapshot);
+    drawConsole();
+    renderStats.lastDrawMs = (platformTimer() - drawStart) * 1000.0;
 
     EndDrawing();
   }
 
   // Cleanup
+  stopSimulationThread();
+  stopReplay();
+  shutdownJobs();
+  unloadLighting();
+  unloadTerrainTiles();
+  unloadGrid();
   for (int i = 0; i < 9; i++)
   {
     UnloadTexture(textures[i]);
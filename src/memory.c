@@ -0,0 +1,146 @@
+#include "types.h"
+#include "globals.h"
+#include "memory.h"
+#include "world.h"
+#include "terrain.h"
+#include "projectiles.h"
+#include "savestate.h"
+#include "arena.h"
+#include "tunables.h"
+
+// Memory budget governor. Every MEMORY_CHECK_INTERVAL ticks it adds up the
+// heap memory of each subsystem. Over budget, it trims the least valuable
+// data first, one step at a time, until the total fits:
+//   1. halve the rewind ring (down to none)
+//   2. hand back projectile pool slack
+//   3. forget the edits of the unloaded chunks farthest away
+//   4. shrink the resident chunk window by one ring of chunks (down to
+//      CHUNK_MIN_LOAD_DISTANCE)
+// While the total stays under MEMORY_REGROW_PERCENT of the budget, the
+// window and then the rewind ring grow back one step per check, as long as
+// the step's cost still fits. Removing the budget undoes every trim at once.
+// The ring only ever grows back to the depth it had before the first trim
+// (batch worlds run with none).
+//
+// Trimming changes the game, so every decision has to come out the same
+// when a replay is played back: the frame arenas are reported but left out
+// of the budgeted total, because their capacity depends on which worker
+// thread happened to run which job.
+
+const char *memorySubsystemNames[MEMORY_SUBSYSTEM_COUNT] = {
+    "saves", "projectiles", "edits", "chunks", "arenas",
+};
+
+void setMemoryBudget(size_t bytes)
+{
+  world->budgetBytes = bytes;
+}
+
+size_t memoryBudget()
+{
+  return world->budgetBytes;
+}
+
+static void measureMemory()
+{
+  world->memoryStats.budget = world->budgetBytes;
+  world->memoryStats.used[MEMORY_SAVE_STATES] = stateMemoryUsed();
+  world->memoryStats.used[MEMORY_PROJECTILES] = projectileMemoryUsed();
+  world->memoryStats.used[MEMORY_CHUNK_EDITS] = chunkEditMemoryUsed();
+  world->memoryStats.used[MEMORY_CHUNKS] = chunkMemoryUsed();
+  world->memoryStats.used[MEMORY_FRAME_ARENAS] = world->frameArenaStats.capacity;
+  world->memoryStats.budgeted = 0;
+  for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++)
+  {
+    if (i != MEMORY_FRAME_ARENAS)
+      world->memoryStats.budgeted += world->memoryStats.used[i];
+  }
+  world->memoryStats.total = world->memoryStats.budgeted + world->memoryStats.used[MEMORY_FRAME_ARENAS];
+  world->memoryStats.chunkWindow = chunkWindow();
+  world->memoryStats.ringDepth = stateRingDepth();
+}
+
+// One trimming step, least valuable data first; 0 when nothing is left to trim
+static int trimStep(size_t excess)
+{
+  if (stateRingDepth() > 0)
+  {
+    if (world->ringFullDepth < 0)
+      world->ringFullDepth = stateRingDepth();
+    setStateRingDepth(stateRingDepth() / 2);
+    return 1;
+  }
+
+  size_t projectileBytes = projectileMemoryUsed();
+  trimProjectilePool();
+  if (projectileMemoryUsed() < projectileBytes)
+    return 1;
+
+  if (trimChunkEdits(excess) > 0)
+    return 1;
+
+  if (chunkWindow() > CHUNK_MIN_LOAD_DISTANCE)
+    return setChunkWindow(chunkWindow() - 1);
+  return 0;
+}
+
+// One step back towards full size, if it fits in room; 0 when there is none
+static int regrowStep(size_t room)
+{
+  if (chunkWindow() < world->tunables[TUNE_CHUNK_LOAD_DISTANCE].value)
+  {
+    long cost = chunkWindowCost(chunkWindow() + 1);
+    return cost <= (long)room && setChunkWindow(chunkWindow() + 1);
+  }
+
+  if (stateRingDepth() < world->ringFullDepth)
+  {
+    int depth = stateRingDepth() ? stateRingDepth() * 2 : 1;
+    if (depth > world->ringFullDepth)
+      depth = world->ringFullDepth;
+    size_t cost = (size_t)(depth - stateRingDepth()) * world->saveStateStats.lastSize;
+    if (cost > room)
+      return 0;
+    setStateRingDepth(depth);
+    return 1;
+  }
+  return 0;
+}
+
+void governMemory()
+{
+  if (world->gameTick % MEMORY_CHECK_INTERVAL != 0)
+    return;
+  measureMemory();
+
+  if (world->budgetBytes == 0)
+  {
+    // No budget: back to full size in one go
+    if (chunkWindow() != world->tunables[TUNE_CHUNK_LOAD_DISTANCE].value || world->ringFullDepth >= 0)
+    {
+      setChunkWindow(world->tunables[TUNE_CHUNK_LOAD_DISTANCE].value);
+      if (world->ringFullDepth >= 0)
+        setStateRingDepth(world->ringFullDepth);
+      world->ringFullDepth = -1;
+      measureMemory();
+    }
+    return;
+  }
+
+  if (world->memoryStats.budgeted > world->budgetBytes)
+  {
+    while (world->memoryStats.budgeted > world->budgetBytes && trimStep(world->memoryStats.budgeted - world->budgetBytes))
+    {
+      world->memoryStats.trims++;
+      measureMemory();
+    }
+    return;
+  }
+
+  size_t regrowLimit = world->budgetBytes / 100 * MEMORY_REGROW_PERCENT;
+  if (world->memoryStats.budgeted < regrowLimit && regrowStep(regrowLimit - world->memoryStats.budgeted))
+  {
+    world->memoryStats.regrows++;
+    measureMemory();
+  }
+}
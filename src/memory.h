@@ -0,0 +1,43 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "types.h"
+#include <stddef.h>
+
+#define MEMORY_CHECK_INTERVAL 30 // Ticks between budget checks
+#define MEMORY_REGROW_PERCENT 75 // Trimmed data comes back while use stays under this share of the budget
+
+// Heap memory the governor measures, least valuable first (the order it trims in)
+typedef enum
+{
+  MEMORY_SAVE_STATES,  // Rewind ring and the restart state
+  MEMORY_PROJECTILES,  // Projectile pool slack
+  MEMORY_CHUNK_EDITS,  // Edits of unloaded chunks (the cold chunk cache)
+  MEMORY_CHUNKS,       // The resident chunk window
+  MEMORY_FRAME_ARENAS, // Per-tick scratch (measured, never trimmed or held to the budget)
+  MEMORY_SUBSYSTEM_COUNT
+} MemorySubsystem;
+
+// Memory governor statistics (refreshed every MEMORY_CHECK_INTERVAL ticks)
+typedef struct
+{
+  size_t budget;                         // 0 = unlimited
+  size_t used[MEMORY_SUBSYSTEM_COUNT];   // Bytes per subsystem
+  size_t total;                          // Sum of used
+  size_t budgeted;                       // Sum of used without the frame arenas: what the budget is held to
+  int chunkWindow;                       // Resident chunk window (chunks from the player per axis)
+  int ringDepth;                         // Rewind saves kept
+  int trims;                             // Steps taken to get under budget so far
+  int regrows;                           // Steps taken back as room came free so far
+} MemoryStats;
+
+extern const char *memorySubsystemNames[MEMORY_SUBSYSTEM_COUNT];
+
+// Function declarations for the memory governor. The budget only covers the
+// heap memory above; fixed arrays (entity tables, snapshots) are not counted.
+// The budget changes the game (chunk window, kept edits), so replays store it.
+void setMemoryBudget(size_t bytes);
+size_t memoryBudget();
+void governMemory(); // End of every tick
+
+#endif
@@ -1,142 +1,553 @@
 #include "types.h"
 #include "globals.h"
+#include "world.h"
+#include "monsters.h"
+#include "archetypes.h"
+#include "jobs.h"
+#include "rng.h"
+#include "savestate.h"
+#include "arena.h"
+#include "visibility.h"
+#include "throttle.h"
+#include "tunables.h"
+#include "platform.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 // Function prototype for spawnProjectile (defined in projectiles.c)
-void spawnProjectile(int x, int y, float dx, float dy, int type, int damage);
+void spawnProjectile(int x, int y, float dx, float dy, int type, int damage, int owner);
 
-void updateMonsters()
+const ArchetypeInfo archetypes[ARCHETYPE_COUNT] = {
+#define X(id, name, textureIndex, texturePath, healthBase, healthRange, powerBase, powerRange, \
+          behavior, projectileType, moveCooldown, combatCooldown, moveStep)                   \
+  {name, textureIndex, texturePath, healthBase, healthRange, powerBase, powerRange,           \
+   behavior, projectileType, moveCooldown, combatCooldown, moveStep},
+    MONSTER_ARCHETYPES(X)
+#undef X
+};
+
+// monsters[] is kept sorted into contiguous batches keyed by (AI tier, archetype):
+// [near: dragon goblin ... | mid: dragon goblin ... | asleep: ...].
+// monsterBatchEnd[b] is one past the last monster of batch b, so the last entry
+// always equals monsterCount and sleeping monsters are never visited.
+//
+// Monsters handed to the AI each frame: aiSlots[k] is a monsters[] index and
+// slot k's scratch lives at index k of the structure-of-arrays in World, so
+// each kernel is a straight loop over plain int arrays. Segments are runs of
+// slots sharing one archetype and tick rate.
+
+#define AI_JOB_GRAIN 256       // Slots per parallelFor range
+#define TIER_JOB_GRAIN 4096    // Monsters per parallelFor range when re-tiering
+#define MIN_NEARBY_MONSTERS 6  // Keep at least 6 monsters nearby (consistent with spawn logic)
+#define MAX_CONFLICT_PASSES 16 // Bound on cascading move cancellations
+
+static int monsterTierAt(int x, int y)
+{
+  int dx = abs(x - world->player.x);
+  int dy = abs(y - world->player.y);
+  int distance = dx > dy ? dx : dy;
+
+  if (distance <= AI_NEAR_RADIUS)
+    return AI_TIER_NEAR;
+  if (distance <= AI_MID_RADIUS)
+    return AI_TIER_MID;
+  return AI_TIER_ASLEEP;
+}
+
+static int batchBegin(int batch)
+{
+  return batch > 0 ? world->monsterBatchEnd[batch - 1] : 0;
+}
+
+static int tierBegin(int tier)
+{
+  return batchBegin(tier * ARCHETYPE_COUNT);
+}
+
+static int tierEnd(int tier)
+{
+  return world->monsterBatchEnd[tier * ARCHETYPE_COUNT + ARCHETYPE_COUNT - 1];
+}
+
+Character *spawnMonster(int archetype, int worldX, int worldY)
+{
+  if (world->monsterCount >= world->tunables[TUNE_MAX_MONSTERS].value)
+    return NULL;
+
+  // Open a slot at the end of the monster's batch by rotating the first
+  // monster of every later batch to that batch's end
+  int batch = monsterTierAt(worldX, worldY) * ARCHETYPE_COUNT + archetype;
+  int hole = world->monsterCount;
+  for (int b = AI_BATCH_COUNT - 1; b > batch; b--)
+  {
+    int first = world->monsterBatchEnd[b - 1];
+    world->monsters[hole] = world->monsters[first];
+    hole = first;
+    world->monsterBatchEnd[b]++;
+  }
+  world->monsterBatchEnd[batch]++;
+  world->monsterCount++;
+
+  const ArchetypeInfo *info = &archetypes[archetype];
+  Character *monster = &world->monsters[hole];
+  memset(monster, 0, sizeof(*monster));
+  strcpy(monster->name, info->name);
+  monster->x = worldX;
+  monster->y = worldY;
+  monster->previousX = worldX;
+  monster->previousY = worldY;
+  monster->id = world->nextMonsterId++;
+  monster->archetype = archetype;
+  monster->textureIndex = info->textureIndex;
+  monster->health = info->healthBase + rngRange(rngSeed(RNG_MONSTERS), monster->id, 0, info->healthRange);
+  monster->maxHealth = monster->health;
+  monster->power = info->powerBase + rngRange(rngSeed(RNG_MONSTERS), monster->id, 1, info->powerRange);
+  monster->alive = 1;
+  monster->speed = 1;
+  monster->speedMultiplier = 1.0f;
+  monster->damageMultiplier = 1.0f;
+  monster->level = 1;
+  monster->experienceToNext = 100;
+  return monster;
+}
+
+int randomArchetype(RngStream *random)
+{
+  return rngNext(random, ARCHETYPE_COUNT);
+}
+
+void removeMonster(int index)
+{
+  int batch = 0;
+  while (index >= world->monsterBatchEnd[batch])
+    batch++;
+
+  // Fill the gap from the end of the same batch, then close up later batches
+  int hole = world->monsterBatchEnd[batch] - 1;
+  world->monsters[index] = world->monsters[hole];
+  world->monsterBatchEnd[batch]--;
+  for (int b = batch + 1; b < AI_BATCH_COUNT; b++)
+  {
+    int last = world->monsterBatchEnd[b] - 1;
+    world->monsters[hole] = world->monsters[last];
+    hole = last;
+    world->monsterBatchEnd[b]--;
+  }
+  world->monsterCount--;
+}
+
+// monsters[0, n) are the near and mid tiers. The rest were more than
+// AI_MID_RADIUS cells out when last tiered and have not moved since, and
+// leaving its chunk re-tiers, so the player is still more than
+// AI_MID_RADIUS - CHUNK_SIZE cells from any of them.
+int awakeMonsterCount()
+{
+  return tierEnd(AI_TIER_MID);
+}
+
+void resetMonsters()
+{
+  world->monsterCount = 0;
+  for (int b = 0; b < AI_BATCH_COUNT; b++)
+    world->monsterBatchEnd[b] = 0;
+  world->framesSinceRetier = world->tunables[TUNE_AI_RETIER_INTERVAL].value;
+  world->nextMonsterId = 0;
+  world->aiFrame = 0;
+  world->aiSeed = rngSeed(RNG_AI);
+}
+
+static void countNearbyRange(int begin, int end, void *context)
+{
+  (void)context;
+  int despawn = world->tunables[TUNE_MONSTER_DESPAWN_DISTANCE].value;
+  int nearby = 0;
+  for (int i = begin; i < end; i++)
+  {
+    int dx = world->monsters[i].x - world->player.x;
+    int dy = world->monsters[i].y - world->player.y;
+    if (world->monsters[i].alive && dx * dx + dy * dy <= despawn * despawn)
+      nearby++;
+  }
+  __atomic_add_fetch(&world->nearbyMonsterCount, nearby, __ATOMIC_RELAXED);
+}
+
+static void classifyRange(int begin, int end, void *context)
+{
+  (void)context;
+  int despawn = world->tunables[TUNE_MONSTER_DESPAWN_DISTANCE].value;
+  for (int i = begin; i < end; i++)
+  {
+    int dx = world->monsters[i].x - world->player.x;
+    int dy = world->monsters[i].y - world->player.y;
+
+    if (world->despawnFar && dx * dx + dy * dy > despawn * despawn)
+      world->batchOf[i] = AI_BATCH_COUNT;
+    else
+      world->batchOf[i] = monsterTierAt(world->monsters[i].x, world->monsters[i].y) * ARCHETYPE_COUNT + world->monsters[i].archetype;
+  }
+}
+
+// Reassigns every monster to its batch (a stable counting sort) and drops
+// the ones that wandered too far from the player. Classifying is parallel;
+// the sort itself is a single pass.
+void updateMonsterTiers()
+{
+  int batchStart[AI_BATCH_COUNT + 1] = {0};
+  Character *sorted = frameAlloc(sizeof(Character) * (size_t)world->monsterCount);
+  if (sorted == NULL)
+    return; // Out of memory: keep the old tiers until next tick
+
+  world->nearbyMonsterCount = 0;
+  parallelFor(world->monsterCount, TIER_JOB_GRAIN, countNearbyRange, NULL);
+
+  // Despawn distant monsters if we have enough nearby ones
+  world->despawnFar = world->nearbyMonsterCount >= MIN_NEARBY_MONSTERS;
+  parallelFor(world->monsterCount, TIER_JOB_GRAIN, classifyRange, NULL);
+  for (int i = 0; i < world->monsterCount; i++)
+    batchStart[world->batchOf[i]]++;
+
+  int kept = 0;
+  for (int b = 0; b < AI_BATCH_COUNT; b++)
+  {
+    int count = batchStart[b];
+    batchStart[b] = kept;
+    kept += count;
+    world->monsterBatchEnd[b] = kept;
+  }
+
+  for (int i = 0; i < world->monsterCount; i++)
+  {
+    if (world->batchOf[i] < AI_BATCH_COUNT)
+      sorted[batchStart[world->batchOf[i]]++] = world->monsters[i];
+  }
+  memcpy(world->monsters, sorted, kept * sizeof(Character));
+  world->monsterCount = kept;
+
+  WorldPosition playerPos = worldToChunk(world->player.x, world->player.y);
+  world->tierChunkX = playerPos.chunkX;
+  world->tierChunkY = playerPos.chunkY;
+  world->framesSinceRetier = 0;
+  world->aiStats.retiers++;
+}
+
+// A monster acts when its cooldown has run out; otherwise the cooldown
+// counts down by the number of frames this update stands for
+static int cooldownReady(int k)
+{
+  return world->batchAlive[k] & (world->batchCooldown[k] == 0);
+}
+
+static int nextCooldown(int k, int ready, int ticks, const ArchetypeInfo *info)
+{
+  int waiting = world->batchCooldown[k] > ticks ? world->batchCooldown[k] - ticks : 0;
+  int fresh = world->batchCombat[k] ? info->combatCooldown : info->moveCooldown;
+  return ready ? fresh : waiting;
+}
+
+// Troll - move fast towards player
+static void chaseKernel(int begin, int end, int ticks, const ArchetypeInfo *info)
+{
+  for (int k = begin; k < end; k++)
+  {
+    int ready = cooldownReady(k);
+    float dx = (float)(world->player.x - world->batchX[k]);
+    float dy = (float)(world->player.y - world->batchY[k]);
+    float dist = sqrtf(dx * dx + dy * dy);
+    float scale = dist > 0.0f ? info->moveStep / dist : 0.0f;
+
+    world->batchX[k] += ready * (int)(dx * scale);
+    world->batchY[k] += ready * (int)(dy * scale);
+    world->batchFire[k] = 0;
+    world->batchCooldown[k] = nextCooldown(k, ready, ticks, info);
+  }
+}
+
+// Wizard / Dragon - shoot at the player and run away
+static void rangedKernel(int begin, int end, int ticks, int allowProjectiles, const ArchetypeInfo *info)
+{
+  for (int k = begin; k < end; k++)
+  {
+    int ready = cooldownReady(k);
+    float dx = (float)(world->batchX[k] - world->player.x); // Reverse direction - away from player
+    float dy = (float)(world->batchY[k] - world->player.y);
+    float dist = sqrtf(dx * dx + dy * dy);
+    float scale = dist > 0.0f ? info->moveStep / dist : 0.0f;
+
+    // 30% chance per move (never from the coarse-tick ring)
+    world->batchFire[k] = ready & allowProjectiles & (world->batchRoll[k] % 100 < 30) & (dist > 0.0f);
+    world->batchX[k] += ready * (int)(dx * scale);
+    world->batchY[k] += ready * (int)(dy * scale);
+    world->batchCooldown[k] = nextCooldown(k, ready, ticks, info);
+  }
+}
+
+// Other monsters - random movement
+static void wanderKernel(int begin, int end, int ticks, const ArchetypeInfo *info)
 {
-  for (int i = 0; i < monsterCount; i++)
+  static const int stepX[4] = {0, 0, -1, 1}; // UP, DOWN, LEFT, RIGHT
+  static const int stepY[4] = {-1, 1, 0, 0};
+
+  for (int k = begin; k < end; k++)
   {
-    if (!monsters[i].alive)
+    int ready = cooldownReady(k);
+    int dir = world->batchRoll[k] & 3;
+
+    world->batchX[k] += ready * stepX[dir] * info->moveStep;
+    world->batchY[k] += ready * stepY[dir] * info->moveStep;
+    world->batchFire[k] = 0;
+    world->batchCooldown[k] = nextCooldown(k, ready, ticks, info);
+  }
+}
+
+// Queues one batch's monsters (every stride-th from begin) as a new segment
+static void scheduleBatch(int archetype, int begin, int end, int stride, int ticks, int allowProjectiles)
+{
+  AiSegment *segment = &world->aiSegments[world->aiSegmentCount++];
+  segment->archetype = archetype;
+  segment->ticks = ticks;
+  segment->allowProjectiles = allowProjectiles;
+  segment->begin = world->aiSlotCount;
+  for (int i = begin; i < end; i += stride)
+    world->aiSlots[world->aiSlotCount++] = i;
+  segment->end = world->aiSlotCount;
+}
+
+// Phase 1 (parallel): gather, roll and propose a move for slots [begin, end).
+// Only reads shared state and writes slot-private scratch, so any split of
+// the slots across threads produces the same proposals.
+static void proposeMoves(int begin, int end, void *context)
+{
+  int offset = *(const int *)context; // First slot of the tier being run
+  begin += offset;
+  end += offset;
+
+  for (int s = 0; s < world->aiSegmentCount; s++)
+  {
+    const AiSegment *segment = &world->aiSegments[s];
+    int from = segment->begin > begin ? segment->begin : begin;
+    int to = segment->end < end ? segment->end : end;
+    if (from >= to)
       continue;
 
-    // Update movement cooldown
-    if (monsters[i].movementCooldown > 0)
+    for (int k = from; k < to; k++)
     {
-      monsters[i].movementCooldown--;
-      continue; // Don't move while on cooldown
+      const Character *monster = &world->monsters[world->aiSlots[k]];
+      world->batchX[k] = monster->x;
+      world->batchY[k] = monster->y;
+      world->batchCooldown[k] = monster->movementCooldown;
+      world->batchCombat[k] = monster->isInCombat;
+      world->batchAlive[k] = monster->alive != 0;
+      world->batchRoll[k] = (int)(rngAt(world->aiSeed, monster->id, (uint32_t)world->aiFrame) >> 1);
     }
 
-    // Special behaviors based on monster type
-    int newX = monsters[i].x;
-    int newY = monsters[i].y;
-
-    if (monsters[i].textureIndex == 4) // Troll (1f47f.png) - move fast towards player
+    const ArchetypeInfo *info = &archetypes[segment->archetype];
+    switch (info->behavior)
     {
-      // Calculate direction towards player
-      float dx = player.x - monsters[i].x;
-      float dy = player.y - monsters[i].y;
-      float dist = sqrt(dx * dx + dy * dy);
-      if (dist > 0)
-      {
-        // Move 2 cells towards player (faster)
-        newX += (int)(dx / dist * 2);
-        newY += (int)(dy / dist * 2);
-      }
-      monsters[i].movementCooldown = monsters[i].isInCombat ? 12 : 6; // Faster movement
+    case BEHAVIOR_CHASE:
+      chaseKernel(from, to, segment->ticks, info);
+      break;
+    case BEHAVIOR_RANGED:
+      rangedKernel(from, to, segment->ticks, segment->allowProjectiles, info);
+      break;
+    default:
+      wanderKernel(from, to, segment->ticks, info);
+      break;
     }
-    else if (monsters[i].textureIndex == 5 || monsters[i].textureIndex == 1) // Wizard (1f9d9.png) or Dragon (1f409.png) - ranged attacks
-    {
-      // Occasionally shoot projectiles
-      if (rand() % 100 < 30) // 30% chance per frame (increased for better visibility)
-      {
-        // Calculate precise direction towards player
-        float dx = player.x - monsters[i].x;
-        float dy = player.y - monsters[i].y;
-        float dist = sqrt(dx * dx + dy * dy);
-
-        if (dist > 0)
-        {
-          // Normalize direction and multiply by projectile speed for consistent movement
-          float normalizedDx = dx / dist;
-          float normalizedDy = dy / dist;
-
-          int type = (monsters[i].textureIndex == 5) ? 0 : 1; // 0=lightning for wizard, 1=fireball for dragon
-          spawnProjectile(monsters[i].x, monsters[i].y, normalizedDx, normalizedDy, type, monsters[i].power);
-        }
-      }
+  }
+}
 
-      // Run away from player instead of random movement
-      float dx = monsters[i].x - player.x; // Reverse direction - away from player
-      float dy = monsters[i].y - player.y;
-      float dist = sqrt(dx * dx + dy * dy);
-      if (dist > 0)
-      {
-        // Move away from player
-        newX += (int)(dx / dist * 1);
-        newY += (int)(dy / dist * 1);
-      }
+static unsigned int cellHash(int x, int y)
+{
+  unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u;
+  return (h ^ (h >> 15)) & (MOVE_CLAIM_TABLE_SIZE - 1);
+}
+
+// Records a claim on a cell and returns the lowest priority claimed there so far
+static unsigned int claimCell(int x, int y, unsigned int priority)
+{
+  unsigned int slot = cellHash(x, y);
+  while (world->moveClaims[slot].stamp == world->moveClaimStamp &&
+         (world->moveClaims[slot].x != x || world->moveClaims[slot].y != y))
+    slot = (slot + 1) & (MOVE_CLAIM_TABLE_SIZE - 1);
+
+  MoveClaim *claim = &world->moveClaims[slot];
+  if (claim->stamp != world->moveClaimStamp)
+  {
+    claim->stamp = world->moveClaimStamp;
+    claim->x = x;
+    claim->y = y;
+    claim->best = priority;
+  }
+  else if (priority < claim->best)
+  {
+    claim->best = priority;
+  }
+  return claim->best;
+}
+
+static unsigned int bestClaim(int x, int y)
+{
+  unsigned int slot = cellHash(x, y);
+  while (world->moveClaims[slot].x != x || world->moveClaims[slot].y != y)
+    slot = (slot + 1) & (MOVE_CLAIM_TABLE_SIZE - 1);
+  return world->moveClaims[slot].best;
+}
+
+// Phase 2 (serial): when several monsters want one cell, the monster already
+// standing there keeps it, otherwise the lowest id wins; losers stay put.
+// Priorities only depend on ids and positions, never on slot order, so the
+// outcome is the same however phase 1 was split. A monster that stays put
+// can bump a monster that planned to enter its cell, so repeat until stable.
+static int resolveMoveConflicts(int activeEnd)
+{
+  int cancelled = 0;
 
-      monsters[i].movementCooldown = monsters[i].isInCombat ? 18 : 9; // Slightly faster when running away
+  for (int i = 0; i < activeEnd; i++)
+    world->slotOfMonster[i] = -1;
+  for (int k = 0; k < world->aiSlotCount; k++)
+    world->slotOfMonster[world->aiSlots[k]] = k;
+
+  for (int pass = 0; pass < MAX_CONFLICT_PASSES; pass++)
+  {
+    world->moveClaimStamp++;
+    for (int i = 0; i < activeEnd; i++)
+    {
+      if (!world->monsters[i].alive)
+        continue;
+      int k = world->slotOfMonster[i];
+      int moving = k >= 0 && (world->batchX[k] != world->monsters[i].x || world->batchY[k] != world->monsters[i].y);
+      unsigned int priority = (moving ? 0x80000000u : 0u) | world->monsters[i].id;
+      if (moving)
+        claimCell(world->batchX[k], world->batchY[k], priority);
+      else
+        claimCell(world->monsters[i].x, world->monsters[i].y, priority);
     }
-    else // Other monsters - random movement
+
+    int changed = 0;
+    for (int k = 0; k < world->aiSlotCount; k++)
     {
-      // Random movement
-      Direction dir = rand() % 4;
-      switch (dir)
+      const Character *monster = &world->monsters[world->aiSlots[k]];
+      if (world->batchX[k] == monster->x && world->batchY[k] == monster->y)
+        continue;
+      if (bestClaim(world->batchX[k], world->batchY[k]) != (0x80000000u | monster->id))
       {
-      case UP:
-        newY--;
-        break;
-      case DOWN:
-        newY++;
-        break;
-      case LEFT:
-        newX--;
-        break;
-      case RIGHT:
-        newX++;
-        break;
+        world->batchX[k] = monster->x;
+        world->batchY[k] = monster->y;
+        changed++;
       }
-      monsters[i].movementCooldown = monsters[i].isInCombat ? 24 : 12; // 50% slower when fighting
     }
-
-    // No bounds checking - unlimited world!
-    monsters[i].x = newX;
-    monsters[i].y = newY;
+    cancelled += changed;
+    if (changed == 0)
+      break;
   }
+  return cancelled;
+}
 
-  // Despawn monsters that are too far from player
-  const int DESPAWN_DISTANCE = 300;  // Very large despawn distance for maximum stability
-  const int MIN_NEARBY_MONSTERS = 6; // Keep at least 6 monsters nearby (consistent with spawn logic)
-
-  int nearbyMonsterCount = 0;
-  for (int i = 0; i < monsterCount; i++)
+// Phase 3 (serial): projectiles and write-back, in slot order. Shooters
+// only fire if they can see the player, checked as one batch.
+static void applyMoves()
+{
+  int shooterCount = 0;
+  for (int k = 0; k < world->aiSlotCount; k++)
   {
-    if (!monsters[i].alive)
-      continue;
-
-    float dx = monsters[i].x - player.x;
-    float dy = monsters[i].y - player.y;
-    float distance = sqrt(dx * dx + dy * dy);
-
-    if (distance <= DESPAWN_DISTANCE)
+    if (world->batchFire[k])
     {
-      nearbyMonsterCount++;
+      world->shooterX[shooterCount] = world->monsters[world->aiSlots[k]].x;
+      world->shooterY[shooterCount] = world->monsters[world->aiSlots[k]].y;
+      shooterCount++;
     }
   }
+  if (shooterCount > 0)
+    batchLineOfSight(world->shooterX, world->shooterY, shooterCount, world->player.x, world->player.y, world->shooterVisible);
 
-  // Despawn distant monsters if we have enough nearby ones
-  if (nearbyMonsterCount >= MIN_NEARBY_MONSTERS)
+  int shooter = 0;
+  for (int s = 0; s < world->aiSegmentCount; s++)
   {
-    for (int i = monsterCount - 1; i >= 0; i--)
+    const ArchetypeInfo *info = &archetypes[world->aiSegments[s].archetype];
+    for (int k = world->aiSegments[s].begin; k < world->aiSegments[s].end; k++)
     {
-      if (!monsters[i].alive)
-        continue;
-
-      float dx = monsters[i].x - player.x;
-      float dy = monsters[i].y - player.y;
-      float distance = sqrt(dx * dx + dy * dy);
-
-      if (distance > DESPAWN_DISTANCE)
+      Character *monster = &world->monsters[world->aiSlots[k]];
+      if (world->batchFire[k] && world->shooterVisible[shooter++])
       {
-        // Remove this monster by moving the last monster to this position
-        monsters[i] = monsters[monsterCount - 1];
-        monsterCount--;
+        // Shoot from where the monster stood, straight at the player
+        float dx = world->player.x - monster->x;
+        float dy = world->player.y - monster->y;
+        float dist = sqrtf(dx * dx + dy * dy);
+        spawnProjectile(monster->x, monster->y, dx / dist, dy / dist, info->projectileType, monster->power,
+                        (int)monster->id);
       }
+
+      // No bounds checking - unlimited world!
+      monster->x = world->batchX[k];
+      monster->y = world->batchY[k];
+      monster->movementCooldown = world->batchCooldown[k];
     }
   }
 }
+
+void updateMonsters()
+{
+  // Proximity trigger: re-tier whenever the player enters a new chunk, and
+  // periodically so spawns and wandering monsters settle into the right tier
+  WorldPosition playerPos = worldToChunk(world->player.x, world->player.y);
+  if (playerPos.chunkX != world->tierChunkX || playerPos.chunkY != world->tierChunkY ||
+      ++world->framesSinceRetier >= world->tunables[TUNE_AI_RETIER_INTERVAL].value)
+  {
+    updateMonsterTiers();
+  }
+  world->aiFrame++;
+
+  world->aiSegmentCount = 0;
+  world->aiSlotCount = 0;
+  for (int a = 0; a < ARCHETYPE_COUNT; a++)
+  {
+    int batch = AI_TIER_NEAR * ARCHETYPE_COUNT + a;
+    scheduleBatch(a, batchBegin(batch), world->monsterBatchEnd[batch], 1, 1, 1);
+  }
+  int nearSlots = world->aiSlotCount;
+
+  // Mid ring: a staggered quarter of each batch per frame, each standing in
+  // for several frames (half as many while the frame governor sheds distant AI)
+  int interval = world->tunables[TUNE_AI_MID_TICK_INTERVAL].value;
+  if (throttled(THROTTLE_DISTANT_AI))
+    interval *= THROTTLE_MID_TICK_FACTOR;
+  for (int a = 0; a < ARCHETYPE_COUNT; a++)
+  {
+    int batch = AI_TIER_MID * ARCHETYPE_COUNT + a;
+    int begin = batchBegin(batch);
+    int phase = ((world->aiFrame - begin) % interval + interval) % interval;
+    scheduleBatch(a, begin + phase, world->monsterBatchEnd[batch], interval, interval, 0);
+  }
+
+  int nearOffset = 0;
+  double nearStart = platformTimer();
+  parallelFor(nearSlots, AI_JOB_GRAIN, proposeMoves, &nearOffset);
+  double midStart = platformTimer();
+  parallelFor(world->aiSlotCount - nearSlots, AI_JOB_GRAIN, proposeMoves, &nearSlots);
+  double resolveStart = platformTimer();
+  world->aiStats.movesCancelled = resolveMoveConflicts(tierEnd(AI_TIER_MID));
+  applyMoves();
+  double resolveEnd = platformTimer();
+
+  for (int t = 0; t < AI_TIER_COUNT; t++)
+    world->aiStats.tierCount[t] = tierEnd(t) - tierBegin(t);
+  world->aiStats.tierMs[AI_TIER_NEAR] = (midStart - nearStart) * 1000.0;
+  world->aiStats.tierMs[AI_TIER_MID] = (resolveStart - midStart) * 1000.0;
+  world->aiStats.tierMs[AI_TIER_ASLEEP] = 0.0;
+  world->aiStats.resolveMs = (resolveEnd - resolveStart) * 1000.0;
+  world->aiStats.threads = jobThreadCount();
+}
+
+void streamMonsterState(StateStream *stream)
+{
+  stateBlock(stream, world->monsterBatchEnd, sizeof(world->monsterBatchEnd));
+  stateBlock(stream, &world->nearbyMonsterCount, sizeof(world->nearbyMonsterCount));
+  stateBlock(stream, &world->despawnFar, sizeof(world->despawnFar));
+  stateBlock(stream, &world->tierChunkX, sizeof(world->tierChunkX));
+  stateBlock(stream, &world->tierChunkY, sizeof(world->tierChunkY));
+  stateBlock(stream, &world->framesSinceRetier, sizeof(world->framesSinceRetier));
+  stateBlock(stream, &world->aiFrame, sizeof(world->aiFrame));
+  stateBlock(stream, &world->aiSeed, sizeof(world->aiSeed));
+  stateBlock(stream, &world->nextMonsterId, sizeof(world->nextMonsterId));
+}
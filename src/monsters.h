@@ -2,8 +2,47 @@
 #define MONSTERS_H
 
 #include "types.h"
+#include "archetypes.h"
+#include "rng.h"
+
+#define AI_BATCH_COUNT (AI_TIER_COUNT * ARCHETYPE_COUNT) // monsters[] batches, one per (AI tier, archetype)
+#define MOVE_CLAIM_TABLE_SIZE (MAX_MONSTERS * 2)        // Open-addressed, so kept at most half full
+
+// Monster AI level-of-detail statistics (refreshed every frame)
+typedef struct
+{
+  int tierCount[AI_TIER_COUNT]; // Monsters currently in each tier
+  double tierMs[AI_TIER_COUNT]; // AI time spent on each tier last frame
+  int retiers;                  // Tier reassignments so far
+  double resolveMs;             // Move-conflict resolution and write-back last frame
+  int movesCancelled;           // Moves dropped by conflict resolution last frame
+  int threads;                  // Threads sharing the AI work
+} AiStats;
+
+// A run of AI slots sharing one archetype and tick rate
+typedef struct
+{
+  int archetype;
+  int begin, end; // Slot range
+  int ticks;
+  int allowProjectiles;
+} AiSegment;
+
+// Move resolution: the claims on one target cell this frame
+typedef struct
+{
+  int x, y;
+  unsigned int stamp;
+  unsigned int best; // Lowest claim priority on this cell
+} MoveClaim;
 
 // Function declarations for monster management
 void updateMonsters();
+void updateMonsterTiers();
+Character *spawnMonster(int archetype, int worldX, int worldY);
+int randomArchetype(RngStream *random);
+void removeMonster(int index);
+void resetMonsters();
+int awakeMonsterCount();
 
 #endif
@@ -0,0 +1,121 @@
+#include "types.h"
+#include "globals.h"
+#include "world.h"
+#include "monsters.h"
+#include "observation.h"
+#include <string.h>
+#include <math.h>
+
+// Observations are read straight out of simulation storage: terrain a chunk
+// column at a time (one chunk lookup per chunk the window overlaps, at most
+// 3x3), monsters from the awake AI tiers only, and the short projectile,
+// powerup and landmine lists in full. Nothing is allocated; the caller's
+// buffer is written in place.
+
+#define OBSERVATION_RADIUS (OBSERVATION_SIZE / 2)
+#define OBSERVATION_ARROW 4 // Projectile channel value for the player's arrows
+
+// Sleeping monsters are skipped, which is only safe while none can be in view
+#if OBSERVATION_RADIUS > AI_MID_RADIUS - CHUNK_SIZE
+#error "Observation window reaches past the awake monster tiers"
+#endif
+
+static unsigned char healthByte(const Character *character)
+{
+  if (character->health <= 0 || character->maxHealth <= 0)
+    return 0;
+  if (character->health >= character->maxHealth)
+    return 255;
+  return (unsigned char)(1 + character->health * 254 / character->maxHealth);
+}
+
+// Byte offset of a world cell in the observation, or -1 outside the window
+static int observationCell(int worldX, int worldY, int originX, int originY)
+{
+  int x = worldX - originX;
+  int y = worldY - originY;
+  if (x < 0 || y < 0 || x >= OBSERVATION_SIZE || y >= OBSERVATION_SIZE)
+    return -1;
+  return (y * OBSERVATION_SIZE + x) * OBSERVATION_CHANNELS;
+}
+
+// Terrain is stored column-major (terrain[x][y]), so each chunk the window
+// overlaps is copied column by column
+static void encodeTerrain(unsigned char *out, int originX, int originY)
+{
+  for (int x = 0; x < OBSERVATION_SIZE;)
+  {
+    WorldPosition column = worldToChunk(originX + x, originY);
+    int columns = CHUNK_SIZE - column.localX;
+    if (columns > OBSERVATION_SIZE - x)
+      columns = OBSERVATION_SIZE - x;
+
+    for (int y = 0; y < OBSERVATION_SIZE;)
+    {
+      WorldPosition pos = worldToChunk(originX + x, originY + y);
+      int rows = CHUNK_SIZE - pos.localY;
+      if (rows > OBSERVATION_SIZE - y)
+        rows = OBSERVATION_SIZE - y;
+
+      int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+      if (chunkIndex != -1)
+      {
+        const Chunk *chunk = &world->loadedChunks[chunkIndex];
+        for (int cx = 0; cx < columns; cx++)
+        {
+          const int *source = &chunk->terrain[pos.localX + cx][pos.localY];
+          unsigned char *target = out + (y * OBSERVATION_SIZE + x + cx) * OBSERVATION_CHANNELS + OBSERVATION_TERRAIN;
+          for (int cy = 0; cy < rows; cy++)
+            target[cy * OBSERVATION_SIZE * OBSERVATION_CHANNELS] = (unsigned char)(source[cy] + 1);
+        }
+      }
+      y += rows;
+    }
+    x += columns;
+  }
+}
+
+void encodeObservation(unsigned char *out)
+{
+  int originX = world->player.x - OBSERVATION_RADIUS;
+  int originY = world->player.y - OBSERVATION_RADIUS;
+  memset(out, 0, OBSERVATION_BYTES);
+  encodeTerrain(out, originX, originY);
+
+  for (int i = 0; i < world->powerupCount; i++)
+  {
+    int cell = observationCell(world->powerups[i].x, world->powerups[i].y, originX, originY);
+    if (world->powerups[i].active && cell >= 0)
+      out[cell + OBSERVATION_PICKUP] = (unsigned char)(world->powerups[i].type + 1);
+  }
+  for (int i = 0; i < world->landmineCount; i++)
+  {
+    int cell = observationCell(world->landmines[i].x, world->landmines[i].y, originX, originY);
+    if (world->landmines[i].active && cell >= 0)
+      out[cell + OBSERVATION_PICKUP] = POWERUP_COUNT + 1;
+  }
+
+  for (int i = 0; i < world->projectiles.count; i++)
+  {
+    int cell = observationCell((int)floorf(world->projectiles.x[i]), (int)floorf(world->projectiles.y[i]), originX, originY);
+    if (!world->projectiles.alive[i] || cell < 0)
+      continue;
+    out[cell + OBSERVATION_PROJECTILE] = world->projectiles.owner[i] == PROJECTILE_OWNER_PLAYER
+                                             ? OBSERVATION_ARROW
+                                             : (unsigned char)(world->projectiles.type[i] + 1);
+  }
+
+  int awake = awakeMonsterCount();
+  for (int i = 0; i < awake; i++)
+  {
+    int cell = observationCell(world->monsters[i].x, world->monsters[i].y, originX, originY);
+    if (!world->monsters[i].alive || cell < 0)
+      continue;
+    out[cell + OBSERVATION_MONSTER] = (unsigned char)(world->monsters[i].archetype + 1);
+    out[cell + OBSERVATION_HEALTH] = healthByte(&world->monsters[i]);
+  }
+
+  // The player is always in the middle
+  int centre = observationCell(world->player.x, world->player.y, originX, originY);
+  out[centre + OBSERVATION_HEALTH] = world->player.alive ? healthByte(&world->player) : 0;
+}
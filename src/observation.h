@@ -0,0 +1,27 @@
+#ifndef OBSERVATION_H
+#define OBSERVATION_H
+
+#include "types.h"
+
+// Egocentric observation: an OBSERVATION_SIZE x OBSERVATION_SIZE grid of
+// cells centred on the player (who is at cell OBSERVATION_SIZE / 2 on both
+// axes), one byte per channel, channels innermost: byte (y * OBSERVATION_SIZE
+// + x) * OBSERVATION_CHANNELS + channel. 0 means "nothing" in every channel.
+#define OBSERVATION_SIZE 64
+#define OBSERVATION_BYTES (OBSERVATION_SIZE * OBSERVATION_SIZE * OBSERVATION_CHANNELS)
+
+typedef enum
+{
+  OBSERVATION_TERRAIN,    // TerrainType + 1 (0 = chunk not loaded)
+  OBSERVATION_MONSTER,    // Archetype + 1 of a live monster
+  OBSERVATION_PROJECTILE, // Projectile type + 1 for monster shots, 4 for the player's arrows
+  OBSERVATION_PICKUP,     // PowerupType + 1, or POWERUP_COUNT + 1 for a landmine
+  OBSERVATION_HEALTH,     // Health of the player or monster there, 255 = full
+  OBSERVATION_CHANNELS
+} ObservationChannel;
+
+// Function declarations for observations. encodeObservation fills
+// OBSERVATION_BYTES at out for the calling thread's world.
+void encodeObservation(unsigned char *out);
+
+#endif
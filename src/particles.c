@@ -0,0 +1,145 @@
+#include "types.h"
+#include "globals.h"
+#include "particles.h"
+#include "rng.h"
+#include "savestate.h"
+#include "throttle.h"
+#include "platform.h"
+#include <stdlib.h>
+#include <math.h>
+
+// Fixed-capacity structure-of-arrays particle pool. Live particles are packed
+// into [0, particles.count): the update is one straight loop over float arrays,
+// followed by an order-preserving compaction, and the whole pool is drawn as
+// quads (see drawParticles). Positions and velocities are in world pixels
+// (per tick).
+
+#define PARTICLE_DRAG 0.92f // Velocity kept per frame
+
+void emitParticleBurst(float worldX, float worldY, int count, float speed, float life, float size, Color color)
+{
+  // Thin out new bursts while the system is over its frame budget
+  if (particleFrameMs() > PARTICLE_BUDGET_MS)
+  {
+    world->particleStats.dropped += count - count / 4;
+    count /= 4;
+  }
+  if (throttled(THROTTLE_PARTICLES))
+  {
+    int kept = count * THROTTLE_PARTICLE_PERCENT / 100;
+    world->particleStats.dropped += count - kept;
+    count = kept;
+  }
+
+  // Each burst gets its own stream, so thinning one never changes another
+  RngStream random = rngStream(rngSeed(RNG_PARTICLES), world->burstCount++);
+  for (int n = 0; n < count; n++)
+  {
+    if (world->particles.count >= MAX_PARTICLES)
+    {
+      world->particleStats.dropped += count - n;
+      return;
+    }
+
+    float angle = rngNext(&random, 3600) * (2.0f * PI / 3600.0f);
+    float velocity = speed * (0.3f + rngNext(&random, 700) / 1000.0f);
+    float lifetime = life * (0.6f + rngNext(&random, 400) / 1000.0f);
+    int i = world->particles.count++;
+
+    world->particles.x[i] = worldX;
+    world->particles.y[i] = worldY;
+    world->particles.vx[i] = cosf(angle) * velocity;
+    world->particles.vy[i] = sinf(angle) * velocity;
+    world->particles.life[i] = lifetime;
+    world->particles.invLife[i] = 1.0f / lifetime;
+    world->particles.size[i] = size;
+    world->particles.color[i] = color;
+  }
+}
+
+// Small spray where a projectile or blow lands
+void emitHitEffect(int cellX, int cellY, Color color)
+{
+  emitParticleBurst((cellX + 0.5f) * CELL_SIZE, (cellY + 0.5f) * CELL_SIZE, 12, 2.5f, 18, 3, color);
+}
+
+// Landmine blast: hot core plus a wide ring of smoke
+void emitExplosion(int cellX, int cellY)
+{
+  float x = (cellX + 0.5f) * CELL_SIZE;
+  float y = (cellY + 0.5f) * CELL_SIZE;
+  emitParticleBurst(x, y, 60, 6.0f, 30, 4, ORANGE);
+  emitParticleBurst(x, y, 30, 3.0f, 45, 5, YELLOW);
+  emitParticleBurst(x, y, 40, 4.0f, 60, 6, (Color){80, 80, 80, 204});
+}
+
+void emitDeathEffect(int cellX, int cellY)
+{
+  emitParticleBurst((cellX + 0.5f) * CELL_SIZE, (cellY + 0.5f) * CELL_SIZE, 40, 3.5f, 40, 4, MAROON);
+}
+
+void updateParticles()
+{
+  double updateStart = platformTimer();
+  int count = world->particles.count;
+
+  // Integrate (no branches, so the compiler can vectorize it)
+  for (int i = 0; i < count; i++)
+  {
+    world->particles.x[i] += world->particles.vx[i];
+    world->particles.y[i] += world->particles.vy[i];
+    world->particles.vx[i] *= PARTICLE_DRAG;
+    world->particles.vy[i] *= PARTICLE_DRAG;
+    world->particles.life[i] -= 1.0f;
+  }
+
+  // Pack the survivors down, keeping their order
+  int live = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (world->particles.life[i] > 0.0f)
+    {
+      world->particles.x[live] = world->particles.x[i];
+      world->particles.y[live] = world->particles.y[i];
+      world->particles.vx[live] = world->particles.vx[i];
+      world->particles.vy[live] = world->particles.vy[i];
+      world->particles.life[live] = world->particles.life[i];
+      world->particles.invLife[live] = world->particles.invLife[i];
+      world->particles.size[live] = world->particles.size[i];
+      world->particles.color[live] = world->particles.color[i];
+      live++;
+    }
+  }
+  world->particles.count = live;
+
+  world->particleStats.liveCount = live;
+  world->particleStats.lastUpdateMs = (platformTimer() - updateStart) * 1000.0;
+}
+
+void clearParticles()
+{
+  world->particles.count = 0;
+  world->particleStats.liveCount = 0;
+  world->burstCount = 0;
+}
+
+// Update cost of the last tick, for budgeting
+double particleFrameMs()
+{
+  return world->particleStats.lastUpdateMs;
+}
+
+void streamParticleState(StateStream *stream)
+{
+  stateBlock(stream, &world->particles.count, sizeof(world->particles.count));
+  int count = world->particles.count;
+  stateBlock(stream, world->particles.x, sizeof(float) * count);
+  stateBlock(stream, world->particles.y, sizeof(float) * count);
+  stateBlock(stream, world->particles.vx, sizeof(float) * count);
+  stateBlock(stream, world->particles.vy, sizeof(float) * count);
+  stateBlock(stream, world->particles.life, sizeof(float) * count);
+  stateBlock(stream, world->particles.invLife, sizeof(float) * count);
+  stateBlock(stream, world->particles.size, sizeof(float) * count);
+  stateBlock(stream, world->particles.color, sizeof(Color) * count);
+  stateBlock(stream, &world->burstCount, sizeof(world->burstCount));
+}
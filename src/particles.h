@@ -0,0 +1,38 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "types.h"
+
+#define MAX_PARTICLES 65536
+#define PARTICLE_BUDGET_MS 1.0 // Target update cost per tick
+
+// Structure-of-arrays particle pool; live particles are packed into [0, count)
+typedef struct
+{
+  int count;
+  float x[MAX_PARTICLES], y[MAX_PARTICLES];   // World pixels
+  float vx[MAX_PARTICLES], vy[MAX_PARTICLES]; // World pixels per tick
+  float life[MAX_PARTICLES];                  // Ticks left
+  float invLife[MAX_PARTICLES];               // 1 / starting life, for fading
+  float size[MAX_PARTICLES];
+  Color color[MAX_PARTICLES];
+} ParticlePool;
+
+// Particle system statistics (refreshed every frame)
+typedef struct
+{
+  int liveCount;       // Particles alive after the last update
+  int dropped;         // Particles not emitted because the pool was full or over budget
+  double lastUpdateMs; // Wall time of the most recent updateParticles
+} ParticleStats;
+
+// Function declarations for particle effects
+void emitParticleBurst(float worldX, float worldY, int count, float speed, float life, float size, Color color);
+void emitHitEffect(int cellX, int cellY, Color color);
+void emitExplosion(int cellX, int cellY);
+void emitDeathEffect(int cellX, int cellY);
+void updateParticles();
+void clearParticles();
+double particleFrameMs();
+
+#endif
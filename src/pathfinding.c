@@ -0,0 +1,572 @@
+#include "types.h"
+#include "globals.h"
+#include "world.h"
+#include "pathfinding.h"
+#include "platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Hierarchical (HPA*-style) pathfinding. Every chunk caches "portals": one cell
+// per passable run along each of its four borders, plus the walking distance
+// between every pair of its portals. Two portals facing each other across a
+// border are linked (both ways) wherever their runs overlap. Long routes are
+// searched over that small portal graph and then refined cell by cell one
+// chunk (or chunk pair) at a time.
+
+#define PATH_UNREACHABLE 0xFFFF
+#define PATH_GOAL_NODE PATH_NODE_COUNT
+
+int isTerrainPassable(int terrainType)
+{
+  return terrainType != TERRAIN_MOUNTAIN && terrainType != TERRAIN_SEA;
+}
+
+int isCellPassable(int worldX, int worldY)
+{
+  WorldPosition pos = worldToChunk(worldX, worldY);
+  int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+  if (chunkIndex == -1)
+    return 0; // Unloaded terrain is treated as a wall
+
+  return isTerrainPassable(world->loadedChunks[chunkIndex].terrain[pos.localX][pos.localY]);
+}
+
+// Local cell at position t along a chunk border
+static void borderCell(int side, int t, int *x, int *y)
+{
+  switch (side)
+  {
+  case UP:
+    *x = t;
+    *y = 0;
+    break;
+  case DOWN:
+    *x = t;
+    *y = CHUNK_SIZE - 1;
+    break;
+  case LEFT:
+    *x = 0;
+    *y = t;
+    break;
+  default:
+    *x = CHUNK_SIZE - 1;
+    *y = t;
+    break;
+  }
+}
+
+// Position of a portal along its own border
+static int portalOffset(const ChunkPortal *portal)
+{
+  return (portal->side == UP || portal->side == DOWN) ? portal->x : portal->y;
+}
+
+static int oppositeSide(int side)
+{
+  switch (side)
+  {
+  case UP:
+    return DOWN;
+  case DOWN:
+    return UP;
+  case LEFT:
+    return RIGHT;
+  default:
+    return LEFT;
+  }
+}
+
+// Passability of a chunk as one bit per cell (bit x of rows[y])
+static void chunkPassableRows(const Chunk *chunk, unsigned int *rows)
+{
+  for (int y = 0; y < CHUNK_SIZE; y++)
+  {
+    unsigned int row = 0;
+    for (int x = 0; x < CHUNK_SIZE; x++)
+    {
+      if (isTerrainPassable(chunk->terrain[x][y]))
+        row |= 1u << x;
+    }
+    rows[y] = row;
+  }
+}
+
+// Bit-parallel breadth-first flood from one cell: every step grows the whole
+// wavefront by one cell, one 32-bit row at a time. Records the step at which
+// each portal is reached (PATH_UNREACHABLE if never).
+static void floodPortalDistances(const Chunk *chunk, const unsigned int *rows, int startX, int startY, unsigned short *dist)
+{
+  unsigned int visited[CHUNK_SIZE] = {0};
+  unsigned int frontier[CHUNK_SIZE] = {0};
+  unsigned int next[CHUNK_SIZE];
+  int remaining = chunk->portalCount;
+
+  for (int p = 0; p < chunk->portalCount; p++)
+    dist[p] = PATH_UNREACHABLE;
+
+  if (!(rows[startY] & (1u << startX)))
+    return;
+
+  visited[startY] = frontier[startY] = 1u << startX;
+
+  for (int step = 0; remaining > 0; step++)
+  {
+    for (int p = 0; p < chunk->portalCount; p++)
+    {
+      if (dist[p] == PATH_UNREACHABLE && (frontier[chunk->portals[p].y] & (1u << chunk->portals[p].x)))
+      {
+        dist[p] = step;
+        remaining--;
+      }
+    }
+
+    unsigned int grown = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      unsigned int spread = frontier[y] | (frontier[y] << 1) | (frontier[y] >> 1);
+      if (y > 0)
+        spread |= frontier[y - 1];
+      if (y < CHUNK_SIZE - 1)
+        spread |= frontier[y + 1];
+      next[y] = spread & rows[y] & ~visited[y];
+      grown |= next[y];
+    }
+    if (!grown)
+      break;
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      visited[y] |= next[y];
+      frontier[y] = next[y];
+    }
+  }
+}
+
+void buildChunkPortals(int chunkIndex)
+{
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+  unsigned int rows[CHUNK_SIZE];
+  unsigned short dist[MAX_CHUNK_PORTALS];
+
+  chunkPassableRows(chunk, rows);
+  chunk->portalCount = 0;
+
+  // One portal in the middle of every passable run along each border
+  for (int side = UP; side <= RIGHT; side++)
+  {
+    int sidePortals = 0;
+    int t = 0;
+
+    while (t < CHUNK_SIZE)
+    {
+      int x, y;
+      borderCell(side, t, &x, &y);
+      if (!(rows[y] & (1u << x)))
+      {
+        t++;
+        continue;
+      }
+
+      int runStart = t;
+      while (t < CHUNK_SIZE)
+      {
+        borderCell(side, t, &x, &y);
+        if (!(rows[y] & (1u << x)))
+          break;
+        t++;
+      }
+
+      if (sidePortals < MAX_PORTALS_PER_SIDE && chunk->portalCount < MAX_CHUNK_PORTALS)
+      {
+        ChunkPortal *portal = &chunk->portals[chunk->portalCount++];
+        borderCell(side, (runStart + t - 1) / 2, &x, &y);
+        portal->x = x;
+        portal->y = y;
+        portal->side = side;
+        portal->lo = runStart;
+        portal->hi = t - 1;
+        sidePortals++;
+      }
+    }
+  }
+
+  // Cache walking distances between every pair of portals
+  for (int p = 0; p < chunk->portalCount; p++)
+  {
+    floodPortalDistances(chunk, rows, chunk->portals[p].x, chunk->portals[p].y, dist);
+    for (int q = 0; q < chunk->portalCount; q++)
+    {
+      chunk->portalDist[p][q] = dist[q];
+    }
+  }
+
+  chunk->portalsValid = 1;
+  __atomic_add_fetch(&world->pathStats.portalRebuilds, 1, __ATOMIC_RELAXED); // Chunks build in parallel
+}
+
+void invalidateChunkPaths(int chunkIndex)
+{
+  world->loadedChunks[chunkIndex].portalsValid = 0;
+}
+
+static Chunk *pathChunk(int chunkIndex)
+{
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+  if (!chunk->portalsValid)
+    buildChunkPortals(chunkIndex);
+  return chunk;
+}
+
+// Portal of a chunk whose border run on the given side covers offset t
+static int findPortalOnSide(const Chunk *chunk, int side, int t)
+{
+  for (int p = 0; p < chunk->portalCount; p++)
+  {
+    if (chunk->portals[p].side == side && chunk->portals[p].lo <= t && t <= chunk->portals[p].hi)
+      return p;
+  }
+  return -1;
+}
+
+// Where to cross between two portals on either side of one border: the offset
+// in the overlap of their runs that keeps the walk along both runs shortest,
+// or -1 if the runs do not overlap. Symmetric in its two arguments.
+static int crossingOffset(const ChunkPortal *a, const ChunkPortal *b)
+{
+  int overlapLo = a->lo > b->lo ? a->lo : b->lo;
+  int overlapHi = a->hi < b->hi ? a->hi : b->hi;
+  if (overlapLo > overlapHi)
+    return -1;
+
+  // Anywhere between the two portals costs the same; otherwise the overlap's
+  // nearer end
+  int from = portalOffset(a);
+  int to = portalOffset(b);
+  int low = from < to ? from : to;
+  int high = from < to ? to : from;
+  if (high < overlapLo)
+    return overlapLo;
+  if (low > overlapHi)
+    return overlapHi;
+  return low > overlapLo ? low : overlapLo;
+}
+
+// Returns 0 if the heap is full; the search must then give up, since a
+// dropped node could be the only way on
+static int heapPush(int priority, int node)
+{
+  if (world->heapSize >= PATH_HEAP_SIZE)
+    return 0;
+
+  int i = world->heapSize++;
+  while (i > 0)
+  {
+    int parent = (i - 1) / 2;
+    if (world->heap[parent].priority <= priority)
+      break;
+    world->heap[i] = world->heap[parent];
+    i = parent;
+  }
+  world->heap[i].priority = priority;
+  world->heap[i].node = node;
+  return 1;
+}
+
+static PathHeapEntry heapPop()
+{
+  PathHeapEntry top = world->heap[0];
+  PathHeapEntry last = world->heap[--world->heapSize];
+  int i = 0;
+
+  while (1)
+  {
+    int child = i * 2 + 1;
+    if (child >= world->heapSize)
+      break;
+    if (child + 1 < world->heapSize && world->heap[child + 1].priority < world->heap[child].priority)
+      child++;
+    if (last.priority <= world->heap[child].priority)
+      break;
+    world->heap[i] = world->heap[child];
+    i = child;
+  }
+  world->heap[i] = last;
+  return top;
+}
+
+static PathPoint nodeCell(int node)
+{
+  const Chunk *chunk = &world->loadedChunks[node / MAX_CHUNK_PORTALS];
+  const ChunkPortal *portal = &chunk->portals[node % MAX_CHUNK_PORTALS];
+  PathPoint cell = {chunk->chunkX * CHUNK_SIZE + portal->x, chunk->chunkY * CHUNK_SIZE + portal->y};
+  return cell;
+}
+
+static int nodeHeuristic(int node, int goalX, int goalY)
+{
+  if (node == PATH_GOAL_NODE)
+    return 0;
+  PathPoint cell = nodeCell(node);
+  return abs(cell.x - goalX) + abs(cell.y - goalY);
+}
+
+// Returns 0 if the open list overflowed
+static int relaxNode(int node, int cost, int parent, int goalX, int goalY)
+{
+  if (world->nodeStamp[node] == world->searchStamp && world->nodeCost[node] <= cost)
+    return 1;
+
+  world->nodeStamp[node] = world->searchStamp;
+  world->nodeCost[node] = cost;
+  world->nodeParent[node] = parent;
+  return heapPush(cost + nodeHeuristic(node, goalX, goalY), node);
+}
+
+// Breadth-first search between two cells of the same chunk. Appends the cells
+// after (ax, ay) up to and including (bx, by); returns the new length or -1.
+static int refineInChunk(int chunkIndex, int ax, int ay, int bx, int by, PathPoint *path, int length, int maxLength)
+{
+  const Chunk *chunk = &world->loadedChunks[chunkIndex];
+  int originX = chunk->chunkX * CHUNK_SIZE;
+  int originY = chunk->chunkY * CHUNK_SIZE;
+  short parent[CHUNK_SIZE * CHUNK_SIZE];
+  short queue[CHUNK_SIZE * CHUNK_SIZE];
+  int head = 0, tail = 0;
+
+  int startCell = (ax - originX) * CHUNK_SIZE + (ay - originY);
+  int goalCell = (bx - originX) * CHUNK_SIZE + (by - originY);
+
+  for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+    parent[i] = -1;
+
+  parent[startCell] = startCell;
+  queue[tail++] = startCell;
+
+  while (head < tail && parent[goalCell] == -1)
+  {
+    int cell = queue[head++];
+    int x = cell / CHUNK_SIZE;
+    int y = cell % CHUNK_SIZE;
+    const int stepX[4] = {0, 0, -1, 1};
+    const int stepY[4] = {-1, 1, 0, 0};
+
+    for (int d = 0; d < 4; d++)
+    {
+      int nx = x + stepX[d];
+      int ny = y + stepY[d];
+      if (nx < 0 || ny < 0 || nx >= CHUNK_SIZE || ny >= CHUNK_SIZE)
+        continue;
+
+      int next = nx * CHUNK_SIZE + ny;
+      if (parent[next] != -1 || !isTerrainPassable(chunk->terrain[nx][ny]))
+        continue;
+
+      parent[next] = cell;
+      queue[tail++] = next;
+    }
+  }
+
+  if (parent[goalCell] == -1)
+    return -1;
+
+  // Count the segment, then write it front to back
+  int steps = 0;
+  for (int cell = goalCell; cell != startCell; cell = parent[cell])
+    steps++;
+  if (length + steps > maxLength)
+    return -1;
+
+  int i = length + steps - 1;
+  for (int cell = goalCell; cell != startCell; cell = parent[cell])
+  {
+    path[i].x = originX + cell / CHUNK_SIZE;
+    path[i].y = originY + cell % CHUNK_SIZE;
+    i--;
+  }
+  return length + steps;
+}
+
+// Walks straight along a border run: every cell between two points on the
+// same row or column of a run is passable by construction.
+static int refineStraight(int ax, int ay, int bx, int by, PathPoint *path, int length, int maxLength)
+{
+  int stepX = (bx > ax) - (bx < ax);
+  int stepY = (by > ay) - (by < ay);
+
+  if (length + abs(bx - ax) + abs(by - ay) > maxLength)
+    return -1;
+
+  while (ax != bx || ay != by)
+  {
+    ax += stepX;
+    ay += stepY;
+    path[length].x = ax;
+    path[length].y = ay;
+    length++;
+  }
+  return length;
+}
+
+static int searchPath(int startX, int startY, int goalX, int goalY, PathPoint *path, int maxLength)
+{
+  if (!isCellPassable(startX, startY) || !isCellPassable(goalX, goalY))
+    return -1;
+  if (startX == goalX && startY == goalY)
+    return 0;
+
+  WorldPosition start = worldToChunk(startX, startY);
+  WorldPosition goal = worldToChunk(goalX, goalY);
+  int startChunk = getChunkIndex(start.chunkX, start.chunkY);
+  int goalChunk = getChunkIndex(goal.chunkX, goal.chunkY);
+
+  // Short hops inside one chunk never need the portal graph
+  if (startChunk == goalChunk)
+  {
+    int length = refineInChunk(startChunk, startX, startY, goalX, goalY, path, 0, maxLength);
+    if (length >= 0)
+      return length;
+  }
+
+  unsigned int rows[CHUNK_SIZE];
+  unsigned short startDist[MAX_CHUNK_PORTALS];
+  unsigned short goalDist[MAX_CHUNK_PORTALS];
+  const Chunk *first = pathChunk(startChunk);
+  const Chunk *last = pathChunk(goalChunk);
+  chunkPassableRows(first, rows);
+  floodPortalDistances(first, rows, start.localX, start.localY, startDist);
+  chunkPassableRows(last, rows);
+  floodPortalDistances(last, rows, goal.localX, goal.localY, goalDist);
+
+  world->searchStamp++;
+  world->heapSize = 0;
+
+  int overflowed = 0;
+  for (int p = 0; p < first->portalCount; p++)
+  {
+    if (startDist[p] != PATH_UNREACHABLE)
+      overflowed |= !relaxNode(startChunk * MAX_CHUNK_PORTALS + p, startDist[p], -1, goalX, goalY);
+  }
+
+  int found = 0;
+  while (world->heapSize > 0 && !overflowed)
+  {
+    PathHeapEntry entry = heapPop();
+    int node = entry.node;
+    int cost = world->nodeCost[node];
+
+    if (entry.priority != cost + nodeHeuristic(node, goalX, goalY))
+      continue; // Stale heap entry
+    if (node == PATH_GOAL_NODE)
+    {
+      found = 1;
+      break;
+    }
+
+    world->pathStats.lastNodesExpanded++;
+
+    int chunkIndex = node / MAX_CHUNK_PORTALS;
+    int p = node % MAX_CHUNK_PORTALS;
+    const Chunk *chunk = &world->loadedChunks[chunkIndex];
+    const ChunkPortal *portal = &chunk->portals[p];
+
+    // Leave the graph for the goal cell
+    if (chunkIndex == goalChunk)
+    {
+      if (goalDist[p] != PATH_UNREACHABLE)
+        overflowed |= !relaxNode(PATH_GOAL_NODE, cost + goalDist[p], node, goalX, goalY);
+    }
+
+    // Other portals of the same chunk
+    for (int q = 0; q < chunk->portalCount; q++)
+    {
+      if (q != p && chunk->portalDist[p][q] != PATH_UNREACHABLE)
+        overflowed |= !relaxNode(chunkIndex * MAX_CHUNK_PORTALS + q, cost + chunk->portalDist[p][q], node, goalX, goalY);
+    }
+
+    // Step across the border into every neighbouring portal whose run overlaps this one
+    int neighborX = chunk->chunkX + (portal->side == LEFT ? -1 : portal->side == RIGHT ? 1 : 0);
+    int neighborY = chunk->chunkY + (portal->side == UP ? -1 : portal->side == DOWN ? 1 : 0);
+    int neighborIndex = getChunkIndex(neighborX, neighborY);
+    if (neighborIndex != -1)
+    {
+      const Chunk *neighbor = pathChunk(neighborIndex);
+      int facing = oppositeSide(portal->side);
+      for (int q = 0; q < neighbor->portalCount; q++)
+      {
+        const ChunkPortal *other = &neighbor->portals[q];
+        int t = other->side == facing ? crossingOffset(portal, other) : -1;
+        if (t == -1)
+          continue;
+        int edgeCost = abs(portalOffset(portal) - t) + 1 + abs(t - portalOffset(other));
+        overflowed |= !relaxNode(neighborIndex * MAX_CHUNK_PORTALS + q, cost + edgeCost, node, goalX, goalY);
+      }
+    }
+  }
+
+  if (overflowed)
+  {
+    world->pathStats.heapOverflows++;
+    return -1;
+  }
+  if (!found)
+    return -1;
+
+  // Collect the abstract route (goal back to start), then refine it front to back
+  int waypointCount = 0;
+  world->waypoints[waypointCount++] = (PathPoint){goalX, goalY};
+  for (int node = world->nodeParent[PATH_GOAL_NODE]; node != -1; node = world->nodeParent[node])
+  {
+    if (waypointCount >= PATH_MAX_WAYPOINTS - 1)
+      return -1;
+    world->waypoints[waypointCount++] = nodeCell(node);
+  }
+  world->waypoints[waypointCount++] = (PathPoint){startX, startY};
+
+  int length = 0;
+  for (int i = waypointCount - 1; i > 0 && length >= 0; i--)
+  {
+    PathPoint from = world->waypoints[i];
+    PathPoint to = world->waypoints[i - 1];
+    WorldPosition a = worldToChunk(from.x, from.y);
+    WorldPosition b = worldToChunk(to.x, to.y);
+
+    if (a.chunkX == b.chunkX && a.chunkY == b.chunkY)
+    {
+      length = refineInChunk(getChunkIndex(a.chunkX, a.chunkY), from.x, from.y, to.x, to.y, path, length, maxLength);
+    }
+    else
+    {
+      // Border crossing: along this run to the crossing, one step over, then
+      // along the neighbour's run
+      const Chunk *chunk = &world->loadedChunks[getChunkIndex(a.chunkX, a.chunkY)];
+      const Chunk *neighbor = &world->loadedChunks[getChunkIndex(b.chunkX, b.chunkY)];
+      int side = b.chunkX < a.chunkX ? LEFT : b.chunkX > a.chunkX ? RIGHT : b.chunkY < a.chunkY ? UP : DOWN;
+      int vertical = side == UP || side == DOWN;
+      int p = findPortalOnSide(chunk, side, vertical ? a.localX : a.localY);
+      int q = findPortalOnSide(neighbor, oppositeSide(side), vertical ? b.localX : b.localY);
+      int t = crossingOffset(&chunk->portals[p], &neighbor->portals[q]);
+      int edgeX = vertical ? a.chunkX * CHUNK_SIZE + t : from.x;
+      int edgeY = vertical ? from.y : a.chunkY * CHUNK_SIZE + t;
+      int crossX = edgeX + (b.chunkX - a.chunkX);
+      int crossY = edgeY + (b.chunkY - a.chunkY);
+      length = refineStraight(from.x, from.y, edgeX, edgeY, path, length, maxLength);
+      if (length >= 0)
+        length = refineStraight(edgeX, edgeY, crossX, crossY, path, length, maxLength);
+      if (length >= 0)
+        length = refineStraight(crossX, crossY, to.x, to.y, path, length, maxLength);
+    }
+  }
+  return length;
+}
+
+int findPath(int startX, int startY, int goalX, int goalY, PathPoint *path, int maxLength)
+{
+  double queryStart = platformTimer();
+
+  world->pathStats.lastNodesExpanded = 0;
+  int length = searchPath(startX, startY, goalX, goalY, path, maxLength);
+
+  world->pathStats.lastQueryMs = (platformTimer() - queryStart) * 1000.0;
+  world->pathStats.lastPathLength = length > 0 ? length : 0;
+  return length;
+}
@@ -0,0 +1,36 @@
+#ifndef PATHFINDING_H
+#define PATHFINDING_H
+
+#include "types.h"
+
+#define PATH_NODE_COUNT (MAX_LOADED_CHUNKS * MAX_CHUNK_PORTALS)
+#define PATH_HEAP_SIZE (PATH_NODE_COUNT * 4)
+#define PATH_MAX_WAYPOINTS 4096
+
+// Pathfinding statistics (updated by every findPath call)
+typedef struct
+{
+  double lastQueryMs;    // Wall time of the most recent query
+  int lastNodesExpanded; // Abstract portal nodes expanded by the most recent query
+  int lastPathLength;    // Cells in the most recent refined path (0 = no route)
+  int portalRebuilds;    // Chunks whose portal cache has been (re)built
+  int heapOverflows;     // Queries given up because the open list filled (no route reported)
+} PathStats;
+
+typedef struct
+{
+  int priority;
+  int node;
+} PathHeapEntry;
+
+// Function declarations for pathfinding. findPath searches with the world's
+// single set of search buffers, so it must not run inside a parallel job;
+// today only the player's click-to-move calls it (monster AI kernels still
+// use straight-line steps and random walks).
+int isTerrainPassable(int terrainType);
+int isCellPassable(int worldX, int worldY);
+void buildChunkPortals(int chunkIndex);
+void invalidateChunkPaths(int chunkIndex);
+int findPath(int startX, int startY, int goalX, int goalY, PathPoint *path, int maxLength);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include "types.h"
+
+// Function declarations for the platform layer: everything the simulation
+// needs from the outside world. platform_raylib.c backs it with the window,
+// keyboard and audio device; platform_headless.c with a monotonic clock,
+// scripted or no input and no sound (gridlock-headless).
+double platformTimer();            // Seconds on a monotonic clock, for profiling stats
+void platformPlaySound(int sound); // Index into sounds[]; callable from any thread
+void playQueuedSounds();           // Windowed build only, from the main thread
+
+#endif
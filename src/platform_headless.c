@@ -0,0 +1,23 @@
+#define _POSIX_C_SOURCE 200809L
+#include "types.h"
+#include "platform.h"
+#include "input.h"
+#include <time.h>
+
+double platformTimer()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+void platformPlaySound(int sound)
+{
+  (void)sound; // Muted: there is no audio device
+}
+
+// No devices to read: the input state is whatever the driver (or nothing) set
+void pollInput(InputState *state)
+{
+  (void)state;
+}
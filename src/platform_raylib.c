@@ -0,0 +1,77 @@
+#include "types.h"
+#include "globals.h"
+#include "platform.h"
+#include "input.h"
+#include "console.h"
+#include <pthread.h>
+#include <math.h>
+
+static pthread_mutex_t soundLock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int queuedSounds = 0; // Bit per sounds[] entry
+
+double platformTimer()
+{
+  return GetTime();
+}
+
+// Safe from the simulation thread: the sound starts on the next rendered frame
+void platformPlaySound(int sound)
+{
+  pthread_mutex_lock(&soundLock);
+  queuedSounds |= 1u << sound;
+  pthread_mutex_unlock(&soundLock);
+}
+
+// Main thread, once per rendered frame
+void playQueuedSounds()
+{
+  pthread_mutex_lock(&soundLock);
+  unsigned int queued = queuedSounds;
+  queuedSounds = 0;
+  pthread_mutex_unlock(&soundLock);
+
+  for (int i = 0; queued != 0; i++, queued >>= 1)
+  {
+    if (queued & 1u)
+      PlaySound(sounds[i]);
+  }
+}
+
+// Called once per rendered frame on the main thread
+void pollInput(InputState *state)
+{
+  // Typing into the console is not playing
+  if (consoleOpen())
+  {
+    state->up = state->down = state->left = state->right = state->shoot = 0;
+    return;
+  }
+
+  state->up = IsKeyDown(KEY_W) || IsKeyDown(KEY_UP);
+  state->down = IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN);
+  state->left = IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT);
+  state->right = IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT);
+  state->shoot = IsKeyDown(KEY_SPACE);
+
+  if (IsKeyPressed(KEY_ONE))
+    state->jumpSmash = 1;
+  if (IsKeyPressed(KEY_TWO))
+    state->rush = 1;
+  if (IsKeyPressed(KEY_THREE))
+    state->heal = 1;
+  if (IsKeyPressed(KEY_R))
+    state->restart = 1;
+  if (IsKeyPressed(KEY_N))
+    state->toggleNight = 1;
+  if (IsKeyPressed(KEY_BACKSPACE))
+    state->rewind = 1;
+
+  if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+  {
+    // Resolved against the camera the player actually clicked on
+    Vector2 target = GetScreenToWorld2D(GetMousePosition(), camera);
+    state->clickX = (int)floorf(target.x / CELL_SIZE);
+    state->clickY = (int)floorf(target.y / CELL_SIZE);
+    state->clicked = 1;
+  }
+}
@@ -1,61 +1,75 @@
 #include "types.h"
 #include "globals.h"
+#include "pathfinding.h"
+#include "input.h"
+#include "savestate.h"
+#include "tunables.h"
+#include "platform.h"
 #include <stdlib.h>
 #include <math.h>
 
 // Function prototype for spawnProjectile (defined in projectiles.c)
-void spawnProjectile(int x, int y, float dx, float dy, int type, int damage);
+void spawnProjectile(int x, int y, float dx, float dy, int type, int damage, int owner);
 
 void updatePlayer()
 {
   // Update status effects
-  if (player.stunTimer > 0)
+  if (world->player.stunTimer > 0)
   {
-    player.stunTimer--;
+    world->player.stunTimer--;
     return; // Can't move or act while stunned
   }
 
-  if (player.dotTimer > 0)
+  if (world->player.dotTimer > 0)
   {
-    player.dotTimer--;
-    if (player.dotTimer % 60 == 0) // Every second
+    world->player.dotTimer--;
+    if (world->player.dotTimer % 60 == 0) // Every second
     {
-      player.health -= player.dotDamage;
-      if (player.health <= 0)
+      world->player.health -= world->player.dotDamage;
+      if (world->player.health <= 0)
       {
-        player.alive = 0;
-        PlaySound(sounds[3]); // Death sound
+        world->player.alive = 0;
+        platformPlaySound(3); // Death sound
       }
     }
   }
 
-  if (player.speedBoostTimer > 0)
+  if (world->player.speedBoostTimer > 0)
   {
-    player.speedBoostTimer--;
+    world->player.speedBoostTimer--;
   } // Update ability cooldowns
-  if (player.jumpSmashCooldown > 0)
-    player.jumpSmashCooldown--;
-  if (player.rushCooldown > 0)
-    player.rushCooldown--;
-  if (player.healCooldown > 0)
-    player.healCooldown--;
-  if (player.arrowCooldown > 0)
-    player.arrowCooldown--;
+  if (world->player.jumpSmashCooldown > 0)
+    world->player.jumpSmashCooldown--;
+  if (world->player.rushCooldown > 0)
+    world->player.rushCooldown--;
+  if (world->player.healCooldown > 0)
+    world->player.healCooldown--;
+  if (world->player.arrowCooldown > 0)
+    world->player.arrowCooldown--;
 
   // Update movement cooldown
-  if (player.movementCooldown > 0)
+  if (world->player.movementCooldown > 0)
   {
-    player.movementCooldown--;
+    world->player.movementCooldown--;
   }
 
   // Update invulnerability timer
-  if (player.invulnerabilityTimer > 0)
+  if (world->player.invulnerabilityTimer > 0)
   {
-    player.invulnerabilityTimer--;
+    world->player.invulnerabilityTimer--;
+  }
+
+  // Click-to-move: plan a route to the clicked cell
+  if (world->input.clicked)
+  {
+    world->playerPathLength = findPath(world->player.x, world->player.y, world->input.clickX, world->input.clickY, world->playerPath, MAX_PATH_LENGTH);
+    world->playerPathStep = 0;
+    if (world->playerPathLength < 0)
+      world->playerPathLength = 0;
   }
 
   // Don't process movement input while on cooldown
-  if (player.movementCooldown > 0)
+  if (world->player.movementCooldown > 0)
   {
     return;
   }
@@ -64,84 +78,110 @@ void updatePlayer()
   int moved = 0;
 
   // Track intended direction from key presses
-  player.intendedDirX = 0;
-  player.intendedDirY = 0;
+  world->player.intendedDirX = 0;
+  world->player.intendedDirY = 0;
 
-  if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP))
+  if (world->input.up)
   {
-    player.intendedDirY = -1;
+    world->player.intendedDirY = -1;
   }
-  if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN))
+  if (world->input.down)
   {
-    player.intendedDirY = 1;
+    world->player.intendedDirY = 1;
   }
-  if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT))
+  if (world->input.left)
   {
-    player.intendedDirX = -1;
+    world->player.intendedDirX = -1;
   }
-  if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT))
+  if (world->input.right)
   {
-    player.intendedDirX = 1;
+    world->player.intendedDirX = 1;
   }
 
   // If no intended direction, keep last direction
-  if (player.intendedDirX == 0 && player.intendedDirY == 0)
+  if (world->player.intendedDirX == 0 && world->player.intendedDirY == 0)
   {
-    player.intendedDirX = player.lastDirX;
-    player.intendedDirY = player.lastDirY;
+    world->player.intendedDirX = world->player.lastDirX;
+    world->player.intendedDirY = world->player.lastDirY;
   }
 
   // Calculate current speed multiplier (includes rush boost)
-  float currentSpeedMultiplier = player.speedMultiplier;
-  if (player.speedBoostTimer > 0)
+  float currentSpeedMultiplier = world->player.speedMultiplier;
+  if (world->player.speedBoostTimer > 0)
   {
     currentSpeedMultiplier *= 2.0f; // 2x speed during rush
   }
 
-  if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP))
+  if (world->input.up)
   {
-    player.y -= player.speed * currentSpeedMultiplier;
-    player.lastDirX = 0;
-    player.lastDirY = -1;
+    world->player.y -= world->player.speed * currentSpeedMultiplier;
+    world->player.lastDirX = 0;
+    world->player.lastDirY = -1;
     moved = 1;
   }
-  if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN))
+  if (world->input.down)
   {
-    player.y += player.speed * currentSpeedMultiplier;
-    player.lastDirX = 0;
-    player.lastDirY = 1;
+    world->player.y += world->player.speed * currentSpeedMultiplier;
+    world->player.lastDirX = 0;
+    world->player.lastDirY = 1;
     moved = 1;
   }
-  if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT))
+  if (world->input.left)
   {
-    player.x -= player.speed * currentSpeedMultiplier;
-    player.lastDirX = -1;
-    player.lastDirY = 0;
+    world->player.x -= world->player.speed * currentSpeedMultiplier;
+    world->player.lastDirX = -1;
+    world->player.lastDirY = 0;
     moved = 1;
   }
-  if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT))
+  if (world->input.right)
   {
-    player.x += player.speed * currentSpeedMultiplier;
-    player.lastDirX = 1;
-    player.lastDirY = 0;
+    world->player.x += world->player.speed * currentSpeedMultiplier;
+    world->player.lastDirX = 1;
+    world->player.lastDirY = 0;
     moved = 1;
   }
 
+  if (moved)
+  {
+    world->playerPathLength = 0; // Keyboard input cancels a click-to-move route
+  }
+  else if (world->playerPathStep < world->playerPathLength)
+  {
+    // Follow the planned route one cell per move
+    PathPoint next = world->playerPath[world->playerPathStep++];
+    int stepX = next.x - world->player.x;
+    int stepY = next.y - world->player.y;
+
+    if (abs(stepX) + abs(stepY) == 1)
+    {
+      world->player.x = next.x;
+      world->player.y = next.y;
+      world->player.lastDirX = stepX;
+      world->player.lastDirY = stepY;
+      moved = 1;
+    }
+    else
+    {
+      world->playerPathLength = 0; // Knocked off the route (jump, restart)
+    }
+  }
+
   // If player moved, set cooldown (longer when in combat)
   if (moved)
   {
-    player.movementCooldown = player.isInCombat ? 12 : 6; // 50% slower when fighting
+    int cooldown = world->tunables[TUNE_MOVE_COOLDOWN].value;
+    world->player.movementCooldown = world->player.isInCombat ? cooldown * 2 : cooldown; // 50% slower when fighting
     // Play movement sound
     // if (sounds[0].frameCount > 0) PlaySound(sounds[0]);
   }
 
   // Handle abilities
-  if (IsKeyPressed(KEY_ONE) && player.jumpSmashCooldown <= 0)
+  if (world->input.jumpSmash && world->player.jumpSmashCooldown <= 0)
   {
     // Jump smash: jump forward and AoE damage
     int jumpDistance = 3;
-    int dirX = player.intendedDirX;
-    int dirY = player.intendedDirY;
+    int dirX = world->player.intendedDirX;
+    int dirY = world->player.intendedDirY;
 
     // If no intended direction, default to up
     if (dirX == 0 && dirY == 0)
@@ -150,56 +190,56 @@ void updatePlayer()
       dirY = -1;
     }
 
-    int jumpX = player.x + dirX * jumpDistance;
-    int jumpY = player.y + dirY * jumpDistance;
+    int jumpX = world->player.x + dirX * jumpDistance;
+    int jumpY = world->player.y + dirY * jumpDistance;
 
     // Move player
-    player.x = jumpX;
-    player.y = jumpY;
+    world->player.x = jumpX;
+    world->player.y = jumpY;
 
     // AoE damage to nearby monsters
-    for (int i = 0; i < monsterCount; i++)
+    for (int i = 0; i < world->monsterCount; i++)
     {
-      if (!monsters[i].alive)
+      if (!world->monsters[i].alive)
         continue;
-      float dx = monsters[i].x - player.x;
-      float dy = monsters[i].y - player.y;
+      float dx = world->monsters[i].x - world->player.x;
+      float dy = world->monsters[i].y - world->player.y;
       if (sqrt(dx * dx + dy * dy) <= 2) // Within 2 units
       {
-        monsters[i].health -= player.power * 2;
-        if (monsters[i].health <= 0)
+        world->monsters[i].health -= world->player.power * 2;
+        if (world->monsters[i].health <= 0)
         {
-          monsters[i].alive = 0;
-          player.experience += 10;
+          world->monsters[i].alive = 0;
+          world->player.experience += 10;
         }
       }
     }
 
-    player.jumpSmashCooldown = 180; // 3 seconds
-    PlaySound(sounds[0]);
+    world->player.jumpSmashCooldown = world->tunables[TUNE_JUMP_SMASH_COOLDOWN].value; // 3 seconds by default
+    platformPlaySound(0);
   }
 
-  if (IsKeyPressed(KEY_TWO) && player.rushCooldown <= 0)
+  if (world->input.rush && world->player.rushCooldown <= 0)
   {
     // Rush: temporary speed boost
-    player.speedBoostTimer = 180; // 3 seconds of 2x speed
-    player.rushCooldown = 600;    // 10 seconds cooldown
-    PlaySound(sounds[0]);
+    world->player.speedBoostTimer = 180; // 3 seconds of 2x speed
+    world->player.rushCooldown = world->tunables[TUNE_RUSH_COOLDOWN].value; // 10 seconds by default
+    platformPlaySound(0);
   }
 
-  if (IsKeyPressed(KEY_THREE) && player.healCooldown <= 0)
+  if (world->input.heal && world->player.healCooldown <= 0)
   {
     // Full heal
-    player.health = player.maxHealth;
-    player.healCooldown = 1800; // 30 seconds
-    PlaySound(sounds[1]);       // Powerup sound
+    world->player.health = world->player.maxHealth;
+    world->player.healCooldown = world->tunables[TUNE_HEAL_COOLDOWN].value; // 30 seconds by default
+    platformPlaySound(1);       // Powerup sound
   }
 
   // Arrow shooting (hold space)
-  if (IsKeyDown(KEY_SPACE) && player.arrowCooldown <= 0)
+  if (world->input.shoot && world->player.arrowCooldown <= 0)
   {
-    float arrowDx = player.intendedDirX;
-    float arrowDy = player.intendedDirY;
+    float arrowDx = world->player.intendedDirX;
+    float arrowDy = world->player.intendedDirY;
 
     // If no intended direction, default to up
     if (arrowDx == 0 && arrowDy == 0)
@@ -218,13 +258,18 @@ void updatePlayer()
         arrowDy /= length;
       }
 
-      spawnProjectile(player.x, player.y, arrowDx, arrowDy, 2, player.power / 2);
-      player.arrowCooldown = 60; // Once per second
+      spawnProjectile(world->player.x, world->player.y, arrowDx, arrowDy, 2, world->player.power / 2, PROJECTILE_OWNER_PLAYER);
+      world->player.arrowCooldown = world->tunables[TUNE_ARROW_COOLDOWN].value; // Once per second by default
     }
   }
 
   // No bounds checking - unlimited world exploration!
+  // (The camera follows the player's interpolated position when drawing.)
+}
 
-  // Update camera to follow player
-  camera.target = (Vector2){player.x * CELL_SIZE, player.y * CELL_SIZE};
+void streamPlayerState(StateStream *stream)
+{
+  stateBlock(stream, &world->playerPathLength, sizeof(world->playerPathLength));
+  stateBlock(stream, &world->playerPathStep, sizeof(world->playerPathStep));
+  stateBlock(stream, world->playerPath, sizeof(world->playerPath[0]) * world->playerPathLength);
 }
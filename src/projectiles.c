@@ -1,176 +1,532 @@
 #include "types.h"
 #include "globals.h"
+#include "projectiles.h"
+#include "particles.h"
+#include "fire.h"
+#include "platform.h"
+#include "jobs.h"
+#include "savestate.h"
+#include "arena.h"
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
-void spawnProjectile(int x, int y, float dx, float dy, int type, int damage)
+// Hits are found with a swept test: every frame each projectile walks the
+// cells between its old and new position (Amanatides-Woo DDA) and looks them
+// up in a dense grid centred on the player. Monsters are written into the
+// grid "dilated" to their 3x3 hit area, so one lookup per visited cell finds
+// every monster close enough to be hit there.
+//
+// Integration and the sweeps run in parallel; the sweeps only look. Hits
+// are then applied in projectile order on one thread, re-sweeping the rare
+// projectile whose target an earlier one already killed, so the outcome is
+// the same as sweeping one projectile after another.
+
+#define PROJECTILE_DESPAWN_DISTANCE 50 // Projectiles farther than this from the player vanish
+#define PROJECTILE_HIT_RADIUS 1        // Hit anything within this many cells (per axis)
+#define MAX_SWEEP_CELLS 16 // Cells a single step can visit (speed 2 needs at most 5)
+#define PROJECTILE_JOB_GRAIN 1024 // Projectiles per parallelFor range
+
+// Sweep results: the monster slot hit first, or one of these
+#define HIT_NONE -1
+#define HIT_PLAYER -2
+
+// Bytes per projectile across all the pool's columns
+#define PROJECTILE_BYTES (9 * sizeof(float) + 4 * sizeof(int) + sizeof(unsigned char))
+
+// Impact spray colour by projectile type (lightning, fireball, arrow)
+static const Color projectileImpactColors[3] = {
+    {102, 191, 255, 255}, // SKYBLUE
+    {255, 161, 0, 255},   // ORANGE
+    {200, 200, 200, 255}, // LIGHTGRAY
+};
+
+#define GROW_COLUMN(column)                                          \
+  do                                                                 \
+  {                                                                  \
+    void *grown = realloc(column, (size_t)capacity * sizeof(*column)); \
+    if (grown == NULL)                                               \
+      return 0;                                                      \
+    column = grown;                                                  \
+  } while (0)
+
+static int growProjectilePool()
+{
+  if (world->projectiles.capacity >= MAX_PROJECTILES)
+    return 0;
+
+  int capacity = world->projectiles.capacity ? world->projectiles.capacity * 2 : INITIAL_PROJECTILE_CAPACITY;
+  if (capacity > MAX_PROJECTILES)
+    capacity = MAX_PROJECTILES;
+
+  // Grow every column; ones that already grew stay valid if a later one fails
+  GROW_COLUMN(world->projectiles.x);
+  GROW_COLUMN(world->projectiles.y);
+  GROW_COLUMN(world->projectiles.dx);
+  GROW_COLUMN(world->projectiles.dy);
+  GROW_COLUMN(world->projectiles.speed);
+  GROW_COLUMN(world->projectiles.range);
+  GROW_COLUMN(world->projectiles.maxRange);
+  GROW_COLUMN(world->projectiles.type);
+  GROW_COLUMN(world->projectiles.effect);
+  GROW_COLUMN(world->projectiles.damage);
+  GROW_COLUMN(world->projectiles.owner);
+  GROW_COLUMN(world->projectiles.alive);
+  GROW_COLUMN(world->projectiles.previousX);
+  GROW_COLUMN(world->projectiles.previousY);
+
+  world->projectiles.capacity = capacity;
+  return 1;
+}
+
+// A column that will not shrink keeps its bigger block, which still fits
+#define SHRINK_COLUMN(column)                                          \
+  do                                                                   \
+  {                                                                    \
+    void *shrunk = realloc(column, (size_t)capacity * sizeof(*column)); \
+    if (shrunk != NULL)                                                \
+      column = shrunk;                                                 \
+  } while (0)
+
+// Hands back the pool's slack: halves the capacity while the live
+// projectiles fit in a quarter of it
+void trimProjectilePool()
+{
+  int capacity = world->projectiles.capacity;
+  while (capacity > INITIAL_PROJECTILE_CAPACITY && world->projectiles.count <= capacity / 4)
+    capacity /= 2;
+  if (capacity == world->projectiles.capacity)
+    return;
+
+  SHRINK_COLUMN(world->projectiles.x);
+  SHRINK_COLUMN(world->projectiles.y);
+  SHRINK_COLUMN(world->projectiles.dx);
+  SHRINK_COLUMN(world->projectiles.dy);
+  SHRINK_COLUMN(world->projectiles.speed);
+  SHRINK_COLUMN(world->projectiles.range);
+  SHRINK_COLUMN(world->projectiles.maxRange);
+  SHRINK_COLUMN(world->projectiles.type);
+  SHRINK_COLUMN(world->projectiles.effect);
+  SHRINK_COLUMN(world->projectiles.damage);
+  SHRINK_COLUMN(world->projectiles.owner);
+  SHRINK_COLUMN(world->projectiles.alive);
+  SHRINK_COLUMN(world->projectiles.previousX);
+  SHRINK_COLUMN(world->projectiles.previousY);
+  world->projectiles.capacity = capacity;
+}
+
+// Gives the pool's columns back (a batch world being destroyed)
+void freeProjectilePool()
+{
+  free(world->projectiles.x);
+  free(world->projectiles.y);
+  free(world->projectiles.dx);
+  free(world->projectiles.dy);
+  free(world->projectiles.speed);
+  free(world->projectiles.range);
+  free(world->projectiles.maxRange);
+  free(world->projectiles.type);
+  free(world->projectiles.effect);
+  free(world->projectiles.damage);
+  free(world->projectiles.owner);
+  free(world->projectiles.alive);
+  free(world->projectiles.previousX);
+  free(world->projectiles.previousY);
+  memset(&world->projectiles, 0, sizeof(world->projectiles));
+}
+
+size_t projectileMemoryUsed()
+{
+  return (size_t)world->projectiles.capacity * PROJECTILE_BYTES;
+}
+
+void spawnProjectile(int x, int y, float dx, float dy, int type, int damage, int owner)
 {
-  if (projectileCount >= MAX_PROJECTILES)
+  if (world->projectiles.count >= world->projectiles.capacity && !growProjectilePool())
     return;
 
-  Projectile *proj = &projectiles[projectileCount++];
-  proj->x = x;
-  proj->y = y;
-  proj->dx = dx;
-  proj->dy = dy;
-  proj->type = type;
-  proj->alive = 1;
-  proj->damage = damage;
-  proj->speed = 2; // Projectiles move 2 cells per frame
+  int i = world->projectiles.count++;
+  world->projectiles.x[i] = x + 0.5f; // Start from the centre of the shooter's cell
+  world->projectiles.y[i] = y + 0.5f;
+  world->projectiles.previousX[i] = world->projectiles.x[i];
+  world->projectiles.previousY[i] = world->projectiles.y[i];
+  world->projectiles.dx[i] = dx;
+  world->projectiles.dy[i] = dy;
+  world->projectiles.type[i] = type;
+  world->projectiles.alive[i] = 1;
+  world->projectiles.damage[i] = damage;
+  world->projectiles.owner[i] = owner;
+  world->projectiles.speed[i] = 2.0f; // Projectiles move 2 cells per tick
 
   // Set effect and range based on type
   if (type == 0)
   {
-    proj->effect = 1;     // Lightning = stun
-    proj->maxRange = 200; // Lightning travels far
+    world->projectiles.effect[i] = 1;     // Lightning = stun
+    world->projectiles.maxRange[i] = 200; // Lightning travels far
   }
   else if (type == 1)
   {
-    proj->effect = 2;     // Fireball = DoT
-    proj->maxRange = 150; // Fireballs travel medium distance
+    world->projectiles.effect[i] = 2;     // Fireball = DoT
+    world->projectiles.maxRange[i] = 150; // Fireballs travel medium distance
   }
   else
   {
-    proj->effect = 0;    // Arrow = no effect
-    proj->maxRange = 80; // Arrows have limited range
+    world->projectiles.effect[i] = 0;    // Arrow = no effect
+    world->projectiles.maxRange[i] = 80; // Arrows have limited range
   }
-  proj->range = 0; // Start with zero distance traveled
+  world->projectiles.range[i] = 0; // Start with zero distance traveled
 }
 
-void updateProjectiles()
+void clearProjectiles()
 {
-  for (int i = projectileCount - 1; i >= 0; i--)
-  {
-    if (!projectiles[i].alive)
-      continue;
+  world->projectiles.count = 0;
+}
 
-    // Move projectile with precise float directions
-    projectiles[i].x += projectiles[i].dx * projectiles[i].speed;
-    projectiles[i].y += projectiles[i].dy * projectiles[i].speed;
+// Grid cell for a world cell, or -1 outside the grid
+static int gridCell(int worldX, int worldY)
+{
+  int gx = worldX - world->gridOriginX;
+  int gy = worldY - world->gridOriginY;
+  if ((unsigned int)gx >= PROJECTILE_GRID_DIM || (unsigned int)gy >= PROJECTILE_GRID_DIM)
+    return -1;
+  return gy * PROJECTILE_GRID_DIM + gx;
+}
 
-    // Update range traveled (calculate actual distance moved)
-    float distanceMoved = sqrt(projectiles[i].dx * projectiles[i].dx * projectiles[i].speed * projectiles[i].speed +
-                               projectiles[i].dy * projectiles[i].dy * projectiles[i].speed * projectiles[i].speed);
-    projectiles[i].range += (int)distanceMoved;
+static void buildMonsterGrid()
+{
+  world->gridFrame++;
+  world->gridOriginX = world->player.x - PROJECTILE_GRID_RADIUS;
+  world->gridOriginY = world->player.y - PROJECTILE_GRID_RADIUS;
 
-    // Check if projectile exceeded its maximum range
-    if (projectiles[i].range >= projectiles[i].maxRange)
-    {
-      projectiles[i].alive = 0;
+  int entries = 0;
+  for (int j = 0; j < world->monsterCount; j++)
+  {
+    if (!world->monsters[j].alive)
+      continue;
+    if (abs(world->monsters[j].x - world->player.x) > PROJECTILE_GRID_RADIUS + PROJECTILE_HIT_RADIUS ||
+        abs(world->monsters[j].y - world->player.y) > PROJECTILE_GRID_RADIUS + PROJECTILE_HIT_RADIUS)
       continue;
-    }
 
-    // Check collision with player
-    if (abs(projectiles[i].x - player.x) <= 1 && abs(projectiles[i].y - player.y) <= 1)
+    for (int oy = -PROJECTILE_HIT_RADIUS; oy <= PROJECTILE_HIT_RADIUS; oy++)
     {
-      if (!player.invulnerabilityTimer)
+      for (int ox = -PROJECTILE_HIT_RADIUS; ox <= PROJECTILE_HIT_RADIUS; ox++)
       {
-        player.health -= projectiles[i].damage;
-        PlaySound(sounds[0]);             // Fight sound
-        player.invulnerabilityTimer = 60; // 1 second invulnerability
-
-        // Apply projectile effects
-        if (projectiles[i].effect == 1) // Stun (lightning)
+        int cell = gridCell(world->monsters[j].x + ox, world->monsters[j].y + oy);
+        if (cell < 0)
+          continue;
+        if (world->gridStamp[cell] != world->gridFrame)
         {
-          player.stunTimer = 60; // 1 second stun
-        }
-        else if (projectiles[i].effect == 2) // DoT (fire)
-        {
-          player.dotTimer = 180;                        // 3 seconds DoT
-          player.dotDamage = projectiles[i].damage / 3; // Damage over 3 ticks
+          world->gridStamp[cell] = world->gridFrame;
+          world->gridHead[cell] = -1;
         }
+        world->gridMonster[entries] = j;
+        world->gridNext[entries] = world->gridHead[cell];
+        world->gridHead[cell] = entries++;
       }
-      projectiles[i].alive = 0;
-      continue;
     }
+  }
+}
 
-    // Check collision with monsters
-    for (int j = 0; j < monsterCount; j++)
-    {
-      if (!monsters[j].alive)
-        continue;
+static void hitPlayer(int i)
+{
+  if (!world->player.invulnerabilityTimer)
+  {
+    world->player.health -= world->projectiles.damage[i];
+    platformPlaySound(0);             // Fight sound
+    world->player.invulnerabilityTimer = 60; // 1 second invulnerability
+    emitHitEffect(world->player.x, world->player.y, RED);
 
-      if (abs(projectiles[i].x - monsters[j].x) <= 1 && abs(projectiles[i].y - monsters[j].y) <= 1)
-      {
-        // Damage the monster
-        monsters[j].health -= projectiles[i].damage;
+    // Apply projectile effects
+    if (world->projectiles.effect[i] == 1) // Stun (lightning)
+    {
+      world->player.stunTimer = 60; // 1 second stun
+    }
+    else if (world->projectiles.effect[i] == 2) // DoT (fire)
+    {
+      world->player.dotTimer = 180;                        // 3 seconds DoT
+      world->player.dotDamage = world->projectiles.damage[i] / 3; // Damage over 3 ticks
+    }
+  }
+}
 
-        // Apply projectile effects to monster
-        if (projectiles[i].effect == 1) // Stun (lightning)
-        {
-          monsters[j].stunTimer = 60; // 1 second stun
-        }
-        else if (projectiles[i].effect == 2) // DoT (fire)
-        {
-          monsters[j].dotTimer = 180;                        // 3 seconds DoT
-          monsters[j].dotDamage = projectiles[i].damage / 3; // Damage over 3 ticks
-        }
+static void hitMonster(int i, int j)
+{
+  // Damage the monster
+  world->monsters[j].health -= world->projectiles.damage[i];
+  emitHitEffect(world->monsters[j].x, world->monsters[j].y, projectileImpactColors[world->projectiles.type[i]]);
 
-        // Check if monster died
-        if (monsters[j].health <= 0)
-        {
-          monsters[j].alive = 0;
-          // Award experience to player
-          player.experience += monsters[j].power * 10;
-
-          // Check for level up
-          if (player.experience >= player.experienceToNext)
-          {
-            player.level++;
-            player.experience -= player.experienceToNext;
-            player.experienceToNext = player.level * 100;
-            player.maxHealth += 20;
-            player.health = player.maxHealth;
-            player.power += 2;
-          }
-        }
+  // Apply projectile effects to monster
+  if (world->projectiles.effect[i] == 1) // Stun (lightning)
+  {
+    world->monsters[j].stunTimer = 60; // 1 second stun
+  }
+  else if (world->projectiles.effect[i] == 2) // DoT (fire)
+  {
+    world->monsters[j].dotTimer = 180;                        // 3 seconds DoT
+    world->monsters[j].dotDamage = world->projectiles.damage[i] / 3; // Damage over 3 ticks
+  }
 
-        // Remove projectile after hitting
-        projectiles[i].alive = 0;
-        break; // Exit monster loop since projectile is dead
-      }
-    }
+  // Check if monster died
+  if (world->monsters[j].health <= 0)
+  {
+    world->monsters[j].alive = 0;
+    emitDeathEffect(world->monsters[j].x, world->monsters[j].y);
+    // Award experience to player
+    world->player.experience += world->monsters[j].power * 10;
 
-    // Despawn if too far
-    float dx = projectiles[i].x - player.x;
-    float dy = projectiles[i].y - player.y;
-    if (sqrt(dx * dx + dy * dy) > 50)
+    // Check for level up
+    if (world->player.experience >= world->player.experienceToNext)
     {
-      projectiles[i].alive = 0;
+      world->player.level++;
+      world->player.experience -= world->player.experienceToNext;
+      world->player.experienceToNext = world->player.level * 100;
+      world->player.maxHealth += 20;
+      world->player.health = world->player.maxHealth;
+      world->player.power += 2;
     }
   }
+}
+
+// Fireballs set the trees around where they land alight
+static void scorchTerrain(int i, int cellX, int cellY)
+{
+  if (world->projectiles.type[i] == 1)
+    igniteArea(cellX, cellY, 1);
+}
+
+// What a projectile would hit in one cell of its sweep (HIT_NONE if nothing)
+static int findHitInCell(int i, int cellX, int cellY)
+{
+  // The player is checked first, as long as it isn't the player's own arrow
+  if (world->projectiles.owner[i] != PROJECTILE_OWNER_PLAYER &&
+      abs(cellX - world->player.x) <= PROJECTILE_HIT_RADIUS && abs(cellY - world->player.y) <= PROJECTILE_HIT_RADIUS)
+    return HIT_PLAYER;
+
+  int cell = gridCell(cellX, cellY);
+  if (cell < 0 || world->gridStamp[cell] != world->gridFrame)
+    return HIT_NONE;
+
+  for (int e = world->gridHead[cell]; e != -1; e = world->gridNext[e])
+  {
+    int j = world->gridMonster[e];
+    if (world->monsters[j].alive && (int)world->monsters[j].id != world->projectiles.owner[i])
+      return j;
+  }
+  return HIT_NONE;
+}
+
+// floorf without the libm call (positions are far inside int range)
+static inline int floorToCell(float v)
+{
+  int i = (int)v;
+  return i - (v < (float)i);
+}
+
+// Walks every cell the segment from the previous to the current position
+// touches, in order, and returns the first hit and its cell
+static int sweepProjectile(int i, int *hitX, int *hitY)
+{
+  float x0 = world->projectiles.previousX[i], y0 = world->projectiles.previousY[i];
+  float dx = world->projectiles.x[i] - x0;
+  float dy = world->projectiles.y[i] - y0;
+  int cellX = floorToCell(x0);
+  int cellY = floorToCell(y0);
+  int endX = floorToCell(world->projectiles.x[i]);
+  int endY = floorToCell(world->projectiles.y[i]);
+  int stepX = dx > 0 ? 1 : -1;
+  int stepY = dy > 0 ? 1 : -1;
+  float tDeltaX = dx != 0 ? fabsf(1.0f / dx) : INFINITY;
+  float tDeltaY = dy != 0 ? fabsf(1.0f / dy) : INFINITY;
+  float tMaxX = dx > 0 ? (cellX + 1 - x0) * tDeltaX : (dx < 0 ? (x0 - cellX) * tDeltaX : INFINITY);
+  float tMaxY = dy > 0 ? (cellY + 1 - y0) * tDeltaY : (dy < 0 ? (y0 - cellY) * tDeltaY : INFINITY);
 
-  // Remove dead projectiles
-  for (int i = projectileCount - 1; i >= 0; i--)
+  for (int n = 0; n < MAX_SWEEP_CELLS; n++)
   {
-    if (!projectiles[i].alive)
+    int target = findHitInCell(i, cellX, cellY);
+    if (target != HIT_NONE)
+    {
+      *hitX = cellX;
+      *hitY = cellY;
+      return target;
+    }
+    if (cellX == endX && cellY == endY)
+      break;
+
+    if (tMaxX < tMaxY)
     {
-      projectiles[i] = projectiles[projectileCount - 1];
-      projectileCount--;
+      cellX += stepX;
+      tMaxX += tDeltaX;
     }
+    else
+    {
+      cellY += stepY;
+      tMaxY += tDeltaY;
+    }
+  }
+  return HIT_NONE;
+}
+
+// Integrate: branch-free so the compiler can vectorize it. Projectiles that
+// run out of range or stray too far from the player expire before hitting.
+static void integrateRange(int begin, int end, void *context)
+{
+  (void)context;
+  float *restrict x = world->projectiles.x;
+  float *restrict y = world->projectiles.y;
+  float *restrict previousX = world->projectiles.previousX;
+  float *restrict previousY = world->projectiles.previousY;
+  const float *restrict dx = world->projectiles.dx;
+  const float *restrict dy = world->projectiles.dy;
+  const float *restrict speed = world->projectiles.speed;
+  float *restrict range = world->projectiles.range;
+  const float *restrict maxRange = world->projectiles.maxRange;
+  unsigned char *restrict alive = world->projectiles.alive;
+  float playerX = world->player.x + 0.5f;
+  float playerY = world->player.y + 0.5f;
+  float despawn2 = (float)PROJECTILE_DESPAWN_DISTANCE * PROJECTILE_DESPAWN_DISTANCE;
+
+  for (int i = begin; i < end; i++)
+  {
+    previousX[i] = x[i];
+    previousY[i] = y[i];
+    x[i] += dx[i] * speed[i];
+    y[i] += dy[i] * speed[i];
+    range[i] += speed[i];
+
+    float ox = x[i] - playerX;
+    float oy = y[i] - playerY;
+    alive[i] &= (range[i] < maxRange[i]) & (ox * ox + oy * oy <= despawn2);
   }
 }
 
-void drawProjectiles()
+static void sweepRange(int begin, int end, void *context)
+{
+  (void)context;
+  for (int i = begin; i < end; i++)
+    world->sweepTarget[i] = world->projectiles.alive[i] ? sweepProjectile(i, &world->sweepCellX[i], &world->sweepCellY[i]) : HIT_NONE;
+}
+
+// Job wrappers for updateProjectiles: data points at the item count
+static void integrateJob(void *data)
 {
-  for (int i = 0; i < projectileCount; i++)
+  parallelFor(*(int *)data, PROJECTILE_JOB_GRAIN, integrateRange, NULL);
+}
+
+static void buildGridJob(void *data)
+{
+  (void)data;
+  buildMonsterGrid();
+}
+
+static void sweepJob(void *data)
+{
+  parallelFor(*(int *)data, PROJECTILE_JOB_GRAIN, sweepRange, NULL);
+}
+
+void updateProjectiles()
+{
+  double updateStart = platformTimer();
+  int count = world->projectiles.count;
+
+  // Swept hit test against the player and the monster grid
+  int hits = 0;
+  int swept = count;
+  world->sweepTarget = frameAlloc(sizeof(int) * 3 * (size_t)count);
+  if (world->sweepTarget == NULL)
+    swept = 0; // Out of memory: no hits this tick
+  else
+  {
+    world->sweepCellX = world->sweepTarget + count;
+    world->sweepCellY = world->sweepCellX + count;
+  }
+
+  // Integration only touches projectiles and the grid build only monsters,
+  // so the serial grid build runs beside the integration ranges; the sweep
+  // starts once both are done
+  JobCounter moved = {0};
+  JobCounter sweepDone = {0};
+  runJob(integrateJob, &count, &moved);
+  runJob(buildGridJob, NULL, &moved);
+  runJobAfter(&moved, sweepJob, &swept, &sweepDone);
+  waitForJobs(&sweepDone);
+
+  for (int i = 0; i < swept; i++)
   {
-    if (!projectiles[i].alive)
+    int target = world->sweepTarget[i];
+    if (target == HIT_NONE)
       continue;
 
-    int textureIndex = 6 + projectiles[i].type; // 6=lightning, 7=fireball, 8=arrow
-    if (projectiles[i].type == 2)
-      textureIndex = 8; // Arrow uses texture 8
-
-    // Draw all projectiles at 10x10 pixels (half tile size)
-    Rectangle sourceRect = {0, 0, textures[textureIndex].width, textures[textureIndex].height};
-    Rectangle destRect = {
-        projectiles[i].x * CELL_SIZE - camera.target.x + WINDOW_SIZE / 2,
-        projectiles[i].y * CELL_SIZE - camera.target.y + WINDOW_SIZE / 2,
-        CELL_SIZE / 2.0f, // 10x10 pixels
-        CELL_SIZE / 2.0f  // 10x10 pixels
-    };
-    Vector2 origin = {CELL_SIZE / 4.0f, CELL_SIZE / 4.0f}; // Center the smaller sprite
-    DrawTexturePro(textures[textureIndex], sourceRect, destRect, origin, 0.0f, WHITE);
+    // An earlier projectile may have killed this one's target this tick
+    if (target != HIT_PLAYER && !world->monsters[target].alive)
+      target = sweepProjectile(i, &world->sweepCellX[i], &world->sweepCellY[i]);
+    if (target == HIT_NONE)
+      continue;
+
+    if (target == HIT_PLAYER)
+      hitPlayer(i);
+    else
+      hitMonster(i, target);
+    scorchTerrain(i, world->sweepCellX[i], world->sweepCellY[i]);
+    world->projectiles.alive[i] = 0; // Remove projectile after hitting
+    hits++;
+  }
+
+  // Remove dead projectiles (swap with the last live one)
+  for (int i = count - 1; i >= 0; i--)
+  {
+    if (!world->projectiles.alive[i])
+    {
+      int last = --count;
+      world->projectiles.x[i] = world->projectiles.x[last];
+      world->projectiles.y[i] = world->projectiles.y[last];
+      world->projectiles.previousX[i] = world->projectiles.previousX[last];
+      world->projectiles.previousY[i] = world->projectiles.previousY[last];
+      world->projectiles.dx[i] = world->projectiles.dx[last];
+      world->projectiles.dy[i] = world->projectiles.dy[last];
+      world->projectiles.speed[i] = world->projectiles.speed[last];
+      world->projectiles.range[i] = world->projectiles.range[last];
+      world->projectiles.maxRange[i] = world->projectiles.maxRange[last];
+      world->projectiles.type[i] = world->projectiles.type[last];
+      world->projectiles.effect[i] = world->projectiles.effect[last];
+      world->projectiles.damage[i] = world->projectiles.damage[last];
+      world->projectiles.owner[i] = world->projectiles.owner[last];
+      world->projectiles.alive[i] = world->projectiles.alive[last];
+    }
+  }
+  world->projectiles.count = count;
+
+  world->projectileStats.hits += hits;
+  world->projectileStats.lastUpdateMs = (platformTimer() - updateStart) * 1000.0;
+}
+
+// Columns are streamed up to the live count; restoring grows the pool first
+void streamProjectileState(StateStream *stream)
+{
+  stateBlock(stream, &world->projectiles.count, sizeof(world->projectiles.count));
+  while (stream->restoring && world->projectiles.capacity < world->projectiles.count)
+  {
+    if (!growProjectilePool())
+    {
+      // Projectiles are lost; skip over them
+      stream->offset += (size_t)world->projectiles.count * PROJECTILE_BYTES;
+      world->projectiles.count = 0;
+      return;
+    }
   }
+
+  int count = world->projectiles.count;
+  stateBlock(stream, world->projectiles.x, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.y, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.previousX, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.previousY, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.dx, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.dy, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.speed, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.range, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.maxRange, sizeof(float) * count);
+  stateBlock(stream, world->projectiles.type, sizeof(int) * count);
+  stateBlock(stream, world->projectiles.effect, sizeof(int) * count);
+  stateBlock(stream, world->projectiles.damage, sizeof(int) * count);
+  stateBlock(stream, world->projectiles.owner, sizeof(int) * count);
+  stateBlock(stream, world->projectiles.alive, sizeof(unsigned char) * count);
 }
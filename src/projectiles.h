@@ -2,10 +2,26 @@
 #define PROJECTILES_H
 
 #include "types.h"
+#include <stddef.h>
+
+#define PROJECTILE_GRID_RADIUS 56 // Despawn distance + longest step + hit radius
+#define PROJECTILE_GRID_DIM (PROJECTILE_GRID_RADIUS * 2 + 1)
+#define PROJECTILE_GRID_CELLS (PROJECTILE_GRID_DIM * PROJECTILE_GRID_DIM)
+#define PROJECTILE_GRID_ENTRIES (MAX_MONSTERS * 9)
+
+// Projectile engine statistics
+typedef struct
+{
+  int hits;            // Projectiles that hit something so far
+  double lastUpdateMs; // Wall time of the most recent updateProjectiles
+} ProjectileStats;
 
 // Function declarations for projectile management
-void spawnProjectile(int x, int y, float dx, float dy, int type, int damage);
+void spawnProjectile(int x, int y, float dx, float dy, int type, int damage, int owner);
+void clearProjectiles();
 void updateProjectiles();
-void drawProjectiles();
+void trimProjectilePool();
+void freeProjectilePool();
+size_t projectileMemoryUsed();
 
 #endif
@@ -0,0 +1,540 @@
+#include "types.h"
+#include "globals.h"
+#include "render.h"
+#include "snapshot.h"
+#include "lighting.h"
+#include "rlgl.h"
+#include <stdlib.h>
+#include <math.h>
+
+// Everything that draws the world. The simulation modules never call into
+// the graphics API, so they also build without a window (gridlock-headless).
+// Drawing reads only the WorldSnapshot it is given, never live game state:
+// the simulation thread keeps running while a frame is drawn.
+
+#define NIGHT_DARKNESS 210    // Overlay alpha of a completely unlit cell
+#define TERRAIN_ALPHA 220     // Terrain is drawn slightly see-through over the background
+#define TERRAIN_TILE_CACHE 32 // Baked chunk textures kept (the view needs at most SNAPSHOT_VIEW_CHUNKS^2)
+
+RenderStats renderStats = {0};
+
+// Night overlay: one texel per cell of the snapshot view, and the levels it
+// was last uploaded with
+static Texture2D lightTexture = {0};
+static unsigned char uploadedLight[SNAPSHOT_VIEW_CELLS][SNAPSHOT_VIEW_CELLS];
+static int uploadedViewX = 0, uploadedViewY = 0;
+static int uploadedValid = 0;
+
+// Terrain: one texture per chunk, one texel per cell, baked from the
+// snapshot's copy and redrawn with a single quad. A tile is rebaked only when
+// its chunk's revision moves on (load, flushed edits); the least recently
+// drawn tile is reused for a chunk that has none.
+typedef struct
+{
+  int chunkX, chunkY;
+  int revision;
+  int baked;             // Holds this chunk's terrain at revision
+  unsigned int lastUsed; // Frame it was last drawn
+  Texture2D texture;
+} TerrainTile;
+
+static TerrainTile terrainTiles[TERRAIN_TILE_CACHE];
+static unsigned int terrainFrame = 0;
+
+// Cell grid: one cell's worth of lines in a repeating texture, drawn as a
+// single quad over the camera however many cells it covers (G toggles)
+static Texture2D gridTexture = {0};
+static int gridVisible = 1;
+
+// Pixel position between a character's last two simulation steps. Jumps
+// (jump smash, respawn) snap instead of sliding across the map.
+Vector2 interpolatedPosition(int x, int y, int previousX, int previousY)
+{
+  int dx = x - previousX;
+  int dy = y - previousY;
+  if (abs(dx) > 1 || abs(dy) > 1)
+    return (Vector2){x * CELL_SIZE, y * CELL_SIZE};
+
+  return (Vector2){(previousX + dx * renderAlpha) * CELL_SIZE,
+                   (previousY + dy * renderAlpha) * CELL_SIZE};
+}
+
+static Color terrainColor(int terrainType)
+{
+  switch (terrainType)
+  {
+  case 0:
+    return (Color){80, 140, 80, 255}; // Grass
+  case 1:
+    return (Color){140, 110, 80, 255}; // Mountain
+  case 2:
+    return (Color){50, 110, 50, 255}; // Tree
+  case 3:
+    return (Color){80, 140, 200, 255}; // Lake
+  case 4:
+    return (Color){50, 80, 140, 255}; // Sea
+  case 5:
+    return (Color){105, 95, 80, 255}; // Crater
+  case 6:
+    return (Color){60, 55, 45, 255}; // Burnt tree
+  case 7:
+    return (Color){200, 80, 30, 255}; // Burning tree
+  default:
+    return (Color){80, 140, 80, 255}; // Default (and unloaded)
+  }
+}
+
+// The cached tile for a chunk, rebaked if the chunk changed since
+static Texture2D terrainTile(const SnapshotChunk *chunk)
+{
+  static Color texels[CHUNK_SIZE * CHUNK_SIZE];
+
+  TerrainTile *tile = NULL;
+  for (int i = 0; i < TERRAIN_TILE_CACHE && tile == NULL; i++)
+  {
+    if (terrainTiles[i].baked && terrainTiles[i].chunkX == chunk->chunkX && terrainTiles[i].chunkY == chunk->chunkY)
+      tile = &terrainTiles[i];
+  }
+  if (tile == NULL)
+  {
+    tile = &terrainTiles[0];
+    for (int i = 1; i < TERRAIN_TILE_CACHE && tile->baked; i++)
+    {
+      if (!terrainTiles[i].baked || terrainTiles[i].lastUsed < tile->lastUsed)
+        tile = &terrainTiles[i];
+    }
+    tile->baked = 0;
+  }
+  tile->lastUsed = terrainFrame;
+  if (tile->baked && tile->revision == chunk->revision)
+    return tile->texture;
+
+  for (int y = 0; y < CHUNK_SIZE; y++)
+  {
+    for (int x = 0; x < CHUNK_SIZE; x++)
+    {
+      Color color = terrainColor(chunk->terrain[x][y]);
+      color.a = TERRAIN_ALPHA;
+      texels[y * CHUNK_SIZE + x] = color;
+    }
+  }
+  if (tile->texture.id == 0)
+  {
+    Image image = {texels, CHUNK_SIZE, CHUNK_SIZE, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    tile->texture = LoadTextureFromImage(image);
+  }
+  else
+    UpdateTexture(tile->texture, texels);
+
+  tile->chunkX = chunk->chunkX;
+  tile->chunkY = chunk->chunkY;
+  tile->revision = chunk->revision;
+  tile->baked = 1;
+  renderStats.terrainTilesBaked++;
+  return tile->texture;
+}
+
+// Terrain under the camera: a quad per chunk, grass where no chunk is loaded
+static void drawTerrain(const WorldSnapshot *snapshot, int camLeft, int camRight, int camTop, int camBottom)
+{
+  terrainFrame++;
+  renderStats.terrainTilesBaked = 0;
+
+  int firstChunkX = (int)floorf((float)camLeft / CHUNK_SIZE);
+  int lastChunkX = (int)floorf((float)camRight / CHUNK_SIZE);
+  int firstChunkY = (int)floorf((float)camTop / CHUNK_SIZE);
+  int lastChunkY = (int)floorf((float)camBottom / CHUNK_SIZE);
+  for (int chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++)
+  {
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++)
+    {
+      const SnapshotChunk *chunk = NULL;
+      for (int i = 0; i < snapshot->chunkCount && chunk == NULL; i++)
+      {
+        if (snapshot->chunks[i].chunkX == chunkX && snapshot->chunks[i].chunkY == chunkY)
+          chunk = &snapshot->chunks[i];
+      }
+
+      Rectangle dest = {chunkX * CHUNK_SIZE * CELL_SIZE, chunkY * CHUNK_SIZE * CELL_SIZE,
+                        CHUNK_SIZE * CELL_SIZE, CHUNK_SIZE * CELL_SIZE};
+      if (chunk == NULL)
+      {
+        Color grass = terrainColor(0);
+        grass.a = TERRAIN_ALPHA;
+        DrawRectangleRec(dest, grass);
+        continue;
+      }
+      Rectangle source = {0, 0, CHUNK_SIZE, CHUNK_SIZE};
+      DrawTexturePro(terrainTile(chunk), source, dest, (Vector2){0, 0}, 0.0f, WHITE);
+    }
+  }
+}
+
+void toggleGrid()
+{
+  gridVisible = !gridVisible;
+}
+
+static void drawGrid(int camLeft, int camRight, int camTop, int camBottom)
+{
+  if (!gridVisible)
+    return;
+
+  if (gridTexture.id == 0)
+  {
+    // The top and left edge of a cell, where DrawLineV used to put the lines
+    Image image = GenImageColor(CELL_SIZE, CELL_SIZE, BLANK);
+    ImageDrawLine(&image, 0, 0, CELL_SIZE, 0, LIGHTGRAY);
+    ImageDrawLine(&image, 0, 0, 0, CELL_SIZE, LIGHTGRAY);
+    gridTexture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureWrap(gridTexture, TEXTURE_WRAP_REPEAT);
+  }
+
+  // Source coordinates past the texture's size repeat it once per cell
+  float width = (camRight - camLeft) * CELL_SIZE;
+  float height = (camBottom - camTop) * CELL_SIZE;
+  Rectangle source = {0, 0, width, height};
+  Rectangle dest = {camLeft * CELL_SIZE, camTop * CELL_SIZE, width, height};
+  DrawTexturePro(gridTexture, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
+void drawWorld(const WorldSnapshot *snapshot)
+{
+  // Get camera bounds to determine what to draw
+  int camLeft = (camera.target.x - WINDOW_SIZE / 2) / CELL_SIZE - 1;
+  int camRight = (camera.target.x + WINDOW_SIZE / 2) / CELL_SIZE + 1;
+  int camTop = (camera.target.y - WINDOW_SIZE / 2) / CELL_SIZE - 1;
+  int camBottom = (camera.target.y + WINDOW_SIZE / 2) / CELL_SIZE + 1;
+
+  drawTerrain(snapshot, camLeft, camRight, camTop, camBottom);
+
+  drawGrid(camLeft, camRight, camTop, camBottom);
+
+  // Draw landmines
+  const Landmine *landmines = snapshot->landmines;
+  for (int i = 0; i < snapshot->landmineCount; i++)
+  {
+    if (landmines[i].active)
+    {
+      DrawCircle(landmines[i].x * CELL_SIZE + CELL_SIZE / 2,
+                 landmines[i].y * CELL_SIZE + CELL_SIZE / 2,
+                 CELL_SIZE / 4, RED);
+    }
+  }
+
+  // Draw powerups
+  const Powerup *powerups = snapshot->powerups;
+  for (int i = 0; i < snapshot->powerupCount; i++)
+  {
+    if (powerups[i].active)
+    {
+      Color color;
+      switch (powerups[i].type)
+      {
+      case POWERUP_DOUBLE_DAMAGE:
+        color = ORANGE;
+        break;
+      case POWERUP_DOUBLE_HEALTH:
+        color = GREEN;
+        break;
+      case POWERUP_DOUBLE_SPEED:
+        color = BLUE;
+        break;
+      default:
+        color = WHITE;
+        break;
+      }
+      DrawCircle(powerups[i].x * CELL_SIZE + CELL_SIZE / 2,
+                 powerups[i].y * CELL_SIZE + CELL_SIZE / 2,
+                 CELL_SIZE / 3, color);
+    }
+  }
+
+  // Draw monsters (the snapshot only holds living ones)
+  for (int i = 0; i < snapshot->visibleMonsterCount; i++)
+  {
+    const SnapshotMonster *monster = &snapshot->monsters[i];
+    Vector2 position = interpolatedPosition(monster->x, monster->y, monster->previousX, monster->previousY);
+    float screenX = position.x - camera.target.x + camera.offset.x;
+    float screenY = position.y - camera.target.y + camera.offset.y;
+
+    if (screenX >= -CELL_SIZE && screenX <= WINDOW_SIZE + CELL_SIZE &&
+        screenY >= -CELL_SIZE && screenY <= WINDOW_SIZE + CELL_SIZE)
+    {
+      DrawTextureEx(textures[monster->textureIndex], position, 0, CELL_SIZE / 72.0f, WHITE);
+
+      // Health bar
+      DrawRectangle(position.x, position.y - 5, CELL_SIZE, 3, RED);
+      DrawRectangle(position.x, position.y - 5,
+                    (float)monster->health / monster->maxHealth * CELL_SIZE, 3, GREEN);
+    }
+  }
+
+  // Draw player
+  const Character *player = &snapshot->player;
+  if (player->alive)
+  {
+    Color playerColor = WHITE;
+    if (player->invulnerabilityTimer > 0)
+    {
+      if ((player->invulnerabilityTimer / 10) % 2 == 0)
+      {
+        playerColor = YELLOW;
+      }
+      else
+      {
+        playerColor = Fade(WHITE, 0.3f);
+      }
+    }
+
+    Vector2 position = interpolatedPosition(player->x, player->y, player->previousX, player->previousY);
+    DrawTextureEx(textures[player->textureIndex], position, 0, CELL_SIZE / 72.0f, playerColor);
+
+    // Health bar
+    DrawRectangle(position.x, position.y - 5, CELL_SIZE, 3, RED);
+    DrawRectangle(position.x, position.y - 5,
+                  (float)player->health / player->maxHealth * CELL_SIZE, 3, GREEN);
+  }
+}
+
+void drawMinimap(const WorldSnapshot *snapshot)
+{
+  int minimapSize = MINIMAP_SIZE;
+  int minimapX = WINDOW_SIZE - minimapSize - 10;
+  int minimapY = WINDOW_SIZE - minimapSize - 10;
+  int minimapScale = MINIMAP_SCALE;
+  const Character *player = &snapshot->player;
+
+  // Draw minimap background
+  DrawRectangle(minimapX, minimapY, minimapSize, minimapSize, (Color){0, 0, 0, 180});
+  DrawRectangleLines(minimapX, minimapY, minimapSize, minimapSize, WHITE);
+
+  // Draw terrain on minimap (sampled by the simulation, one cell per pixel)
+  for (int x = 0; x < minimapSize; x++)
+  {
+    for (int y = 0; y < minimapSize; y++)
+    {
+      if (snapshot->minimap[x][y] != SNAPSHOT_UNLOADED)
+        DrawRectangle(minimapX + x, minimapY + y, 1, 1, terrainColor(snapshot->minimap[x][y]));
+    }
+  }
+
+  // Draw player on minimap
+  int playerMinimapX = minimapX + (minimapSize / 2);
+  int playerMinimapY = minimapY + (minimapSize / 2);
+  DrawRectangle(playerMinimapX - 1, playerMinimapY - 1, 3, 3, YELLOW);
+
+  // Draw monsters on minimap
+  const SnapshotMonster *monsters = snapshot->monsters;
+  for (int i = 0; i < snapshot->visibleMonsterCount; i++)
+  {
+    int monsterMinimapX = minimapX + (minimapSize / 2) + ((monsters[i].x - player->x) / minimapScale);
+    int monsterMinimapY = minimapY + (minimapSize / 2) + ((monsters[i].y - player->y) / minimapScale);
+
+    if (monsterMinimapX >= minimapX && monsterMinimapX < minimapX + minimapSize &&
+        monsterMinimapY >= minimapY && monsterMinimapY < minimapY + minimapSize)
+    {
+      DrawRectangle(monsterMinimapX, monsterMinimapY, 1, 1, RED);
+    }
+  }
+
+  // Draw powerups on minimap
+  const Powerup *powerups = snapshot->powerups;
+  for (int i = 0; i < snapshot->powerupCount; i++)
+  {
+    int powerupMinimapX = minimapX + (minimapSize / 2) + ((powerups[i].x - player->x) / minimapScale);
+    int powerupMinimapY = minimapY + (minimapSize / 2) + ((powerups[i].y - player->y) / minimapScale);
+
+    if (powerupMinimapX >= minimapX && powerupMinimapX < minimapX + minimapSize &&
+        powerupMinimapY >= minimapY && powerupMinimapY < minimapY + minimapSize)
+    {
+      DrawRectangle(powerupMinimapX, powerupMinimapY, 1, 1, GREEN);
+    }
+  }
+
+  // Draw landmines on minimap
+  const Landmine *landmines = snapshot->landmines;
+  for (int i = 0; i < snapshot->landmineCount; i++)
+  {
+    int landmineMinimapX = minimapX + (minimapSize / 2) + ((landmines[i].x - player->x) / minimapScale);
+    int landmineMinimapY = minimapY + (minimapSize / 2) + ((landmines[i].y - player->y) / minimapScale);
+
+    if (landmineMinimapX >= minimapX && landmineMinimapX < minimapX + minimapSize &&
+        landmineMinimapY >= minimapY && landmineMinimapY < minimapY + minimapSize)
+    {
+      DrawRectangle(landmineMinimapX, landmineMinimapY, 1, 1, ORANGE);
+    }
+  }
+}
+
+void drawProjectiles(const WorldSnapshot *snapshot)
+{
+  // Visible world area in cells (drawn inside BeginMode2D, so positions are world pixels)
+  float viewLeft = (camera.target.x - camera.offset.x / camera.zoom) / CELL_SIZE - 1;
+  float viewTop = (camera.target.y - camera.offset.y / camera.zoom) / CELL_SIZE - 1;
+  float viewRight = viewLeft + WINDOW_SIZE / camera.zoom / CELL_SIZE + 2;
+  float viewBottom = viewTop + WINDOW_SIZE / camera.zoom / CELL_SIZE + 2;
+
+  for (int i = 0; i < snapshot->visibleProjectileCount; i++)
+  {
+    // Drawn between the last two simulation steps
+    const SnapshotProjectile *projectile = &snapshot->projectiles[i];
+    float drawX = projectile->previousX + (projectile->x - projectile->previousX) * renderAlpha;
+    float drawY = projectile->previousY + (projectile->y - projectile->previousY) * renderAlpha;
+    if (drawX < viewLeft || drawX > viewRight || drawY < viewTop || drawY > viewBottom)
+      continue;
+
+    int textureIndex = 6 + projectile->type; // 6=lightning, 7=fireball, 8=arrow
+
+    // Draw all projectiles at 10x10 pixels (half tile size), centred on their position
+    Rectangle sourceRect = {0, 0, textures[textureIndex].width, textures[textureIndex].height};
+    Rectangle destRect = {
+        drawX * CELL_SIZE,
+        drawY * CELL_SIZE,
+        CELL_SIZE / 2.0f, // 10x10 pixels
+        CELL_SIZE / 2.0f  // 10x10 pixels
+    };
+    Vector2 origin = {CELL_SIZE / 4.0f, CELL_SIZE / 4.0f}; // Center the smaller sprite
+    DrawTexturePro(textures[textureIndex], sourceRect, destRect, origin, 0.0f, WHITE);
+  }
+}
+
+// Particles as quads in a single rlBegin/rlEnd on raylib's default white texture
+void drawParticles(const WorldSnapshot *snapshot)
+{
+  // Visible world area in pixels
+  float viewLeft = camera.target.x - camera.offset.x / camera.zoom - CELL_SIZE;
+  float viewTop = camera.target.y - camera.offset.y / camera.zoom - CELL_SIZE;
+  float viewRight = viewLeft + WINDOW_SIZE / camera.zoom + 2 * CELL_SIZE;
+  float viewBottom = viewTop + WINDOW_SIZE / camera.zoom + 2 * CELL_SIZE;
+
+  rlSetTexture(rlGetTextureIdDefault());
+  rlBegin(RL_QUADS);
+  for (int i = 0; i < snapshot->visibleParticleCount; i++)
+  {
+    const SnapshotParticle *particle = &snapshot->particles[i];
+    float x = particle->x;
+    float y = particle->y;
+    if (x < viewLeft || x > viewRight || y < viewTop || y > viewBottom)
+      continue;
+
+    float half = particle->size * 0.5f;
+    Color color = particle->color;
+    rlColor4ub(color.r, color.g, color.b, color.a);
+
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex2f(x - half, y - half);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex2f(x - half, y + half);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex2f(x + half, y + half);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex2f(x + half, y - half);
+  }
+  rlEnd();
+  rlSetTexture(0);
+}
+
+// Uploads the rectangle of overlay texels whose light level changed since
+// the last upload (everything when the view has moved)
+static void uploadLight(const WorldSnapshot *snapshot)
+{
+  static Color texels[SNAPSHOT_VIEW_CELLS * SNAPSHOT_VIEW_CELLS];
+
+  if (lightTexture.id == 0)
+  {
+    Image image = GenImageColor(SNAPSHOT_VIEW_CELLS, SNAPSHOT_VIEW_CELLS, (Color){0, 0, 0, NIGHT_DARKNESS});
+    lightTexture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    uploadedValid = 0;
+  }
+
+  int minX = 0, minY = 0, maxX = SNAPSHOT_VIEW_CELLS - 1, maxY = SNAPSHOT_VIEW_CELLS - 1;
+  if (uploadedValid && uploadedViewX == snapshot->viewX && uploadedViewY == snapshot->viewY)
+  {
+    minX = minY = SNAPSHOT_VIEW_CELLS;
+    maxX = maxY = -1;
+    for (int x = 0; x < SNAPSHOT_VIEW_CELLS; x++)
+    {
+      for (int y = 0; y < SNAPSHOT_VIEW_CELLS; y++)
+      {
+        if (snapshot->light[x][y] == uploadedLight[x][y])
+          continue;
+        if (x < minX)
+          minX = x;
+        if (x > maxX)
+          maxX = x;
+        if (y < minY)
+          minY = y;
+        if (y > maxY)
+          maxY = y;
+      }
+    }
+    if (maxX < 0)
+      return; // Nothing changed
+  }
+
+  int width = maxX - minX + 1;
+  int height = maxY - minY + 1;
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      int level = snapshot->light[minX + x][minY + y];
+      uploadedLight[minX + x][minY + y] = (unsigned char)level;
+      unsigned char alpha = (unsigned char)(NIGHT_DARKNESS * (MAX_LIGHT_LEVEL - (level > MAX_LIGHT_LEVEL ? MAX_LIGHT_LEVEL : level)) / MAX_LIGHT_LEVEL);
+      texels[y * width + x] = (Color){0, 0, 0, alpha};
+    }
+  }
+
+  Rectangle rect = {minX, minY, width, height};
+  UpdateTextureRec(lightTexture, rect, texels);
+  uploadedViewX = snapshot->viewX;
+  uploadedViewY = snapshot->viewY;
+  uploadedValid = 1;
+  renderStats.texelsUploaded += width * height;
+}
+
+// Darkness overlay over the snapshot's view (inside BeginMode2D)
+void drawLighting(const WorldSnapshot *snapshot)
+{
+  renderStats.texelsUploaded = 0;
+  if (!snapshot->nightMode)
+    return;
+
+  uploadLight(snapshot);
+
+  Rectangle source = {0, 0, SNAPSHOT_VIEW_CELLS, SNAPSHOT_VIEW_CELLS};
+  Rectangle dest = {snapshot->viewX * CELL_SIZE, snapshot->viewY * CELL_SIZE,
+                    SNAPSHOT_VIEW_CELLS * CELL_SIZE, SNAPSHOT_VIEW_CELLS * CELL_SIZE};
+  DrawTexturePro(lightTexture, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
+void unloadLighting()
+{
+  if (lightTexture.id != 0)
+  {
+    UnloadTexture(lightTexture);
+    lightTexture.id = 0;
+  }
+}
+
+void unloadGrid()
+{
+  if (gridTexture.id != 0)
+  {
+    UnloadTexture(gridTexture);
+    gridTexture.id = 0;
+  }
+}
+
+void unloadTerrainTiles()
+{
+  for (int i = 0; i < TERRAIN_TILE_CACHE; i++)
+  {
+    if (terrainTiles[i].texture.id != 0)
+      UnloadTexture(terrainTiles[i].texture);
+    terrainTiles[i] = (TerrainTile){0};
+  }
+}
@@ -0,0 +1,29 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "types.h"
+#include "snapshot.h"
+
+// Render statistics (refreshed every frame)
+typedef struct
+{
+  double lastDrawMs;     // Wall time spent drawing the last frame
+  int texelsUploaded;    // Night overlay texels uploaded to the GPU this frame
+  int terrainTilesBaked; // Chunk terrain textures (re)baked this frame
+} RenderStats;
+
+extern RenderStats renderStats;
+
+// Function declarations for drawing (all but drawMinimap go inside BeginMode2D)
+Vector2 interpolatedPosition(int x, int y, int previousX, int previousY);
+void toggleGrid();
+void drawWorld(const WorldSnapshot *snapshot);
+void drawMinimap(const WorldSnapshot *snapshot);
+void drawProjectiles(const WorldSnapshot *snapshot);
+void drawParticles(const WorldSnapshot *snapshot);
+void drawLighting(const WorldSnapshot *snapshot);
+void unloadLighting();
+void unloadTerrainTiles();
+void unloadGrid();
+
+#endif
@@ -0,0 +1,407 @@
+#include "types.h"
+#include "globals.h"
+#include "replay.h"
+#include "fire.h"
+#include "rng.h"
+#include "tunables.h"
+#include "memory.h"
+#include <stdio.h>
+#include <string.h>
+
+// Deterministic input recording and replay. The simulation only changes
+// through its seed and per-tick input, so storing those reproduces a session
+// exactly; a rolling state hash, stored every REPLAY_CHECK_INTERVAL ticks,
+// proves that it did. Every tick folds in a cheap summary (tick, player,
+// entity counts); checkpoint ticks also fold in the full state, which costs
+// about as much as a tick and would double the run time of a benchmark
+// replay if done every tick. Held keys rarely change, so input is delta
+// encoded: one record per change, none for repeats.
+
+#ifndef BUILD_ID
+#define BUILD_ID "unknown" // Set by the Makefile from git
+#endif
+
+#define REPLAY_LENGTH_OFFSET 44 // Header offset of the tick count, filled in when recording stops
+
+static uint64_t hashTickSummary();
+
+static void writeVarint(uint64_t value)
+{
+  do
+  {
+    unsigned char byte = value & 0x7f;
+    value >>= 7;
+    if (value)
+      byte |= 0x80;
+    fputc(byte, world->replayFile);
+    world->replayStats.bytes++;
+  } while (value);
+}
+
+static int readVarint(uint64_t *value)
+{
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    int byte = fgetc(world->replayFile);
+    if (byte == EOF)
+      return 0;
+    world->replayStats.bytes++;
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return 1;
+  }
+  return 0;
+}
+
+// Signed values (click cells) as small unsigned ones
+static uint64_t zigzag(int value)
+{
+  return value < 0 ? ((uint64_t)(-(int64_t)value) << 1) - 1 : (uint64_t)value << 1;
+}
+
+static int unzigzag(uint64_t value)
+{
+  return value & 1 ? (int)-(int64_t)((value + 1) >> 1) : (int)(value >> 1);
+}
+
+static void writeU32(unsigned char *out, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+    out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static uint32_t readU32(const unsigned char *in)
+{
+  return in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+// The tunables go by name, so playback restores them even if the registry
+// has been reordered since (a name this build does not know is skipped)
+static void writeTunables()
+{
+  writeVarint(TUNABLE_COUNT);
+  for (int i = 0; i < TUNABLE_COUNT; i++)
+  {
+    size_t length = strlen(world->tunables[i].name);
+    writeVarint(length);
+    fwrite(world->tunables[i].name, 1, length, world->replayFile);
+    world->replayStats.bytes += (long)length;
+    writeVarint(zigzag(world->tunables[i].value));
+  }
+}
+
+static int readTunables()
+{
+  uint64_t count;
+  if (!readVarint(&count))
+    return 0;
+  for (uint64_t n = 0; n < count; n++)
+  {
+    uint64_t length, value;
+    char name[64];
+    if (!readVarint(&length) || length >= sizeof(name) || fread(name, 1, length, world->replayFile) != length)
+      return 0;
+    name[length] = '\0';
+    world->replayStats.bytes += (long)length;
+    if (!readVarint(&value))
+      return 0;
+
+    int id = findTunable(name);
+    if (id >= 0)
+      setTunable(id, unzigzag(value));
+  }
+  return 1;
+}
+
+static void writeRecordStart(unsigned int tick, RecordKind kind)
+{
+  writeVarint((uint64_t)(tick - world->lastRecordTick) << 2 | kind);
+  world->lastRecordTick = tick;
+}
+
+static void writeCheckpoint(unsigned int tick)
+{
+  writeRecordStart(tick, RECORD_CHECKPOINT);
+  for (int i = 0; i < 8; i++)
+    fputc((int)(world->replayStats.stateHash >> (8 * i)) & 0xff, world->replayFile);
+  world->replayStats.bytes += 8;
+  world->replayStats.checkpoints++;
+}
+
+// Loads the next record into the lookahead (RECORD_NONE at end of file)
+static void readRecord()
+{
+  uint64_t start;
+  world->nextKind = RECORD_NONE;
+  if (!readVarint(&start))
+    return;
+  world->nextTick = world->lastRecordTick + (unsigned int)(start >> 2);
+  world->lastRecordTick = world->nextTick;
+
+  uint64_t value;
+  switch (start & 3)
+  {
+  case RECORD_INPUT:
+    if (!readVarint(&value))
+      return;
+    world->nextMask = (unsigned int)value;
+    if (world->nextMask & INPUT_CLICKED)
+    {
+      uint64_t x, y;
+      if (!readVarint(&x) || !readVarint(&y))
+        return;
+      world->nextClickX = unzigzag(x);
+      world->nextClickY = unzigzag(y);
+    }
+    world->nextKind = RECORD_INPUT;
+    break;
+  case RECORD_CHECKPOINT:
+    world->nextHash = 0;
+    for (int i = 0; i < 8; i++)
+    {
+      int byte = fgetc(world->replayFile);
+      if (byte == EOF)
+        return;
+      world->nextHash |= (uint64_t)byte << (8 * i);
+    }
+    world->replayStats.bytes += 8;
+    world->nextKind = RECORD_CHECKPOINT;
+    break;
+  case RECORD_END:
+    world->nextKind = RECORD_END;
+    break;
+  }
+}
+
+static void resetReplay(ReplayMode mode)
+{
+  world->replayStats = (ReplayStats){mode, 0, 0, 0, -1, 0, 0, 0};
+  world->lastRecordTick = 0;
+  world->currentMask = 0;
+  world->clickX = 0;
+  world->clickY = 0;
+}
+
+int startRecording(const char *path, unsigned int seed)
+{
+  world->replayFile = fopen(path, "wb");
+  if (!world->replayFile)
+    return 0;
+  resetReplay(REPLAY_RECORDING);
+
+  // Header: magic, version, seed, build id, tick count (0 until stopReplay)
+  unsigned char header[REPLAY_LENGTH_OFFSET + 4] = {'G', 'R', 'P', 'L'};
+  writeU32(header + 4, REPLAY_VERSION);
+  writeU32(header + 8, seed);
+  strncpy((char *)header + 12, BUILD_ID, REPLAY_BUILD_ID_SIZE - 1);
+  fwrite(header, 1, sizeof(header), world->replayFile);
+  world->replayStats.bytes = sizeof(header);
+  writeTunables();
+  writeVarint(memoryBudget());
+  return 1;
+}
+
+int startPlayback(const char *path, unsigned int *seed)
+{
+  world->replayFile = fopen(path, "rb");
+  if (!world->replayFile)
+    return 0;
+
+  unsigned char header[REPLAY_LENGTH_OFFSET + 4];
+  uint32_t version = 0;
+  if (fread(header, 1, sizeof(header), world->replayFile) == sizeof(header) && memcmp(header, "GRPL", 4) == 0)
+    version = readU32(header + 4);
+
+  // The recorded run's tunables and memory budget replace whatever this
+  // one was started with
+  int valid = version >= 1 && version <= REPLAY_VERSION;
+  uint64_t budget = 0;
+  if (valid)
+    resetTunables();
+  if (!valid || (version >= 2 && !readTunables()) || (version >= 3 && !readVarint(&budget)))
+  {
+    fclose(world->replayFile);
+    world->replayFile = NULL;
+    return 0;
+  }
+
+  setMemoryBudget((size_t)budget);
+  resetReplay(REPLAY_PLAYING);
+  *seed = readU32(header + 8);
+  world->replayStats.length = readU32(header + REPLAY_LENGTH_OFFSET);
+  world->replayStats.buildMismatch = strncmp((char *)header + 12, BUILD_ID, REPLAY_BUILD_ID_SIZE) != 0;
+  world->replayStats.bytes = ftell(world->replayFile);
+  readRecord();
+  return 1;
+}
+
+void stopReplay()
+{
+  if (!world->replayFile)
+    return;
+
+  if (world->replayStats.mode == REPLAY_RECORDING)
+  {
+    // Close with the final state, unless the last tick was a checkpoint
+    unsigned int tick = world->replayStats.tick;
+    if (tick > 0 && tick % REPLAY_CHECK_INTERVAL != 0)
+    {
+      world->replayStats.stateHash = rngMix64(world->replayStats.stateHash ^ hashSimulationState());
+      writeCheckpoint(tick - 1);
+    }
+    writeRecordStart(tick, RECORD_END);
+
+    unsigned char length[4];
+    writeU32(length, tick);
+    fseek(world->replayFile, REPLAY_LENGTH_OFFSET, SEEK_SET);
+    fwrite(length, 1, sizeof(length), world->replayFile);
+  }
+
+  fclose(world->replayFile);
+  world->replayFile = NULL;
+  if (world->replayStats.mode == REPLAY_PLAYING)
+    world->replayStats.mode = REPLAY_FINISHED;
+  else if (world->replayStats.mode == REPLAY_RECORDING)
+    world->replayStats.mode = REPLAY_OFF;
+}
+
+// Records this tick's input, or replaces it with the recorded one
+void replayInput(InputState *state)
+{
+  unsigned int tick = world->replayStats.tick;
+
+  if (world->replayStats.mode == REPLAY_RECORDING)
+  {
+    unsigned int mask = inputMask(state);
+
+    // A click always gets a record: the cell may differ from the last one
+    if (mask != world->currentMask || state->clicked)
+    {
+      writeRecordStart(tick, RECORD_INPUT);
+      writeVarint(mask);
+      if (state->clicked)
+      {
+        writeVarint(zigzag(state->clickX));
+        writeVarint(zigzag(state->clickY));
+      }
+      world->currentMask = mask;
+    }
+  }
+  else if (world->replayStats.mode == REPLAY_PLAYING)
+  {
+    while (world->nextKind == RECORD_INPUT && world->nextTick == tick)
+    {
+      world->currentMask = world->nextMask;
+      world->clickX = world->nextClickX;
+      world->clickY = world->nextClickY;
+      readRecord();
+    }
+
+    inputFromMask(state, world->currentMask, world->clickX, world->clickY);
+  }
+}
+
+// Folds this tick's state into the rolling hash, then stores or checks it
+void replayEndTick()
+{
+  if (world->replayStats.mode != REPLAY_RECORDING && world->replayStats.mode != REPLAY_PLAYING)
+    return;
+
+  unsigned int tick = world->replayStats.tick;
+  world->replayStats.stateHash = rngMix64(world->replayStats.stateHash ^ hashTickSummary());
+
+  if (world->replayStats.mode == REPLAY_RECORDING)
+  {
+    if ((tick + 1) % REPLAY_CHECK_INTERVAL == 0)
+    {
+      world->replayStats.stateHash = rngMix64(world->replayStats.stateHash ^ hashSimulationState());
+      writeCheckpoint(tick);
+      fflush(world->replayFile); // A crashed session still leaves a usable replay
+    }
+  }
+  else
+  {
+    if (world->nextKind == RECORD_CHECKPOINT && world->nextTick == tick)
+    {
+      world->replayStats.stateHash = rngMix64(world->replayStats.stateHash ^ hashSimulationState());
+      if (world->nextHash != world->replayStats.stateHash && world->replayStats.divergedTick < 0)
+        world->replayStats.divergedTick = (int)tick;
+      world->replayStats.checkpoints++;
+      readRecord();
+    }
+
+    // Anything left for this tick or earlier means the file is damaged
+    if ((world->nextKind == RECORD_INPUT || world->nextKind == RECORD_CHECKPOINT) && world->nextTick <= tick)
+    {
+      if (world->replayStats.divergedTick < 0)
+        world->replayStats.divergedTick = (int)tick;
+      world->nextKind = RECORD_NONE;
+    }
+  }
+
+  world->replayStats.tick++;
+  if (world->replayStats.mode == REPLAY_PLAYING && (world->nextKind == RECORD_NONE || world->nextKind == RECORD_END) &&
+      world->replayStats.tick >= world->nextTick)
+    stopReplay();
+}
+
+// Four independent multiply lanes over 32-byte blocks, so hashing every
+// tick stays cheap next to the tick itself
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = data;
+  uint64_t lanes[4] = {hash, hash ^ 0x9e3779b97f4a7c15ULL, hash + size, ~hash};
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32)
+  {
+    uint64_t words[4];
+    memcpy(words, bytes + i, 32);
+    for (int lane = 0; lane < 4; lane++)
+      lanes[lane] = (lanes[lane] ^ words[lane]) * 0x100000001b3ULL;
+  }
+  for (; i < size; i++)
+    lanes[0] = (lanes[0] ^ bytes[i]) * 0x100000001b3ULL;
+  return rngMix64(lanes[0] ^ rngMix64(lanes[1] ^ rngMix64(lanes[2] ^ rngMix64(lanes[3]))));
+}
+
+// The part of the state that is cheap to hash every tick
+static uint64_t hashTickSummary()
+{
+  int counts[6] = {world->monsterCount, world->powerupCount, world->landmineCount, world->projectiles.count, world->loadedChunkCount,
+                   getBurningCellCount()};
+  uint64_t hash = hashBytes(0xcbf29ce484222325ULL, &world->gameTick, sizeof(world->gameTick));
+  hash = hashBytes(hash, &world->player, sizeof(world->player));
+  return hashBytes(hash, counts, sizeof(counts));
+}
+
+// Hash of everything that decides what happens next: entities, projectiles,
+// loaded chunks and their edits (terrain itself follows from the seed)
+uint64_t hashSimulationState()
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hash = hashBytes(hash, &world->gameTick, sizeof(world->gameTick));
+  hash = hashBytes(hash, &world->player, sizeof(world->player));
+  hash = hashBytes(hash, world->monsters, sizeof(world->monsters[0]) * world->monsterCount);
+  hash = hashBytes(hash, world->powerups, sizeof(world->powerups[0]) * world->powerupCount);
+  hash = hashBytes(hash, world->landmines, sizeof(world->landmines[0]) * world->landmineCount);
+
+  int count = world->projectiles.count;
+  hash = hashBytes(hash, &count, sizeof(count));
+  hash = hashBytes(hash, world->projectiles.x, sizeof(float) * count);
+  hash = hashBytes(hash, world->projectiles.y, sizeof(float) * count);
+  hash = hashBytes(hash, world->projectiles.range, sizeof(float) * count);
+  hash = hashBytes(hash, world->projectiles.type, sizeof(int) * count);
+  hash = hashBytes(hash, world->projectiles.damage, sizeof(int) * count);
+  hash = hashBytes(hash, world->projectiles.owner, sizeof(int) * count);
+
+  for (int i = 0; i < world->loadedChunkCount; i++)
+  {
+    const Chunk *chunk = &world->loadedChunks[i];
+    int key[4] = {chunk->loaded, chunk->chunkX, chunk->chunkY, chunk->revision};
+    hash = hashBytes(hash, key, sizeof(key));
+  }
+
+  int burning = getBurningCellCount();
+  return hashBytes(hash, &burning, sizeof(burning));
+}
@@ -0,0 +1,61 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "types.h"
+#include "input.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// Replay file: a small header (magic, version, seed, build id, tick count),
+// the tunables the run used (count, then name and value for each), the
+// memory budget in bytes (0 = none), then a
+// stream of records. Each record starts with a varint holding the
+// ticks since the previous record and the record kind:
+//   input       the input mask changed this tick (plus the click cell)
+//   checkpoint  rolling state hash after this tick
+//   end         the recording stopped here
+// A tick with no input record repeats the previous tick's input exactly.
+#define REPLAY_VERSION 3 // Version 1 had no tunables (they were the defaults), 2 no memory budget
+#define REPLAY_CHECK_INTERVAL 60 // Ticks between stored state hashes
+#define REPLAY_BUILD_ID_SIZE 32
+
+typedef enum
+{
+  REPLAY_OFF,
+  REPLAY_RECORDING,
+  REPLAY_PLAYING,
+  REPLAY_FINISHED, // Playback reached the end; input is live again
+} ReplayMode;
+
+// Replay statistics (refreshed every tick)
+typedef struct
+{
+  ReplayMode mode;
+  unsigned int tick;   // Ticks recorded or played so far
+  unsigned int length; // Ticks in the replay being played (0 = unknown)
+  int checkpoints;     // State hashes written or verified
+  int divergedTick;    // First checkpoint that did not match (-1 = none)
+  int buildMismatch;   // Replay was recorded by a different build
+  long bytes;          // Replay file size so far
+  uint64_t stateHash;  // Rolling hash of every tick's state so far
+} ReplayStats;
+
+typedef enum
+{
+  RECORD_INPUT,
+  RECORD_CHECKPOINT,
+  RECORD_END,
+  RECORD_NONE, // End of file
+} RecordKind;
+
+// Function declarations for input recording and replay. Recording and
+// playback start before initGame (playback hands back the recorded seed);
+// simulationTick calls replayInput and replayEndTick around each tick.
+int startRecording(const char *path, unsigned int seed);
+int startPlayback(const char *path, unsigned int *seed);
+void stopReplay();
+void replayInput(InputState *state);
+void replayEndTick();
+uint64_t hashSimulationState();
+
+#endif
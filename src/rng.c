@@ -0,0 +1,50 @@
+#include "rng.h"
+#include "globals.h"
+#include "savestate.h"
+
+// Seeds for every random stream. The world seed fixes the terrain for the
+// whole run; each new game (start or restart) derives fresh seeds for the
+// rest from it and its game number, so a run replays exactly from its seed.
+
+static void deriveSeeds()
+{
+  uint64_t gameSeed = rngDerive(world->worldSeed, world->gameNumber);
+  for (int domain = 0; domain < RNG_DOMAIN_COUNT; domain++)
+    world->domainSeeds[domain] = rngDerive(gameSeed, (uint64_t)domain);
+  world->domainSeeds[RNG_TERRAIN] = rngDerive(world->worldSeed, RNG_TERRAIN);
+}
+
+void seedRandom(unsigned int seed)
+{
+  world->worldSeed = rngMix64((uint64_t)seed + 0x9e3779b97f4a7c15ULL);
+  world->gameNumber = 0;
+  deriveSeeds();
+}
+
+void reseedGame()
+{
+  world->gameNumber++;
+  deriveSeeds();
+}
+
+uint64_t rngSeed(RngDomain domain)
+{
+  return world->domainSeeds[domain];
+}
+
+unsigned int rngGameNumber()
+{
+  return world->gameNumber;
+}
+
+void setRngGameNumber(unsigned int game)
+{
+  world->gameNumber = game;
+}
+
+void streamRandomState(StateStream *stream)
+{
+  stateBlock(stream, &world->worldSeed, sizeof(world->worldSeed));
+  stateBlock(stream, &world->gameNumber, sizeof(world->gameNumber));
+  stateBlock(stream, world->domainSeeds, sizeof(world->domainSeeds));
+}
@@ -0,0 +1,85 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Counter-based random numbers: every value is a pure function of
+// (seed, stream, counter), so results never depend on call order or on
+// which thread asks. Streams are typically entity ids, counters frame numbers.
+
+// splitmix64 finalizer
+static inline uint64_t rngMix64(uint64_t z)
+{
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static inline uint32_t rngAt(uint64_t seed, uint32_t stream, uint32_t counter)
+{
+  uint64_t key = seed + 0x9e3779b97f4a7c15ULL * (((uint64_t)stream << 32) | counter);
+  return (uint32_t)(rngMix64(key) >> 32);
+}
+
+// Uniform value in [0, range) (range must be > 0)
+static inline int rngRange(uint64_t seed, uint32_t stream, uint32_t counter, int range)
+{
+  return (int)(((uint64_t)rngAt(seed, stream, counter) * (uint32_t)range) >> 32);
+}
+
+// Sub-seed for one key under a seed (a tick, a load, a game number)
+static inline uint64_t rngDerive(uint64_t seed, uint64_t key)
+{
+  return rngMix64(seed ^ rngMix64(key + 0x9e3779b97f4a7c15ULL));
+}
+
+// Stream key for a world cell or chunk coordinate pair
+static inline uint32_t rngCellKey(int x, int y)
+{
+  return (uint32_t)x * 0x8da6b343u ^ (uint32_t)y * 0xd8163841u;
+}
+
+// A run of draws from one (seed, stream) for code that rolls in sequence;
+// the counter is its only state, so a copy replays the same values
+typedef struct
+{
+  uint64_t seed;
+  uint32_t stream;
+  uint32_t counter;
+} RngStream;
+
+static inline RngStream rngStream(uint64_t seed, uint32_t stream)
+{
+  RngStream random = {seed, stream, 0};
+  return random;
+}
+
+// Next value in [0, range) (range must be > 0)
+static inline int rngNext(RngStream *random, int range)
+{
+  return rngRange(random->seed, random->stream, random->counter++, range);
+}
+
+// Every subsystem draws from its own seed, so adding or removing a draw in
+// one never shifts what another sees
+typedef enum
+{
+  RNG_TERRAIN,       // Terrain noise: chunk x cell (same for every game of a run)
+  RNG_CHUNK_CONTENT, // Entities placed when a chunk loads: chunk x load tick
+  RNG_SPAWN,         // Top-up spawns around the player: kind x tick
+  RNG_MONSTERS,      // Monster archetypes and stats
+  RNG_AI,            // Monster decisions: monster id x AI frame
+  RNG_FIRE,          // Burn times and spread: cell x fire tick
+  RNG_GAME,          // Game setup
+  RNG_PARTICLES,     // Cosmetic only; never feeds back into gameplay
+  RNG_DOMAIN_COUNT
+} RngDomain;
+
+// Function declarations for seeding (rng.c)
+void seedRandom(unsigned int seed); // Once per run: the world seed
+void reseedGame();                  // Every new game: fresh seeds for everything but terrain
+uint64_t rngSeed(RngDomain domain);
+unsigned int rngGameNumber();
+void setRngGameNumber(unsigned int game); // Carries the count across restartGame's restore
+
+#endif
@@ -0,0 +1,187 @@
+#include "types.h"
+#include "globals.h"
+#include "savestate.h"
+#include "visibility.h"
+#include "platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Whole-simulation save states. A save is one flat buffer holding every
+// module's persistent state back to back (entity arrays by their live count,
+// loaded chunks, the fire and light lists, random seeds), so saving and
+// restoring are a few dozen memcpys. Caches derived from that state are
+// dropped on restore and rebuild themselves.
+//
+// Two users: restartGame returns to the world initGame generated instead of
+// generating ~625 chunks again, and a ring of recent saves lets the game
+// rewind. Saving and restoring is also the rollback primitive for anything
+// that needs to re-simulate from an earlier tick.
+
+// Copies one block out to the save, or back in from it. A save that could
+// not grow is left empty (size 0) and restores as a no-op.
+void stateBlock(StateStream *stream, void *data, size_t size)
+{
+  SaveState *state = stream->state;
+  if (size == 0 || stream->failed)
+    return;
+
+  if (stream->restoring)
+  {
+    memcpy(data, state->data + stream->offset, size);
+  }
+  else
+  {
+    if (stream->offset + size > state->capacity)
+    {
+      size_t capacity = state->capacity ? state->capacity * 2 : 1 << 20;
+      while (capacity < stream->offset + size)
+        capacity *= 2;
+      unsigned char *grown = realloc(state->data, capacity);
+      if (grown == NULL)
+      {
+        stream->failed = 1;
+        return;
+      }
+      state->data = grown;
+      state->capacity = capacity;
+    }
+    memcpy(state->data + stream->offset, data, size);
+  }
+  stream->offset += size;
+}
+
+// Entity arrays are streamed up to their live count; the count comes first,
+// so on restore it is back in place before the array size is worked out
+static void streamGlobalState(StateStream *stream)
+{
+  stateBlock(stream, &world->gameTick, sizeof(world->gameTick));
+  stateBlock(stream, &world->player, sizeof(world->player));
+  stateBlock(stream, &world->monsterCount, sizeof(world->monsterCount));
+  stateBlock(stream, world->monsters, sizeof(world->monsters[0]) * world->monsterCount);
+  stateBlock(stream, &world->powerupCount, sizeof(world->powerupCount));
+  stateBlock(stream, world->powerups, sizeof(world->powerups[0]) * world->powerupCount);
+  stateBlock(stream, &world->landmineCount, sizeof(world->landmineCount));
+  stateBlock(stream, world->landmines, sizeof(world->landmines[0]) * world->landmineCount);
+}
+
+static void streamState(StateStream *stream)
+{
+  streamGlobalState(stream);
+  streamWorldState(stream);
+  streamPlayerState(stream);
+  streamMonsterState(stream);
+  streamProjectileState(stream);
+  streamParticleState(stream);
+  streamTerrainState(stream);
+  streamFireState(stream);
+  streamLightingState(stream);
+  streamRandomState(stream);
+}
+
+void saveState(SaveState *state)
+{
+  double start = platformTimer();
+  StateStream stream = {state, 0, 0, 0};
+  streamState(&stream);
+  state->size = stream.failed ? 0 : stream.offset;
+  state->tick = world->gameTick;
+  world->saveStateStats.lastSize = state->size;
+  world->saveStateStats.lastSaveMs = (platformTimer() - start) * 1000.0;
+}
+
+void restoreState(const SaveState *state)
+{
+  if (state->size == 0)
+    return;
+
+  double start = platformTimer();
+  StateStream stream = {(SaveState *)state, 0, 1, 0};
+  streamState(&stream);
+  invalidateLineOfSight(); // Its cache is keyed by a terrain version that does not go back
+  world->saveStateStats.lastRestoreMs = (platformTimer() - start) * 1000.0;
+}
+
+void freeState(SaveState *state)
+{
+  free(state->data);
+  state->data = NULL;
+  state->size = 0;
+  state->capacity = 0;
+}
+
+void saveStartState()
+{
+  saveState(&world->startState);
+}
+
+int restoreStartState()
+{
+  if (world->startState.size == 0)
+    return 0;
+  restoreState(&world->startState);
+  return 1;
+}
+
+// Batch worlds have nobody to press rewind and turn the ring off; the memory
+// governor shortens it under pressure. Changing the depth starts the rewind
+// history over and frees the slots no longer used.
+void setStateRingDepth(int depth)
+{
+  if (depth < 0)
+    depth = 0;
+  if (depth > STATE_RING_SIZE)
+    depth = STATE_RING_SIZE;
+  if (depth == world->ringDepth)
+    return;
+
+  for (int i = depth; i < STATE_RING_SIZE; i++)
+    freeState(&world->ring[i]);
+  world->ringDepth = depth;
+  world->ringNewest = -1;
+  world->ringCount = 0;
+  world->saveStateStats.ringCount = 0;
+}
+
+int stateRingDepth()
+{
+  return world->ringDepth;
+}
+
+size_t stateMemoryUsed()
+{
+  size_t used = world->startState.capacity;
+  for (int i = 0; i < STATE_RING_SIZE; i++)
+    used += world->ring[i].capacity;
+  return used;
+}
+
+void recordStateRing()
+{
+  if (world->ringDepth == 0 || world->gameTick % STATE_RING_INTERVAL != 0)
+    return;
+
+  world->ringNewest = (world->ringNewest + 1) % world->ringDepth;
+  saveState(&world->ring[world->ringNewest]);
+  if (world->ringCount < world->ringDepth)
+    world->ringCount++;
+  world->saveStateStats.ringCount = world->ringCount;
+}
+
+int rewindState()
+{
+  // Saves that are too recent to be worth going back to are discarded, so
+  // pressing rewind again goes further back
+  while (world->ringCount > 0 &&
+         (world->ring[world->ringNewest].size == 0 || world->gameTick - world->ring[world->ringNewest].tick < STATE_REWIND_MIN_TICKS))
+  {
+    world->ringNewest = (world->ringNewest + world->ringDepth - 1) % world->ringDepth;
+    world->ringCount--;
+  }
+  world->saveStateStats.ringCount = world->ringCount;
+  if (world->ringCount == 0)
+    return 0;
+
+  restoreState(&world->ring[world->ringNewest]);
+  world->saveStateStats.rewinds++;
+  return 1;
+}
@@ -0,0 +1,65 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include "types.h"
+#include <stddef.h>
+
+#define STATE_RING_SIZE 8         // Saves kept for rewinding
+#define STATE_RING_INTERVAL 30    // Ticks between ring saves (8 saves = 4 seconds back)
+#define STATE_REWIND_MIN_TICKS 15 // A save younger than this is skipped, so rewind always goes back
+
+// The whole simulation state, copied into one contiguous, pointer-free block
+typedef struct
+{
+  unsigned char *data;
+  size_t size;       // Bytes in use
+  size_t capacity;   // Bytes allocated
+  unsigned int tick; // gameTick when saved
+} SaveState;
+
+// Cursor over a SaveState. Every module streams its state through the same
+// calls in both directions, so save and restore can never disagree on layout.
+typedef struct
+{
+  SaveState *state;
+  size_t offset;
+  int restoring;
+  int failed; // Out of memory while saving
+} StateStream;
+
+// Save and restore statistics (refreshed on every save and restore)
+typedef struct
+{
+  double lastSaveMs;    // Wall time of the most recent save
+  double lastRestoreMs; // Wall time of the most recent restore
+  size_t lastSize;      // Bytes in the most recent save
+  int ringCount;        // Saves available for rewinding
+  int rewinds;          // Rewinds so far
+} SaveStateStats;
+
+// Function declarations for saving and restoring the simulation
+void stateBlock(StateStream *stream, void *data, size_t size);
+void saveState(SaveState *state);
+void restoreState(const SaveState *state);
+void freeState(SaveState *state);
+void saveStartState();    // End of initGame: the world restartGame returns to
+int restoreStartState();  // 0 if there is no start state yet
+void recordStateRing();   // End of every tick
+void setStateRingDepth(int depth); // Saves kept for rewinding, 0 .. STATE_RING_SIZE (default)
+int stateRingDepth();
+size_t stateMemoryUsed(); // Start state and rewind saves
+int rewindState();        // Back to the newest save at least STATE_REWIND_MIN_TICKS old
+
+// Each module streams its own persistent state (scratch buffers and caches
+// that are rebuilt every tick are left out)
+void streamWorldState(StateStream *stream);       // world.c
+void streamPlayerState(StateStream *stream);      // player.c
+void streamMonsterState(StateStream *stream);     // monsters.c
+void streamProjectileState(StateStream *stream);  // projectiles.c
+void streamParticleState(StateStream *stream);    // particles.c
+void streamTerrainState(StateStream *stream);     // terrain.c
+void streamFireState(StateStream *stream);        // fire.c
+void streamLightingState(StateStream *stream);    // lighting.c
+void streamRandomState(StateStream *stream);      // rng.c
+
+#endif
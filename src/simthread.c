@@ -0,0 +1,154 @@
+#define _POSIX_C_SOURCE 200809L
+#include "types.h"
+#include "globals.h"
+#include "simthread.h"
+#include "game.h"
+#include "input.h"
+#include "snapshot.h"
+#include "throttle.h"
+#include "tunables.h"
+#include "replay.h"
+#include "platform.h"
+#include <pthread.h>
+#include <time.h>
+
+// The simulation runs on its own thread at SIM_TICKS_PER_SECOND, publishing a
+// snapshot after every batch of ticks, while the main thread polls input and
+// draws the newest snapshot. The two only meet at the input handoff below and
+// the snapshot swap, so a frame costs max(sim, draw) instead of their sum.
+
+static pthread_t simulationThread;
+static pthread_mutex_t inputLock = PTHREAD_MUTEX_INITIALIZER;
+static InputState pendingInput = {0}; // Polled by the main thread, not yet seen by a tick
+static double pendingDrawMs = 0.0;    // Draw time of the main thread's latest frame
+static int pendingTunables[TUNABLE_COUNT];   // Console changes not yet applied
+static int pendingTunableSet[TUNABLE_COUNT]; // Which of them are waiting
+static int running = 0;
+static int threaded = 0; // 0 if the thread couldn't be started: the main thread steps instead
+
+static double previousTime = 0.0;
+static double tickAccumulator = 0.0;
+static double lastTickMs = 0.0;
+
+static int isRunning()
+{
+  pthread_mutex_lock(&inputLock);
+  int keepRunning = running;
+  pthread_mutex_unlock(&inputLock);
+  return keepRunning;
+}
+
+static void takeInput()
+{
+  int changes[TUNABLE_COUNT];
+  int changed[TUNABLE_COUNT];
+
+  pthread_mutex_lock(&inputLock);
+  mergeInput(&world->input, &pendingInput);
+  consumeInput(&pendingInput);
+  double drawMs = pendingDrawMs;
+  for (int i = 0; i < TUNABLE_COUNT; i++)
+  {
+    changes[i] = pendingTunables[i];
+    changed[i] = pendingTunableSet[i];
+    pendingTunableSet[i] = 0;
+  }
+  pthread_mutex_unlock(&inputLock);
+  noteDrawTime(drawMs);
+
+  // A replay holds the settings it was recorded with (see replay.h)
+  if (world->replayStats.mode == REPLAY_RECORDING || world->replayStats.mode == REPLAY_PLAYING)
+    return;
+  for (int i = 0; i < TUNABLE_COUNT; i++)
+  {
+    if (changed[i])
+      setTunable(i, changes[i]);
+  }
+}
+
+// Runs the ticks that are due and publishes the result; returns the seconds
+// until the next tick is due
+static double advanceSimulation()
+{
+  double now = platformTimer();
+  tickAccumulator += now - previousTime;
+  previousTime = now;
+
+  int ticks = 0;
+  while (tickAccumulator >= SIM_TICK_SECONDS && ticks < MAX_CATCHUP_TICKS)
+  {
+    takeInput();
+    double tickStart = platformTimer();
+    simulationTick();
+    consumeInput(&world->input);
+    lastTickMs = (platformTimer() - tickStart) * 1000.0;
+    tickAccumulator -= SIM_TICK_SECONDS;
+    ticks++;
+  }
+  if (tickAccumulator >= SIM_TICK_SECONDS)
+  {
+    tickAccumulator = 0.0; // Too far behind: slow the game down rather than spiral
+  }
+
+  if (ticks > 0)
+    publishSnapshot(lastTickMs);
+  return SIM_TICK_SECONDS - tickAccumulator;
+}
+
+static void sleepSeconds(double seconds)
+{
+  struct timespec duration;
+  duration.tv_sec = (time_t)seconds;
+  duration.tv_nsec = (long)((seconds - duration.tv_sec) * 1e9);
+  nanosleep(&duration, NULL);
+}
+
+static void *simulationMain(void *arg)
+{
+  (void)arg;
+  while (isRunning())
+    sleepSeconds(advanceSimulation());
+  return NULL;
+}
+
+// Main thread, once per rendered frame
+void submitInput(double drawMs)
+{
+  pthread_mutex_lock(&inputLock);
+  pollInput(&pendingInput);
+  pendingDrawMs = drawMs;
+  pthread_mutex_unlock(&inputLock);
+
+  if (!threaded)
+    advanceSimulation();
+}
+
+// Main thread (the console); a later change to the same tunable replaces an
+// earlier one that has not been applied yet
+void submitTunable(int id, int value)
+{
+  pthread_mutex_lock(&inputLock);
+  pendingTunables[id] = value;
+  pendingTunableSet[id] = 1;
+  pthread_mutex_unlock(&inputLock);
+}
+
+// Call after initGame; publishes a first snapshot so there is always one to draw
+void startSimulationThread()
+{
+  publishSnapshot(0.0);
+  previousTime = platformTimer();
+  tickAccumulator = 0.0;
+  running = 1;
+  threaded = pthread_create(&simulationThread, NULL, simulationMain, NULL) == 0;
+}
+
+void stopSimulationThread()
+{
+  pthread_mutex_lock(&inputLock);
+  running = 0;
+  pthread_mutex_unlock(&inputLock);
+  if (threaded)
+    pthread_join(simulationThread, NULL);
+  threaded = 0;
+}
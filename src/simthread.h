@@ -0,0 +1,12 @@
+#ifndef SIMTHREAD_H
+#define SIMTHREAD_H
+
+#include "types.h"
+
+// Function declarations for the simulation thread
+void startSimulationThread();
+void stopSimulationThread();
+void submitInput(double drawMs); // drawMs: the last frame's draw time, for the frame governor
+void submitTunable(int id, int value); // Applied before the next tick (not while a replay runs)
+
+#endif
@@ -0,0 +1,241 @@
+#define _POSIX_C_SOURCE 200809L
+#include "types.h"
+#include "globals.h"
+#include "world.h"
+#include "snapshot.h"
+#include "throttle.h"
+#include "tunables.h"
+#include "platform.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Triple buffer of world snapshots. The simulation fills the write buffer
+// and swaps it with the ready one; the renderer swaps the ready buffer with
+// the one it reads whenever a newer one is waiting. Neither side ever waits
+// for the other to finish: only the index swaps happen under the lock.
+
+static WorldSnapshot buffers[3];
+static int writeIndex = 0;
+static int readyIndex = 1;
+static int readIndex = 2;
+static int readyFresh = 0; // Ready buffer is newer than the read buffer
+static int published = 0;  // Any snapshot has been published yet
+static double lastPublishMs = 0.0;
+static unsigned char minimap[MINIMAP_SIZE][MINIMAP_SIZE]; // Latest minimap sample
+static int minimapAge = -1; // Snapshots since it was taken (-1 = never)
+static pthread_mutex_t swapLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Terrain type at a world cell through a one-chunk cache
+static unsigned char sampleTerrain(int worldX, int worldY, int *cachedChunkX, int *cachedChunkY, int *cachedIndex)
+{
+  WorldPosition pos = worldToChunk(worldX, worldY);
+  if (pos.chunkX != *cachedChunkX || pos.chunkY != *cachedChunkY)
+  {
+    *cachedChunkX = pos.chunkX;
+    *cachedChunkY = pos.chunkY;
+    *cachedIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+  }
+  if (*cachedIndex == -1)
+    return SNAPSHOT_UNLOADED;
+  return (unsigned char)world->loadedChunks[*cachedIndex].terrain[pos.localX][pos.localY];
+}
+
+static void copyView(WorldSnapshot *snapshot)
+{
+  snapshot->viewX = world->player.x - SNAPSHOT_VIEW_CELLS / 2;
+  snapshot->viewY = world->player.y - SNAPSHOT_VIEW_CELLS / 2;
+  snapshot->nightMode = isNightMode();
+  for (int i = 0; i < TUNABLE_COUNT; i++)
+    snapshot->tunables[i] = world->tunables[i].value;
+
+  for (int x = 0; x < SNAPSHOT_VIEW_CELLS; x++)
+  {
+    int cachedChunkX = 0, cachedChunkY = 0, cachedIndex = getChunkIndex(0, 0);
+    for (int y = 0; y < SNAPSHOT_VIEW_CELLS; y++)
+    {
+      WorldPosition pos = worldToChunk(snapshot->viewX + x, snapshot->viewY + y);
+      if (pos.chunkX != cachedChunkX || pos.chunkY != cachedChunkY)
+      {
+        cachedChunkX = pos.chunkX;
+        cachedChunkY = pos.chunkY;
+        cachedIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+      }
+
+      snapshot->light[x][y] = cachedIndex == -1 ? 0 : world->loadedChunks[cachedIndex].light[pos.localX][pos.localY];
+    }
+  }
+
+  // Whole chunks for the terrain tiles: the renderer rebakes a tile only
+  // when the revision differs from the one it baked
+  WorldPosition first = worldToChunk(snapshot->viewX, snapshot->viewY);
+  WorldPosition last =
+      worldToChunk(snapshot->viewX + SNAPSHOT_VIEW_CELLS - 1, snapshot->viewY + SNAPSHOT_VIEW_CELLS - 1);
+  snapshot->chunkCount = 0;
+  for (int chunkX = first.chunkX; chunkX <= last.chunkX; chunkX++)
+  {
+    for (int chunkY = first.chunkY; chunkY <= last.chunkY; chunkY++)
+    {
+      int index = getChunkIndex(chunkX, chunkY);
+      if (index == -1)
+        continue;
+      const Chunk *chunk = &world->loadedChunks[index];
+      SnapshotChunk *copy = &snapshot->chunks[snapshot->chunkCount++];
+      copy->chunkX = chunkX;
+      copy->chunkY = chunkY;
+      copy->revision = chunk->revision;
+      for (int x = 0; x < CHUNK_SIZE; x++)
+      {
+        for (int y = 0; y < CHUNK_SIZE; y++)
+          copy->terrain[x][y] = (unsigned char)chunk->terrain[x][y];
+      }
+    }
+  }
+
+  // Resampled every snapshot, or every few while the frame governor sheds it
+  if (minimapAge < 0 || !throttled(THROTTLE_MINIMAP) || ++minimapAge >= THROTTLE_MINIMAP_INTERVAL)
+  {
+    int left = world->player.x - MINIMAP_RANGE;
+    int top = world->player.y - MINIMAP_RANGE;
+    for (int x = 0; x < MINIMAP_SIZE; x++)
+    {
+      int cachedChunkX = 0, cachedChunkY = 0, cachedIndex = getChunkIndex(0, 0);
+      for (int y = 0; y < MINIMAP_SIZE; y++)
+        minimap[x][y] = sampleTerrain(left + x * MINIMAP_SCALE, top + y * MINIMAP_SCALE, &cachedChunkX,
+                                      &cachedChunkY, &cachedIndex);
+    }
+    minimapAge = 0;
+  }
+  memcpy(snapshot->minimap, minimap, sizeof(minimap));
+}
+
+static void copyEntities(WorldSnapshot *snapshot)
+{
+  snapshot->player = world->player;
+
+  snapshot->monsterCount = world->monsterCount;
+  int visible = 0;
+  for (int i = 0; i < world->monsterCount; i++)
+  {
+    const Character *monster = &world->monsters[i];
+    if (!monster->alive || abs(monster->x - world->player.x) > MINIMAP_RANGE || abs(monster->y - world->player.y) > MINIMAP_RANGE)
+      continue;
+
+    SnapshotMonster *copy = &snapshot->monsters[visible++];
+    copy->x = monster->x;
+    copy->y = monster->y;
+    copy->previousX = monster->previousX;
+    copy->previousY = monster->previousY;
+    copy->textureIndex = monster->textureIndex;
+    copy->health = monster->health;
+    copy->maxHealth = monster->maxHealth;
+  }
+  snapshot->visibleMonsterCount = visible;
+
+  snapshot->powerupCount = world->powerupCount;
+  memcpy(snapshot->powerups, world->powerups, world->powerupCount * sizeof(Powerup));
+  snapshot->landmineCount = world->landmineCount;
+  memcpy(snapshot->landmines, world->landmines, world->landmineCount * sizeof(Landmine));
+
+  // Only what could be on screen, with a cell of margin
+  float viewLeft = snapshot->viewX - 1.0f;
+  float viewTop = snapshot->viewY - 1.0f;
+  float viewRight = snapshot->viewX + SNAPSHOT_VIEW_CELLS + 1.0f;
+  float viewBottom = snapshot->viewY + SNAPSHOT_VIEW_CELLS + 1.0f;
+
+  snapshot->projectileCount = world->projectiles.count;
+  snapshot->projectileCapacity = world->projectiles.capacity;
+  visible = 0;
+  for (int i = 0; i < world->projectiles.count && visible < SNAPSHOT_MAX_PROJECTILES; i++)
+  {
+    if (world->projectiles.x[i] < viewLeft || world->projectiles.x[i] > viewRight ||
+        world->projectiles.y[i] < viewTop || world->projectiles.y[i] > viewBottom)
+      continue;
+
+    SnapshotProjectile *copy = &snapshot->projectiles[visible++];
+    copy->x = world->projectiles.x[i];
+    copy->y = world->projectiles.y[i];
+    copy->previousX = world->projectiles.previousX[i];
+    copy->previousY = world->projectiles.previousY[i];
+    copy->type = world->projectiles.type[i];
+  }
+  snapshot->visibleProjectileCount = visible;
+
+  // Particles are in world pixels
+  viewLeft *= CELL_SIZE;
+  viewTop *= CELL_SIZE;
+  viewRight *= CELL_SIZE;
+  viewBottom *= CELL_SIZE;
+  visible = 0;
+  for (int i = 0; i < world->particles.count; i++)
+  {
+    float x = world->particles.x[i];
+    float y = world->particles.y[i];
+    if (x < viewLeft || x > viewRight || y < viewTop || y > viewBottom)
+      continue;
+
+    SnapshotParticle *copy = &snapshot->particles[visible++];
+    copy->x = x;
+    copy->y = y;
+    copy->size = world->particles.size[i];
+    copy->color = world->particles.color[i];
+    copy->color.a = (unsigned char)(copy->color.a * (world->particles.life[i] * world->particles.invLife[i]));
+  }
+  snapshot->visibleParticleCount = visible;
+}
+
+// Called by the simulation after a batch of ticks
+void publishSnapshot(double tickMs)
+{
+  double publishStart = platformTimer();
+  WorldSnapshot *snapshot = &buffers[writeIndex];
+
+  snapshot->tick = world->gameTick;
+  snapshot->tickMs = tickMs;
+  snapshot->publishMs = lastPublishMs;
+  copyView(snapshot);
+  copyEntities(snapshot);
+
+  snapshot->aiStats = world->aiStats;
+  snapshot->pathStats = world->pathStats;
+  snapshot->losStats = world->losStats;
+  snapshot->projectileStats = world->projectileStats;
+  snapshot->particleStats = world->particleStats;
+  snapshot->fireStats = world->fireStats;
+  snapshot->lightStats = world->lightStats;
+  snapshot->jobStats = world->jobStats;
+  snapshot->replayStats = world->replayStats;
+  snapshot->saveStateStats = world->saveStateStats;
+  snapshot->frameArenaStats = world->frameArenaStats;
+  snapshot->memoryStats = world->memoryStats;
+  snapshot->throttleStats = world->throttleStats;
+
+  snapshot->publishTime = platformTimer();
+  lastPublishMs = (snapshot->publishTime - publishStart) * 1000.0;
+
+  pthread_mutex_lock(&swapLock);
+  int ready = readyIndex;
+  readyIndex = writeIndex;
+  writeIndex = ready;
+  readyFresh = 1;
+  published = 1;
+  pthread_mutex_unlock(&swapLock);
+}
+
+// The newest complete snapshot (NULL before the first one). Stays valid and
+// unchanged until the next call.
+const WorldSnapshot *acquireSnapshot()
+{
+  pthread_mutex_lock(&swapLock);
+  if (readyFresh)
+  {
+    int ready = readyIndex;
+    readyIndex = readIndex;
+    readIndex = ready;
+    readyFresh = 0;
+  }
+  int available = published;
+  pthread_mutex_unlock(&swapLock);
+
+  return available ? &buffers[readIndex] : NULL;
+}
@@ -0,0 +1,123 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "types.h"
+#include "monsters.h"
+#include "pathfinding.h"
+#include "visibility.h"
+#include "projectiles.h"
+#include "particles.h"
+#include "fire.h"
+#include "lighting.h"
+#include "jobs.h"
+#include "replay.h"
+#include "savestate.h"
+#include "arena.h"
+#include "memory.h"
+#include "throttle.h"
+#include "tunables.h"
+
+// Everything the renderer needs from one simulation tick, copied out so the
+// simulation thread can move on while the main thread draws it
+#define SNAPSHOT_VIEW_CELLS 48 // Terrain window around the player (screen is 40 cells)
+#define MINIMAP_SIZE 120       // Minimap pixels per side
+#define MINIMAP_SCALE 3        // World cells per minimap pixel
+#define MINIMAP_RANGE (MINIMAP_SIZE / 2 * MINIMAP_SCALE)
+#define SNAPSHOT_MAX_PROJECTILES 16384
+#define SNAPSHOT_UNLOADED 255 // Terrain value for cells outside loaded chunks
+// Chunks the view can span per axis
+#define SNAPSHOT_VIEW_CHUNKS ((SNAPSHOT_VIEW_CELLS + CHUNK_SIZE - 2) / CHUNK_SIZE + 1)
+
+typedef struct
+{
+  int x, y;
+  int previousX, previousY;
+  int textureIndex;
+  int health, maxHealth;
+} SnapshotMonster;
+
+typedef struct
+{
+  float x, y;
+  float previousX, previousY;
+  int type;
+} SnapshotProjectile;
+
+// A loaded chunk under the view, whole, for the renderer's baked terrain tiles
+typedef struct
+{
+  int chunkX, chunkY;
+  int revision; // Chunk.revision: a tile baked at this revision is still current
+  unsigned char terrain[CHUNK_SIZE][CHUNK_SIZE]; // [localX][localY]
+} SnapshotChunk;
+
+typedef struct
+{
+  float x, y;
+  float size;
+  Color color; // Alpha already faded by remaining life
+} SnapshotParticle;
+
+typedef struct
+{
+  unsigned int tick;
+  double publishTime; // platformTimer() when the tick finished, for interpolation
+  double tickMs;      // Wall time of the most recent simulation tick
+  double publishMs;   // Wall time spent filling the previous snapshot
+
+  Character player;
+
+  // Light around the player; [x][y] from (viewX, viewY)
+  int viewX, viewY;
+  unsigned char light[SNAPSHOT_VIEW_CELLS][SNAPSHOT_VIEW_CELLS];
+
+  // The loaded chunks the view overlaps (unloaded ones are left out)
+  int chunkCount;
+  SnapshotChunk chunks[SNAPSHOT_VIEW_CHUNKS * SNAPSHOT_VIEW_CHUNKS];
+  int nightMode;
+
+  // Current tunable values, for the console
+  int tunables[TUNABLE_COUNT];
+
+  // One terrain sample per minimap pixel, [x][y]
+  unsigned char minimap[MINIMAP_SIZE][MINIMAP_SIZE];
+
+  // Living monsters within minimap range (monsterCount is the world total)
+  int monsterCount;
+  int visibleMonsterCount;
+  SnapshotMonster monsters[MAX_MONSTERS];
+
+  int powerupCount;
+  Powerup powerups[MAX_POWERUPS];
+  int landmineCount;
+  Landmine landmines[MAX_LANDMINES];
+
+  // Projectiles and particles near the view (counts are world totals)
+  int projectileCount;
+  int projectileCapacity;
+  int visibleProjectileCount;
+  SnapshotProjectile projectiles[SNAPSHOT_MAX_PROJECTILES];
+  int visibleParticleCount;
+  SnapshotParticle particles[MAX_PARTICLES];
+
+  // Statistics for the debug overlay
+  AiStats aiStats;
+  PathStats pathStats;
+  LosStats losStats;
+  ProjectileStats projectileStats;
+  ParticleStats particleStats;
+  FireStats fireStats;
+  LightStats lightStats;
+  JobStats jobStats;
+  ReplayStats replayStats;
+  SaveStateStats saveStateStats;
+  FrameArenaStats frameArenaStats;
+  MemoryStats memoryStats;
+  ThrottleStats throttleStats;
+} WorldSnapshot;
+
+// Function declarations for world snapshots
+void publishSnapshot(double tickMs);
+const WorldSnapshot *acquireSnapshot();
+
+#endif
@@ -0,0 +1,270 @@
+#include "types.h"
+#include "globals.h"
+#include "world.h"
+#include "terrain.h"
+#include "pathfinding.h"
+#include "visibility.h"
+#include "savestate.h"
+#include "platform.h"
+#include <stdlib.h>
+
+// Destructible terrain. Edits write Chunk.terrain straight away and grow the
+// chunk's dirty rectangle; flushTerrainEdits (once per frame) then rebuilds
+// only what depends on those cells: the opacity bits inside the rectangle,
+// the chunk's pathfinding portals (only if passability changed) and the LOS
+// cache. Edited chunks are copied to an edit store when they unload and
+// restored over freshly generated terrain when they load again.
+
+int getTerrainCell(int worldX, int worldY)
+{
+  WorldPosition pos = worldToChunk(worldX, worldY);
+  int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+  if (chunkIndex == -1)
+    return -1;
+
+  return world->loadedChunks[chunkIndex].terrain[pos.localX][pos.localY];
+}
+
+void setTerrainCell(int worldX, int worldY, int terrainType)
+{
+  WorldPosition pos = worldToChunk(worldX, worldY);
+  int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+  if (chunkIndex == -1)
+    return; // Unloaded terrain can't be edited
+
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+  int oldType = chunk->terrain[pos.localX][pos.localY];
+  if (oldType == terrainType)
+    return;
+
+  chunk->terrain[pos.localX][pos.localY] = terrainType;
+  chunk->modified = 1;
+  world->terrainStats.cellsChanged++;
+  if (isTerrainPassable(oldType) != isTerrainPassable(terrainType))
+    chunk->dirtyPassability = 1;
+
+  if (!chunk->dirty)
+  {
+    chunk->dirty = 1;
+    chunk->dirtyMinX = chunk->dirtyMaxX = pos.localX;
+    chunk->dirtyMinY = chunk->dirtyMaxY = pos.localY;
+    if (world->dirtyChunkCount < MAX_LOADED_CHUNKS)
+      world->dirtyChunks[world->dirtyChunkCount++] = chunkIndex;
+    return;
+  }
+
+  if (pos.localX < chunk->dirtyMinX)
+    chunk->dirtyMinX = pos.localX;
+  if (pos.localX > chunk->dirtyMaxX)
+    chunk->dirtyMaxX = pos.localX;
+  if (pos.localY < chunk->dirtyMinY)
+    chunk->dirtyMinY = pos.localY;
+  if (pos.localY > chunk->dirtyMaxY)
+    chunk->dirtyMaxY = pos.localY;
+}
+
+// Explosion damage: trees within burnRadius burn, and grass (and mountain)
+// within craterRadius is blown into craters. Pass craterRadius < 0 to only burn.
+void blastTerrain(int centerX, int centerY, int burnRadius, int craterRadius)
+{
+  for (int dy = -burnRadius; dy <= burnRadius; dy++)
+  {
+    for (int dx = -burnRadius; dx <= burnRadius; dx++)
+    {
+      int distance2 = dx * dx + dy * dy;
+      if (distance2 > burnRadius * burnRadius + burnRadius) // Round off the corners
+        continue;
+
+      int x = centerX + dx;
+      int y = centerY + dy;
+      int terrainType = getTerrainCell(x, y);
+      int inCrater = craterRadius >= 0 && distance2 <= craterRadius * craterRadius + craterRadius;
+
+      if (terrainType == TERRAIN_TREE)
+        setTerrainCell(x, y, TERRAIN_BURNT_TREE);
+      else if (inCrater && (terrainType == TERRAIN_GRASS || terrainType == TERRAIN_MOUNTAIN))
+        setTerrainCell(x, y, TERRAIN_CRATER);
+    }
+  }
+}
+
+int nextTerrainRevision()
+{
+  return ++world->lastTerrainRevision;
+}
+
+void flushTerrainEdits()
+{
+  if (world->dirtyChunkCount == 0)
+    return;
+
+  double flushStart = platformTimer();
+  int flushed = 0;
+
+  for (int d = 0; d < world->dirtyChunkCount; d++)
+  {
+    int chunkIndex = world->dirtyChunks[d];
+    Chunk *chunk = &world->loadedChunks[chunkIndex];
+    if (!chunk->dirty)
+      continue; // Chunk was unloaded or already flushed
+
+    updateChunkOpacity(chunkIndex, chunk->dirtyMinX, chunk->dirtyMinY, chunk->dirtyMaxX, chunk->dirtyMaxY);
+    if (chunk->dirtyPassability)
+      invalidateChunkPaths(chunkIndex); // Portals are rebuilt lazily by the next path query
+
+    chunk->dirty = 0;
+    chunk->dirtyPassability = 0;
+    chunk->revision = nextTerrainRevision();
+    flushed++;
+  }
+  world->dirtyChunkCount = 0;
+
+  world->terrainStats.chunksFlushed = flushed;
+  world->terrainStats.lastFlushMs = (platformTimer() - flushStart) * 1000.0;
+}
+
+static int findChunkEdits(int chunkX, int chunkY)
+{
+  for (int i = 0; i < world->editStoreCount; i++)
+  {
+    if (world->editStore[i].chunkX == chunkX && world->editStore[i].chunkY == chunkY)
+      return i;
+  }
+  return -1;
+}
+
+// Called before a loaded chunk slot is reused for another chunk
+void saveChunkEdits(int chunkIndex)
+{
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+  chunk->dirty = 0;
+  chunk->dirtyPassability = 0;
+  if (!chunk->modified)
+    return;
+
+  int slot = findChunkEdits(chunk->chunkX, chunk->chunkY);
+  if (slot == -1)
+  {
+    if (world->editStoreCount == world->editStoreCapacity)
+    {
+      int capacity = world->editStoreCapacity ? world->editStoreCapacity * 2 : 16;
+      ChunkEdits *grown = realloc(world->editStore, capacity * sizeof(ChunkEdits));
+      if (grown == NULL)
+        return; // Edits are lost, the chunk regenerates as new
+      world->editStore = grown;
+      world->editStoreCapacity = capacity;
+    }
+    slot = world->editStoreCount++;
+    world->editStore[slot].chunkX = chunk->chunkX;
+    world->editStore[slot].chunkY = chunk->chunkY;
+  }
+
+  for (int x = 0; x < CHUNK_SIZE; x++)
+  {
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      world->editStore[slot].terrain[x][y] = (unsigned char)chunk->terrain[x][y];
+    }
+  }
+  chunk->modified = 0;
+  world->terrainStats.savedChunks = world->editStoreCount;
+}
+
+// Called after terrain generation; returns 1 if saved edits replaced the terrain
+int restoreChunkEdits(int chunkIndex)
+{
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+  int slot = findChunkEdits(chunk->chunkX, chunk->chunkY);
+  if (slot == -1)
+    return 0;
+
+  for (int x = 0; x < CHUNK_SIZE; x++)
+  {
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      chunk->terrain[x][y] = world->editStore[slot].terrain[x][y];
+    }
+  }
+  chunk->modified = 1;
+  return 1;
+}
+
+size_t chunkEditMemoryUsed()
+{
+  return sizeof(ChunkEdits) * (size_t)world->editStoreCapacity;
+}
+
+// Forgets the saved edits of the unloaded chunks farthest from the player
+// until at least bytes are free (those chunks regenerate as new when they
+// load again); returns the bytes freed
+size_t trimChunkEdits(size_t bytes)
+{
+  size_t before = chunkEditMemoryUsed();
+  int playerChunkX = world->player.x / CHUNK_SIZE;
+  int playerChunkY = world->player.y / CHUNK_SIZE;
+  while (world->editStoreCount > 0 && sizeof(ChunkEdits) * (size_t)(world->editStoreCapacity - world->editStoreCount) < bytes)
+  {
+    int farthest = 0, farthestDistance = -1;
+    for (int i = 0; i < world->editStoreCount; i++)
+    {
+      int dx = abs(world->editStore[i].chunkX - playerChunkX);
+      int dy = abs(world->editStore[i].chunkY - playerChunkY);
+      int distance = dx > dy ? dx : dy;
+      if (distance > farthestDistance)
+      {
+        farthest = i;
+        farthestDistance = distance;
+      }
+    }
+    world->editStore[farthest] = world->editStore[--world->editStoreCount];
+  }
+
+  if (world->editStoreCount == 0)
+  {
+    free(world->editStore);
+    world->editStore = NULL;
+    world->editStoreCapacity = 0;
+  }
+  else if (world->editStoreCount < world->editStoreCapacity)
+  {
+    ChunkEdits *shrunk = realloc(world->editStore, sizeof(ChunkEdits) * (size_t)world->editStoreCount);
+    if (shrunk != NULL)
+    {
+      world->editStore = shrunk;
+      world->editStoreCapacity = world->editStoreCount;
+    }
+  }
+  world->terrainStats.savedChunks = world->editStoreCount;
+  return before - chunkEditMemoryUsed();
+}
+
+void clearTerrainEdits()
+{
+  world->editStoreCount = 0;
+  world->dirtyChunkCount = 0;
+  world->terrainStats.savedChunks = 0;
+}
+
+// The edit store is streamed up to its count; restoring grows it first
+void streamTerrainState(StateStream *stream)
+{
+  stateBlock(stream, &world->dirtyChunkCount, sizeof(world->dirtyChunkCount));
+  stateBlock(stream, world->dirtyChunks, sizeof(world->dirtyChunks[0]) * world->dirtyChunkCount);
+
+  stateBlock(stream, &world->editStoreCount, sizeof(world->editStoreCount));
+  if (stream->restoring && world->editStoreCount > world->editStoreCapacity)
+  {
+    ChunkEdits *grown = realloc(world->editStore, world->editStoreCount * sizeof(ChunkEdits));
+    if (grown == NULL)
+    {
+      // Edits are lost (the chunks regenerate as new); skip over them
+      stream->offset += world->editStoreCount * sizeof(ChunkEdits);
+      world->editStoreCount = 0;
+      return;
+    }
+    world->editStore = grown;
+    world->editStoreCapacity = world->editStoreCount;
+  }
+  stateBlock(stream, world->editStore, sizeof(ChunkEdits) * world->editStoreCount);
+  world->terrainStats.savedChunks = world->editStoreCount;
+}
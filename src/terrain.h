@@ -0,0 +1,35 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include "types.h"
+#include <stddef.h>
+
+// Terrain edit statistics
+typedef struct
+{
+  int cellsChanged;   // Cells edited so far
+  int chunksFlushed;  // Dirty chunks processed by the most recent flush
+  int savedChunks;    // Chunks held in the edit store
+  double lastFlushMs; // Wall time of the most recent flushTerrainEdits
+} TerrainStats;
+
+// An unloaded chunk's edited terrain (the edit store, World.editStore)
+typedef struct
+{
+  int chunkX, chunkY;
+  unsigned char terrain[CHUNK_SIZE][CHUNK_SIZE];
+} ChunkEdits;
+
+// Function declarations for terrain editing
+int getTerrainCell(int worldX, int worldY);
+void setTerrainCell(int worldX, int worldY, int terrainType);
+void blastTerrain(int centerX, int centerY, int burnRadius, int craterRadius);
+void flushTerrainEdits();
+int nextTerrainRevision();
+void saveChunkEdits(int chunkIndex);
+int restoreChunkEdits(int chunkIndex);
+void clearTerrainEdits();
+size_t chunkEditMemoryUsed();
+size_t trimChunkEdits(size_t bytes);
+
+#endif
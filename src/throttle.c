@@ -0,0 +1,107 @@
+#include "types.h"
+#include "globals.h"
+#include "throttle.h"
+
+// Frame-time governor. Every frame's cost (the tick's own time, or the draw
+// time of the latest rendered frame if that was longer: the two run side by
+// side) goes into a window of THROTTLE_WINDOW frames. A window with
+// THROTTLE_SLOW_FRAMES frames over THROTTLE_HIGH_PERCENT of the budget takes
+// one more load shedding step; THROTTLE_CALM_WINDOWS windows in a row with
+// every frame under THROTTLE_LOW_PERCENT give one back. The gap between the
+// two thresholds keeps it from flapping.
+//
+// The level is a decision about the simulation, so it travels with the
+// tick's input: replays record it and play it back, and a run stays
+// deterministic whatever the machine did while it was recorded. The
+// governor is off unless a budget is set (the game sets one; headless runs,
+// benchmarks and batch worlds run without).
+
+const char *throttleLevelNames[THROTTLE_LEVEL_COUNT] = {
+    "none", "distant AI", "spawns", "chunk slices", "minimap", "particles",
+};
+
+static void decide(int level)
+{
+  if (level == world->throttleStats.target)
+    return;
+
+  world->throttleStats.target = level;
+  ThrottleDecision *decision = &world->throttleStats.log[world->throttleStats.decisions++ % THROTTLE_LOG_SIZE];
+  decision->tick = world->gameTick;
+  decision->level = level;
+  decision->slowestMs = world->throttleStats.slowestMs;
+}
+
+void setThrottleBudget(double ms)
+{
+  world->throttleStats.budgetMs = ms > 0.0 ? ms : 0.0;
+  world->windowFrames = 0;
+  world->windowSlowFrames = 0;
+  world->windowSlowest = 0.0f;
+  world->calmWindows = 0;
+  if (world->throttleStats.budgetMs == 0.0)
+    decide(THROTTLE_NONE);
+}
+
+void noteDrawTime(double ms)
+{
+  world->drawMs = ms;
+}
+
+void governFrameTime(double tickMs)
+{
+  double budget = world->throttleStats.budgetMs;
+  if (budget == 0.0)
+    return;
+
+  float frameMs = (float)(tickMs > world->drawMs ? tickMs : world->drawMs);
+  if (frameMs > world->windowSlowest)
+    world->windowSlowest = frameMs;
+  if (frameMs > budget * THROTTLE_HIGH_PERCENT / 100.0)
+    world->windowSlowFrames++;
+  if (++world->windowFrames < THROTTLE_WINDOW)
+    return;
+
+  world->throttleStats.slowestMs = world->windowSlowest;
+  if (world->windowSlowFrames >= THROTTLE_SLOW_FRAMES)
+  {
+    world->calmWindows = 0;
+    if (world->throttleStats.target < THROTTLE_LEVEL_COUNT - 1)
+      decide(world->throttleStats.target + 1);
+  }
+  else if (world->windowSlowest < budget * THROTTLE_LOW_PERCENT / 100.0)
+  {
+    if (++world->calmWindows >= THROTTLE_CALM_WINDOWS && world->throttleStats.target > THROTTLE_NONE)
+    {
+      world->calmWindows = 0;
+      decide(world->throttleStats.target - 1);
+    }
+  }
+  else
+  {
+    world->calmWindows = 0;
+  }
+
+  world->windowFrames = 0;
+  world->windowSlowFrames = 0;
+  world->windowSlowest = 0.0f;
+}
+
+int throttleTarget()
+{
+  return world->throttleStats.target;
+}
+
+void setThrottleLevel(int level)
+{
+  if (level < THROTTLE_NONE)
+    level = THROTTLE_NONE;
+  if (level >= THROTTLE_LEVEL_COUNT)
+    level = THROTTLE_LEVEL_COUNT - 1;
+  world->throttleStats.level = level;
+}
+
+int throttled(ThrottleLevel step)
+{
+  return world->throttleStats.level >= (int)step;
+}
@@ -0,0 +1,63 @@
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include "types.h"
+
+#define THROTTLE_WINDOW 30          // Frames per decision (half a second of ticks)
+#define THROTTLE_HIGH_PERCENT 85    // A frame is slow when it uses this much of the budget
+#define THROTTLE_SLOW_FRAMES 3      // Slow frames in one window that call for another step
+#define THROTTLE_LOW_PERCENT 50     // A window is calm when no frame uses more than this
+#define THROTTLE_CALM_WINDOWS 4     // Calm windows in a row before a step is given back
+#define THROTTLE_LOG_SIZE 16        // Decisions kept for the overlay and headless summary
+
+// What each step sheds, while it is active
+#define THROTTLE_MID_TICK_FACTOR 2   // Mid-ring monsters think this many times less often
+#define THROTTLE_SPAWN_ROUNDS 5      // Most spawn attempts per tick (the spawn_rounds tunable otherwise)
+#define THROTTLE_CHUNK_SLICE 4       // Chunks loaded per tick outside CHUNK_MIN_LOAD_DISTANCE
+#define THROTTLE_MINIMAP_INTERVAL 4  // Snapshots per minimap resample
+#define THROTTLE_PARTICLE_PERCENT 50 // Share of each particle burst kept
+
+// Load shedding steps, in the order they are taken. Each level keeps the
+// steps below it, so level 3 throttles distant AI, spawns and chunk loading.
+// Off-screen work goes first; what the player can see goes last.
+typedef enum
+{
+  THROTTLE_NONE,
+  THROTTLE_DISTANT_AI,   // Mid-ring monsters think half as often
+  THROTTLE_SPAWNS,       // Fewer spawn attempts per tick
+  THROTTLE_CHUNK_SLICES, // Far chunks load a few per tick instead of all at once
+  THROTTLE_MINIMAP,      // Minimap resampled every few snapshots
+  THROTTLE_PARTICLES,    // Particle bursts thinned
+  THROTTLE_LEVEL_COUNT
+} ThrottleLevel;
+
+// One change of the governor's level
+typedef struct
+{
+  unsigned int tick; // gameTick of the decision
+  int level;         // Level chosen
+  float slowestMs;   // Slowest frame of the window that decided it
+} ThrottleDecision;
+
+// Frame governor statistics (refreshed every tick)
+typedef struct
+{
+  double budgetMs;  // Frame budget (0 = governor off)
+  int level;        // Level the current tick runs at
+  int target;       // Level the governor wants (a replay may override it)
+  float slowestMs;  // Slowest frame of the last full window
+  int decisions;    // Level changes so far
+  ThrottleDecision log[THROTTLE_LOG_SIZE]; // The latest decisions, decisions % THROTTLE_LOG_SIZE next
+} ThrottleStats;
+extern const char *throttleLevelNames[THROTTLE_LEVEL_COUNT];
+
+// Function declarations for the frame governor. simulationTick reports its
+// own time; the windowed game also reports the draw time of each frame.
+void setThrottleBudget(double ms); // 0 turns the governor off and drops its level
+void noteDrawTime(double ms);
+void governFrameTime(double tickMs); // End of every tick
+int throttleTarget();
+void setThrottleLevel(int level); // Start of every tick, after replay input
+int throttled(ThrottleLevel step);
+
+#endif
@@ -0,0 +1,94 @@
+#include "types.h"
+#include "globals.h"
+#include "tunables.h"
+#include "world.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Registry of the simulation's run-time settings. The table below is the
+// one place their names, defaults and ranges are written down; code reads
+// the values straight out of it by TunableId, so a read in a hot loop is a
+// plain load. Replays store every value in their header and restore them
+// before playing, so a run with changed settings replays exactly.
+
+#define TUNABLE(name, value, min, max, description) {name, value, value, min, max, description}
+
+const Tunable defaultTunables[TUNABLE_COUNT] = {
+    TUNABLE("chunk_load_distance", CHUNK_LOAD_DISTANCE, CHUNK_MIN_LOAD_DISTANCE, CHUNK_LOAD_DISTANCE,
+            "Resident chunk window, in chunks from the player"),
+    TUNABLE("ai_mid_tick_interval", AI_MID_TICK_INTERVAL, 1, 16, "Mid-ring monsters think every Nth frame"),
+    TUNABLE("ai_retier_interval", AI_RETIER_INTERVAL, 1, 600, "Frames between monster tier reassignments"),
+    TUNABLE("monster_despawn_distance", 300, 64, CHUNK_LOAD_DISTANCE * CHUNK_SIZE,
+            "Monsters farther away (cells) are dropped"),
+    TUNABLE("item_despawn_distance", 300, 64, CHUNK_LOAD_DISTANCE * CHUNK_SIZE,
+            "Powerups and landmines farther away (cells) are dropped"),
+    TUNABLE("max_monsters", 2000, 0, MAX_MONSTERS, "Most monsters alive at once (raise for benchmarks)"),
+    TUNABLE("nearby_monsters", 50, 0, 1000, "Monsters kept within two chunks of the player"),
+    TUNABLE("nearby_powerups", 5, 0, MAX_POWERUPS, "Powerups kept within two chunks of the player"),
+    TUNABLE("nearby_landmines", 10, 0, MAX_LANDMINES, "Landmines kept within two chunks of the player"),
+    TUNABLE("spawn_rounds", 20, 1, 1000, "Placement rounds per frame before a spawner gives up"),
+    TUNABLE("monster_spawn_min", 50, 0, 1000, "Closest a monster spawns (cells)"),
+    TUNABLE("monster_spawn_max", 300, 0, 1000, "Farthest a monster spawns (cells)"),
+    TUNABLE("powerup_spawn_min", 100, 0, 1000, "Closest a powerup spawns (cells)"),
+    TUNABLE("powerup_spawn_max", 400, 0, 1000, "Farthest a powerup spawns (cells)"),
+    TUNABLE("landmine_spawn_min", 150, 0, 1000, "Closest a landmine spawns (cells)"),
+    TUNABLE("landmine_spawn_max", 500, 0, 1000, "Farthest a landmine spawns (cells)"),
+    TUNABLE("move_cooldown", 6, 1, 600, "Frames between player steps (doubled in combat)"),
+    TUNABLE("arrow_cooldown", 60, 1, 3600, "Frames between arrows"),
+    TUNABLE("jump_smash_cooldown", 180, 1, 36000, "Frames between jump smashes"),
+    TUNABLE("rush_cooldown", 600, 1, 36000, "Frames between rushes"),
+    TUNABLE("heal_cooldown", 1800, 1, 36000, "Frames between heals"),
+};
+
+int findTunable(const char *name)
+{
+  for (int i = 0; i < TUNABLE_COUNT; i++)
+  {
+    if (strcmp(world->tunables[i].name, name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+int setTunable(int id, int value)
+{
+  Tunable *tunable = &world->tunables[id];
+  if (value < tunable->min)
+    value = tunable->min;
+  if (value > tunable->max)
+    value = tunable->max;
+  tunable->value = value;
+
+  // The chunk window is sized, not just read
+  if (id == TUNE_CHUNK_LOAD_DISTANCE)
+    setChunkWindow(value);
+  return value;
+}
+
+int parseTunableAssignment(const char *text)
+{
+  const char *equals = strchr(text, '=');
+  if (equals == NULL || equals == text)
+    return 0;
+
+  char name[64];
+  size_t length = (size_t)(equals - text);
+  if (length >= sizeof(name))
+    return 0;
+  memcpy(name, text, length);
+  name[length] = '\0';
+
+  int id = findTunable(name);
+  char *end;
+  long value = strtol(equals + 1, &end, 10);
+  if (id < 0 || end == equals + 1 || *end != '\0')
+    return 0;
+  setTunable(id, (int)value);
+  return 1;
+}
+
+void resetTunables()
+{
+  for (int i = 0; i < TUNABLE_COUNT; i++)
+    setTunable(i, world->tunables[i].defaultValue);
+}
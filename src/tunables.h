@@ -0,0 +1,52 @@
+#ifndef TUNABLES_H
+#define TUNABLES_H
+
+#include "types.h"
+
+// Named simulation settings that can change at run time (--set name=value,
+// the in-game console, headless sweeps). Code reads them as
+// tunables[TUNE_...].value.
+typedef enum
+{
+  TUNE_CHUNK_LOAD_DISTANCE,      // Resident chunk window (chunks from the player per axis)
+  TUNE_AI_MID_TICK_INTERVAL,     // Mid-ring monsters think every Nth frame
+  TUNE_AI_RETIER_INTERVAL,       // Frames between monster tier reassignments
+  TUNE_MONSTER_DESPAWN_DISTANCE, // Monsters farther than this from the player (cells) are dropped
+  TUNE_ITEM_DESPAWN_DISTANCE,    // Powerups and landmines farther than this are dropped
+  TUNE_MAX_MONSTERS,             // Population that chunk generation and spawning fill to (up to MAX_MONSTERS)
+  TUNE_NEARBY_MONSTERS,          // Monsters kept within two chunks of the player
+  TUNE_NEARBY_POWERUPS,          // Powerups kept within two chunks of the player
+  TUNE_NEARBY_LANDMINES,         // Landmines kept within two chunks of the player
+  TUNE_SPAWN_ROUNDS,             // Placement rounds per frame before a spawner gives up
+  TUNE_MONSTER_SPAWN_MIN,        // Spawn distance band, in cells from the player
+  TUNE_MONSTER_SPAWN_MAX,
+  TUNE_POWERUP_SPAWN_MIN,
+  TUNE_POWERUP_SPAWN_MAX,
+  TUNE_LANDMINE_SPAWN_MIN,
+  TUNE_LANDMINE_SPAWN_MAX,
+  TUNE_MOVE_COOLDOWN,            // Player cooldowns, in frames (doubled in combat for moving)
+  TUNE_ARROW_COOLDOWN,
+  TUNE_JUMP_SMASH_COOLDOWN,
+  TUNE_RUSH_COOLDOWN,
+  TUNE_HEAL_COOLDOWN,
+  TUNABLE_COUNT
+} TunableId;
+
+typedef struct
+{
+  const char *name;
+  int value;
+  int defaultValue;
+  int min, max; // Values outside are clamped
+  const char *description;
+} Tunable;
+
+extern const Tunable defaultTunables[TUNABLE_COUNT]; // The registry as the build ships it (initWorld copies it)
+
+// Function declarations for the tunables registry
+int findTunable(const char *name);           // -1 if there is no such tunable
+int setTunable(int id, int value);           // Clamps to the range; returns the value set
+int parseTunableAssignment(const char *text); // "name=value"; 0 if the name or value is bad
+void resetTunables();
+
+#endif
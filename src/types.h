@@ -7,16 +7,35 @@
 #define WORLD_SIZE 100
 #define CELL_SIZE 20
 #define WINDOW_SIZE 800
-#define MAX_MONSTERS 2000
+#define MAX_MONSTERS 16384 // Pool capacity; the max_monsters tunable caps the population
 #define MAX_POWERUPS 50
 #define MAX_LANDMINES 100
-#define MAX_PROJECTILES 100
+#define MAX_PROJECTILES 65536         // Hard cap on the growable projectile pool
+#define INITIAL_PROJECTILE_CAPACITY 256 // First pool allocation; doubles when full
+#define PROJECTILE_OWNER_PLAYER -1      // Projectile owner for the player's arrows
+
+// Simulation timing: gameplay timers and cooldowns count fixed ticks, not rendered frames
+#define SIM_TICKS_PER_SECOND 60
+#define SIM_TICK_SECONDS (1.0 / SIM_TICKS_PER_SECOND)
+#define MAX_CATCHUP_TICKS 5 // Ticks one rendered frame may run before dropping the backlog
 
 // Chunk system constants
 #define CHUNK_SIZE 32
 #define CHUNK_CELL_SIZE (CHUNK_SIZE * CELL_SIZE)
 #define MAX_LOADED_CHUNKS 625  // 25x25 grid of chunks around player
-#define CHUNK_LOAD_DISTANCE 12 // Much larger loading distance to prevent chunk unloading
+#define CHUNK_LOAD_DISTANCE 12 // Much larger loading distance to prevent chunk unloading (chunk_load_distance default and maximum)
+#define CHUNK_MIN_LOAD_DISTANCE 5 // Smallest window the memory governor shrinks to (covers AI_MID_RADIUS)
+
+// Monster AI level-of-detail (distances in cells from the player, per axis)
+#define AI_NEAR_RADIUS 48       // Full AI every frame inside this square
+#define AI_MID_RADIUS 128       // Reduced-rate AI without projectiles out to here; asleep beyond
+#define AI_MID_TICK_INTERVAL 4  // Mid-ring monsters think every Nth frame (ai_mid_tick_interval default)
+#define AI_RETIER_INTERVAL 30   // Frames between tier reassignments, also on chunk changes (ai_retier_interval default)
+
+// Pathfinding constants
+#define MAX_CHUNK_PORTALS 32   // Portal cells cached per chunk (HPA* abstract graph nodes)
+#define MAX_PORTALS_PER_SIDE 8 // Cap on portals along a single chunk border
+#define MAX_PATH_LENGTH 1024   // Longest refined path a query can return
 
 // Enums
 typedef enum
@@ -27,6 +46,26 @@ typedef enum
   RIGHT
 } Direction;
 
+typedef enum
+{
+  AI_TIER_NEAR,   // Full-rate AI
+  AI_TIER_MID,    // Coarse ticks, no projectiles
+  AI_TIER_ASLEEP, // Skipped entirely until the player comes close
+  AI_TIER_COUNT
+} AiTier;
+
+typedef enum
+{
+  TERRAIN_GRASS,
+  TERRAIN_MOUNTAIN,
+  TERRAIN_TREE,
+  TERRAIN_LAKE,
+  TERRAIN_SEA,
+  TERRAIN_CRATER,      // Blasted ground (walkable)
+  TERRAIN_BURNT_TREE,  // Charred trunk (walkable, see-through)
+  TERRAIN_BURNING_TREE // Tree on fire; burns out into a burnt tree
+} TerrainType;
+
 typedef enum
 {
   POWERUP_DOUBLE_DAMAGE,
@@ -36,15 +75,50 @@ typedef enum
 } PowerupType;
 
 // Data structures
+typedef struct
+{
+  unsigned char x, y;   // Local cell on the chunk border
+  unsigned char side;   // Direction of the border the portal sits on
+  unsigned char lo, hi; // Extent of the passable run this portal stands for
+} ChunkPortal;
+
 typedef struct
 {
   int chunkX, chunkY;                  // Chunk coordinates
   int loaded;                          // Whether this chunk is currently loaded
   int lastAccess;                      // Frame counter for LRU cache
   int terrain[CHUNK_SIZE][CHUNK_SIZE]; // Terrain data for each cell
-  // Terrain types: 0=grass, 1=mountain, 2=tree, 3=lake, 4=sea
+  // Terrain types: 0=grass, 1=mountain, 2=tree, 3=lake, 4=sea, 5=crater, 6=burnt tree, 7=burning tree
+
+  // Pathfinding cache, rebuilt whenever the terrain changes
+  int portalsValid;
+  int portalCount;
+  ChunkPortal portals[MAX_CHUNK_PORTALS];
+  unsigned short portalDist[MAX_CHUNK_PORTALS][MAX_CHUNK_PORTALS]; // Intra-chunk walking distance
+
+  // Line-of-sight opacity bitsets (mountains and trees)
+  unsigned int opaqueRows[CHUNK_SIZE]; // Bit x of row y
+  unsigned int opaqueCols[CHUNK_SIZE]; // Bit y of column x
+
+  // Terrain edits (explosions). Cells in the dirty rectangle changed since the
+  // last flushTerrainEdits and their derived caches still need rebuilding.
+  int dirty;
+  int dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
+  int dirtyPassability; // An edit changed which cells can be walked through
+  int modified;         // Terrain differs from the generator; kept when the chunk unloads
+  int revision;         // New whenever the terrain changes (load, flushed edits); never repeats, so it can key caches
+
+  int burningCells; // Cells on fire here (0 = fire simulation asleep in this chunk)
+
+  // Night lighting: light level per cell (0 = dark)
+  unsigned char light[CHUNK_SIZE][CHUNK_SIZE];
 } Chunk;
 
+typedef struct
+{
+  int x, y;
+} PathPoint;
+
 typedef struct
 {
   int x, y;           // World coordinates
@@ -56,10 +130,13 @@ typedef struct
 {
   char name[20];
   int x, y;
+  int previousX, previousY; // Cell at the start of the current tick (render interpolation)
   int health;
   int maxHealth;
   int power;
   int textureIndex;
+  int archetype;   // Index into archetypes[] (monsters only)
+  unsigned int id; // Stable spawn order id, keys the monster's random stream
   int alive;
   int speed;
   float speedMultiplier;
@@ -109,17 +186,23 @@ typedef struct
   int active;
 } Landmine;
 
+// Projectiles live in a growable structure-of-arrays pool: slot i of every
+// array belongs to projectile i, and slots [0, count) are live
 typedef struct
 {
-  int x, y;
-  float dx, dy; // Changed to float for precise direction tracking
-  int type;     // 0=lightning, 1=fireball, 2=arrow
-  int alive;
-  int damage;
-  int speed;
-  int effect;   // 0=none, 1=stun, 2=dot
-  int range;    // Distance traveled
-  int maxRange; // Maximum range before disappearing
-} Projectile;
+  int count;
+  int capacity;
+  float *x, *y;   // Sub-cell world position in cells (cell centre = +0.5)
+  float *previousX, *previousY; // Position before the last integrate step
+  float *dx, *dy; // Direction (unit length)
+  float *speed;   // Cells per frame
+  float *range;   // Distance traveled
+  float *maxRange;
+  int *type;   // 0=lightning, 1=fireball, 2=arrow
+  int *effect; // 0=none, 1=stun, 2=dot
+  int *damage;
+  int *owner;           // Shooter's monster id, or PROJECTILE_OWNER_PLAYER
+  unsigned char *alive; // Cleared on hit or expiry, compacted after each update
+} ProjectilePool;
 
 #endif // TYPES_H
@@ -1,37 +1,131 @@
 #include "types.h"
 #include "globals.h"
+#include "snapshot.h"
+#include "render.h"
 #include <stdlib.h>
 #include <math.h>
 
-// Function prototype for drawMinimap (defined in world.c)
-void drawMinimap();
+static int debugOverlayVisible = 0;
 
-void drawUI()
+void toggleDebugOverlay()
 {
+  debugOverlayVisible = !debugOverlayVisible;
+}
+
+// Performance counters (F3)
+static void drawDebugOverlay(const WorldSnapshot *snapshot)
+{
+  DrawRectangle(0, 60, 330, 232, Fade(BLACK, 0.6f));
+  DrawText(TextFormat("AI near %d (%.2f ms)  mid %d (%.2f ms)  asleep %d",
+                      snapshot->aiStats.tierCount[AI_TIER_NEAR], snapshot->aiStats.tierMs[AI_TIER_NEAR],
+                      snapshot->aiStats.tierCount[AI_TIER_MID], snapshot->aiStats.tierMs[AI_TIER_MID],
+                      snapshot->aiStats.tierCount[AI_TIER_ASLEEP]),
+           10, 66, 10, WHITE);
+  DrawText(TextFormat("AI resolve %.2f ms  %d moves cancelled  %d threads",
+                      snapshot->aiStats.resolveMs, snapshot->aiStats.movesCancelled, snapshot->aiStats.threads),
+           10, 80, 10, WHITE);
+  DrawText(TextFormat("Path %.3f ms  %d nodes  %d cells  %d overflows",
+                      snapshot->pathStats.lastQueryMs, snapshot->pathStats.lastNodesExpanded,
+                      snapshot->pathStats.lastPathLength, snapshot->pathStats.heapOverflows),
+           10, 94, 10, WHITE);
+  DrawText(TextFormat("LOS %.3f ms  %d shooters  %d/%d cached",
+                      snapshot->losStats.lastBatchMs, snapshot->losStats.lastBatchSize,
+                      snapshot->losStats.cacheHits, snapshot->losStats.queries),
+           10, 108, 10, WHITE);
+  DrawText(TextFormat("Projectiles %d/%d (%.3f ms)",
+                      snapshot->projectileCount, snapshot->projectileCapacity,
+                      snapshot->projectileStats.lastUpdateMs),
+           10, 122, 10, WHITE);
+  DrawText(TextFormat("Particles %d (%.3f ms)  %d dropped",
+                      snapshot->particleStats.liveCount, snapshot->particleStats.lastUpdateMs,
+                      snapshot->particleStats.dropped),
+           10, 136, 10, WHITE);
+  DrawText(TextFormat("Fire %d cells in %d chunks (%.3f ms)",
+                      snapshot->fireStats.burningCells, snapshot->fireStats.activeChunks,
+                      snapshot->fireStats.lastTickMs),
+           10, 150, 10, WHITE);
+  DrawText(TextFormat("Light %d sources (%d changed), %d cells, %d texels (%.3f ms)",
+                      snapshot->lightStats.sources, snapshot->lightStats.changedSources,
+                      snapshot->lightStats.cellsUpdated, renderStats.texelsUploaded,
+                      snapshot->lightStats.lastUpdateMs),
+           10, 164, 10, WHITE);
+  DrawText(TextFormat("Tick %u: sim %.3f ms  snapshot %.3f ms  draw %.3f ms (%d tiles baked)",
+                      snapshot->tick, snapshot->tickMs, snapshot->publishMs, renderStats.lastDrawMs,
+                      renderStats.terrainTilesBaked),
+           10, 178, 10, WHITE);
+  const JobStats *jobs = &snapshot->jobStats;
+  float busiest = 0.0f, total = 0.0f;
+  for (int i = 0; i < jobs->threads; i++)
+  {
+    total += jobs->utilization[i];
+    if (jobs->utilization[i] > busiest)
+      busiest = jobs->utilization[i];
+  }
+  DrawText(TextFormat("Jobs %d threads%s  busy %.0f%% avg %.0f%% max  %d steals",
+                      jobs->threads, jobs->serial ? " (serial, F4)" : "",
+                      jobs->threads > 0 ? total / jobs->threads * 100.0f : 0.0f, busiest * 100.0f, jobs->steals),
+           10, 192, 10, WHITE);
+  const ReplayStats *replay = &snapshot->replayStats;
+  static const char *replayModes[] = {"off", "recording", "playing", "finished"};
+  DrawText(TextFormat("Replay %s  tick %u/%u  %d checkpoints  %ld bytes%s%s", replayModes[replay->mode],
+                      replay->tick, replay->length, replay->checkpoints, replay->bytes,
+                      replay->divergedTick >= 0 ? "  DIVERGED" : "", replay->buildMismatch ? "  (other build)" : ""),
+           10, 206, 10, replay->divergedTick >= 0 ? RED : WHITE);
+  const SaveStateStats *saves = &snapshot->saveStateStats;
+  DrawText(TextFormat("State %.1f MB: save %.3f ms  restore %.3f ms  %d rewind saves (Backspace)",
+                      saves->lastSize / (1024.0f * 1024.0f), saves->lastSaveMs, saves->lastRestoreMs, saves->ringCount),
+           10, 220, 10, WHITE);
+  const FrameArenaStats *arena = &snapshot->frameArenaStats;
+  DrawText(TextFormat("Frame arena %.0f/%.0f KB (peak %.0f KB)  %d mallocs, last at tick %u",
+                      arena->used / 1024.0f, arena->capacity / 1024.0f, arena->highWater / 1024.0f,
+                      arena->heapAllocations, arena->lastHeapTick),
+           10, 234, 10, arena->heapAllocations > 0 ? YELLOW : WHITE);
+  const MemoryStats *memory = &snapshot->memoryStats;
+  float mb = 1024.0f * 1024.0f;
+  DrawText(TextFormat("Memory %.1f/%.0f MB: chunks %.1f  saves %.1f  edits %.2f  window %d  %d trims",
+                      memory->total / mb, memory->budget / mb, memory->used[MEMORY_CHUNKS] / mb,
+                      memory->used[MEMORY_SAVE_STATES] / mb, memory->used[MEMORY_CHUNK_EDITS] / mb,
+                      memory->chunkWindow, memory->trims),
+           10, 248, 10, memory->budget > 0 && memory->total > memory->budget ? YELLOW : WHITE);
+  const ThrottleStats *throttle = &snapshot->throttleStats;
+  if (throttle->budgetMs == 0.0)
+    DrawText("Throttle off", 10, 262, 10, WHITE);
+  else
+    DrawText(TextFormat("Throttle level %d (%s): slowest frame %.1f/%.1f ms, %d changes", throttle->level,
+                        throttleLevelNames[throttle->level], throttle->slowestMs, throttle->budgetMs,
+                        throttle->decisions),
+             10, 262, 10, throttle->level > 0 ? YELLOW : WHITE);
+  DrawText(TextFormat("FPS %d", GetFPS()), 10, 276, 10, WHITE);
+}
+
+void drawUI(const WorldSnapshot *snapshot)
+{
+  const Character *player = &snapshot->player;
+
   // Draw UI background (reduced height)
   DrawRectangle(0, 0, WINDOW_SIZE, 60, Fade(BLACK, 0.7f));
 
   // Left side - Player stats
-  DrawText(TextFormat("HP: %d/%d", player.health, player.maxHealth), 10, 8, 18, WHITE);
-  DrawText(TextFormat("PWR: %d", (int)(player.power * player.damageMultiplier)), 10, 28, 18, WHITE);
-  DrawText(TextFormat("LVL: %d", player.level), 10, 48, 18, WHITE);
+  DrawText(TextFormat("HP: %d/%d", player->health, player->maxHealth), 10, 8, 18, WHITE);
+  DrawText(TextFormat("PWR: %d", (int)(player->power * player->damageMultiplier)), 10, 28, 18, WHITE);
+  DrawText(TextFormat("LVL: %d", player->level), 10, 48, 18, WHITE);
 
   // Middle left - XP and invulnerability
-  DrawText(TextFormat("XP: %d/%d", player.experience, player.experienceToNext), 120, 8, 18, WHITE);
-  if (player.invulnerabilityTimer > 0)
+  DrawText(TextFormat("XP: %d/%d", player->experience, player->experienceToNext), 120, 8, 18, WHITE);
+  if (player->invulnerabilityTimer > 0)
   {
-    int secondsLeft = player.invulnerabilityTimer / 60;
+    int secondsLeft = player->invulnerabilityTimer / 60;
     DrawText(TextFormat("INVUL (%ds)", secondsLeft + 1), 120, 28, 16, YELLOW);
   }
 
   // Middle right - Debug info
-  DrawText(TextFormat("Monsters: %d", monsterCount), 280, 8, 16, YELLOW);
-  DrawText(TextFormat("Powerups: %d", powerupCount), 280, 28, 16, GREEN);
-  DrawText(TextFormat("Landmines: %d", landmineCount), 280, 48, 16, ORANGE);
+  DrawText(TextFormat("Monsters: %d", snapshot->monsterCount), 280, 8, 16, YELLOW);
+  DrawText(TextFormat("Powerups: %d", snapshot->powerupCount), 280, 28, 16, GREEN);
+  DrawText(TextFormat("Landmines: %d", snapshot->landmineCount), 280, 48, 16, ORANGE);
 
   // Right side - Position and restart
-  DrawText(TextFormat("POS: (%d,%d)", (int)player.x, (int)player.y), 450, 8, 16, WHITE);
-  DrawText(player.alive ? "ALIVE" : "DEAD", 450, 28, 16, player.alive ? GREEN : RED);
+  DrawText(TextFormat("POS: (%d,%d)", player->x, player->y), 450, 8, 16, WHITE);
+  DrawText(player->alive ? "ALIVE" : "DEAD", 450, 28, 16, player->alive ? GREEN : RED);
 
   // Restart button (smaller)
   DrawRectangle(WINDOW_SIZE - 100, 8, 90, 25, Fade(BLUE, 0.8f));
@@ -39,13 +133,13 @@ void drawUI()
   DrawText("RESTART (R)", WINDOW_SIZE - 95, 12, 14, WHITE);
 
   // Controls display
-  DrawText("WASD: Move | SPACE: Arrow | SHIFT: Rush | H: Heal | M: Minimap", 10, WINDOW_SIZE - 25, 14, WHITE);
+  DrawText("WASD: Move | Click: Walk to | SPACE: Arrow | SHIFT: Rush | H: Heal | M: Minimap | N: Night | F3: Stats", 10, WINDOW_SIZE - 25, 14, WHITE);
 
   // Powerup status (if active)
-  if (player.powerupTimer > 0)
+  if (player->powerupTimer > 0)
   {
     const char *powerupName;
-    switch (player.activePowerup)
+    switch (player->activePowerup)
     {
     case POWERUP_DOUBLE_DAMAGE:
       powerupName = "2x DAMAGE";
@@ -60,38 +154,41 @@ void drawUI()
       powerupName = "POWERUP";
       break;
     }
-    DrawText(TextFormat("%s (%d)", powerupName, player.powerupTimer / 60), 120, 48, 14, YELLOW);
+    DrawText(TextFormat("%s (%d)", powerupName, player->powerupTimer / 60), 120, 48, 14, YELLOW);
   }
 
   // Ability cooldowns
-  if (player.jumpSmashCooldown > 0)
-    DrawText(TextFormat("1: JUMP (%d)", player.jumpSmashCooldown / 60), 550, 8, 14, RED);
+  if (player->jumpSmashCooldown > 0)
+    DrawText(TextFormat("1: JUMP (%d)", player->jumpSmashCooldown / 60), 550, 8, 14, RED);
   else
     DrawText("1: JUMP", 550, 8, 14, GREEN);
 
-  if (player.rushCooldown > 0)
-    DrawText(TextFormat("2: RUSH (%d)", player.rushCooldown / 60), 550, 28, 14, RED);
+  if (player->rushCooldown > 0)
+    DrawText(TextFormat("2: RUSH (%d)", player->rushCooldown / 60), 550, 28, 14, RED);
   else
     DrawText("2: RUSH", 550, 28, 14, GREEN);
 
-  if (player.healCooldown > 0)
-    DrawText(TextFormat("3: HEAL (%d)", player.healCooldown / 60), 550, 48, 14, RED);
+  if (player->healCooldown > 0)
+    DrawText(TextFormat("3: HEAL (%d)", player->healCooldown / 60), 550, 48, 14, RED);
   else
     DrawText("3: HEAL", 550, 48, 14, GREEN);
 
   // Status effects
-  if (player.stunTimer > 0)
+  if (player->stunTimer > 0)
     DrawText("STUNNED", 350, 8, 16, YELLOW);
-  if (player.dotTimer > 0)
+  if (player->dotTimer > 0)
     DrawText("BURNING", 350, 28, 16, RED);
-  if (player.speedBoostTimer > 0)
+  if (player->speedBoostTimer > 0)
     DrawText("RUSHING!", 350, 48, 16, SKYBLUE);
 
   // Draw minimap (moved to bottom right)
-  drawMinimap();
+  drawMinimap(snapshot);
+
+  if (debugOverlayVisible)
+    drawDebugOverlay(snapshot);
 
   // Game over
-  if (!player.alive)
+  if (!player->alive)
   {
     DrawText("GAME OVER", WINDOW_SIZE / 2 - 100, WINDOW_SIZE / 2, 40, RED);
     DrawText("Press R to restart", WINDOW_SIZE / 2 - 100, WINDOW_SIZE / 2 + 50, 20, WHITE);
@@ -2,8 +2,10 @@
 #define UI_H
 
 #include "types.h"
+#include "snapshot.h"
 
 // Function declarations for UI management
-void drawUI();
+void drawUI(const WorldSnapshot *snapshot);
+void toggleDebugOverlay();
 
 #endif
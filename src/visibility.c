@@ -0,0 +1,194 @@
+#include "types.h"
+#include "globals.h"
+#include "world.h"
+#include "visibility.h"
+#include "platform.h"
+#include <stdlib.h>
+
+// Line of sight over per-chunk opacity bitsets. A line is walked as runs of
+// cells along its major axis (one run per step of the minor axis), and each
+// run is tested against a single 32-bit row or column word per chunk it
+// touches, instead of cell by cell.
+
+#define LOS_CACHE_MAX_FILL (LOS_CACHE_SIZE * 3 / 4)
+
+int isTerrainOpaque(int terrainType)
+{
+  return terrainType == TERRAIN_MOUNTAIN || terrainType == TERRAIN_TREE || terrainType == TERRAIN_BURNING_TREE;
+}
+
+// Bits a..b inclusive
+static unsigned int bitRange(int a, int b)
+{
+  unsigned int upTo = b == CHUNK_SIZE - 1 ? 0xFFFFFFFFu : (1u << (b + 1)) - 1;
+  return upTo & ~((1u << a) - 1);
+}
+
+void buildChunkOpacity(int chunkIndex)
+{
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+
+  for (int i = 0; i < CHUNK_SIZE; i++)
+  {
+    chunk->opaqueRows[i] = 0;
+    chunk->opaqueCols[i] = 0;
+  }
+  for (int x = 0; x < CHUNK_SIZE; x++)
+  {
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      if (isTerrainOpaque(chunk->terrain[x][y]))
+      {
+        chunk->opaqueRows[y] |= 1u << x;
+        chunk->opaqueCols[x] |= 1u << y;
+      }
+    }
+  }
+  invalidateLineOfSight();
+}
+
+// Refreshes only the bits inside a changed rectangle (local cell coordinates)
+void updateChunkOpacity(int chunkIndex, int minX, int minY, int maxX, int maxY)
+{
+  Chunk *chunk = &world->loadedChunks[chunkIndex];
+  unsigned int rowMask = bitRange(minX, maxX);
+  unsigned int colMask = bitRange(minY, maxY);
+
+  for (int y = minY; y <= maxY; y++)
+    chunk->opaqueRows[y] &= ~rowMask;
+  for (int x = minX; x <= maxX; x++)
+  {
+    chunk->opaqueCols[x] &= ~colMask;
+    for (int y = minY; y <= maxY; y++)
+    {
+      if (isTerrainOpaque(chunk->terrain[x][y]))
+      {
+        chunk->opaqueRows[y] |= 1u << x;
+        chunk->opaqueCols[x] |= 1u << y;
+      }
+    }
+  }
+  invalidateLineOfSight();
+}
+
+void invalidateLineOfSight()
+{
+  __atomic_add_fetch(&world->terrainVersion, 1, __ATOMIC_RELAXED); // Chunks build in parallel
+}
+
+// Whether any cell from..to (inclusive, from <= to) along the given world
+// row (horizontal) or column is opaque. Unloaded terrain blocks sight.
+static int spanBlocked(int fixed, int from, int to, int horizontal)
+{
+  while (from <= to)
+  {
+    WorldPosition pos = horizontal ? worldToChunk(from, fixed) : worldToChunk(fixed, from);
+    int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
+    if (chunkIndex == -1)
+      return 1;
+
+    int local = horizontal ? pos.localX : pos.localY;
+    int localEnd = local + (to - from);
+    if (localEnd > CHUNK_SIZE - 1)
+      localEnd = CHUNK_SIZE - 1;
+
+    const Chunk *chunk = &world->loadedChunks[chunkIndex];
+    unsigned int word = horizontal ? chunk->opaqueRows[pos.localY] : chunk->opaqueCols[pos.localX];
+    if (word & bitRange(local, localEnd))
+      return 1;
+
+    from += localEnd - local + 1;
+  }
+  return 0;
+}
+
+int hasLineOfSight(int fromX, int fromY, int toX, int toY)
+{
+  int dx = toX - fromX;
+  int dy = toY - fromY;
+  int horizontal = abs(dx) >= abs(dy);
+
+  // Walk in major/minor axis terms; major is x for shallow lines, y for steep
+  int major0 = horizontal ? fromX : fromY;
+  int minor0 = horizontal ? fromY : fromX;
+  int majorLength = horizontal ? abs(dx) : abs(dy);
+  int minorLength = horizontal ? abs(dy) : abs(dx);
+  int majorStep = (horizontal ? dx : dy) < 0 ? -1 : 1;
+  int minorStep = (horizontal ? dy : dx) < 0 ? -1 : 1;
+
+  // Step i along the major axis sits at minor offset round(i * minor / major).
+  // Minor offset k therefore covers major steps from ceil((2k - 1) * major / (2 * minor)).
+  // The two endpoints (shooter and target cells) never block.
+  for (int k = 0; k <= minorLength; k++)
+  {
+    int first = k == 0 ? 0 : ((2 * k - 1) * majorLength + 2 * minorLength - 1) / (2 * minorLength);
+    int last = k == minorLength ? majorLength : ((2 * k + 1) * majorLength + 2 * minorLength - 1) / (2 * minorLength) - 1;
+    if (first < 1)
+      first = 1;
+    if (last > majorLength - 1)
+      last = majorLength - 1;
+    if (first > last)
+      continue;
+
+    int a = major0 + majorStep * first;
+    int b = major0 + majorStep * last;
+    if (spanBlocked(minor0 + minorStep * k, a < b ? a : b, a < b ? b : a, horizontal))
+      return 0;
+  }
+  return 1;
+}
+
+static unsigned int losCacheSlot(int x, int y)
+{
+  unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u;
+  return (h ^ (h >> 13)) & (LOS_CACHE_SIZE - 1);
+}
+
+// Visibility of many shooters against one target, e.g. every ranged monster
+// about to fire at the player this frame
+void batchLineOfSight(const int *fromX, const int *fromY, int count, int toX, int toY, unsigned char *visible)
+{
+  double batchStart = platformTimer();
+
+  if (toX != world->losCacheTargetX || toY != world->losCacheTargetY || world->losCacheVersion != world->terrainVersion ||
+      world->losCacheFill >= LOS_CACHE_MAX_FILL)
+  {
+    world->losCacheStamp++;
+    world->losCacheFill = 0;
+    world->losCacheTargetX = toX;
+    world->losCacheTargetY = toY;
+    world->losCacheVersion = world->terrainVersion;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    unsigned int slot = losCacheSlot(fromX[i], fromY[i]);
+    while (world->losCache[slot].stamp == world->losCacheStamp &&
+           (world->losCache[slot].x != fromX[i] || world->losCache[slot].y != fromY[i]))
+      slot = (slot + 1) & (LOS_CACHE_SIZE - 1);
+
+    LosCacheEntry *entry = &world->losCache[slot];
+    if (entry->stamp == world->losCacheStamp)
+    {
+      world->losStats.cacheHits++;
+    }
+    else if (world->losCacheFill < LOS_CACHE_MAX_FILL)
+    {
+      entry->stamp = world->losCacheStamp;
+      entry->x = fromX[i];
+      entry->y = fromY[i];
+      entry->visible = (unsigned char)hasLineOfSight(fromX[i], fromY[i], toX, toY);
+      world->losCacheFill++;
+    }
+    else
+    {
+      visible[i] = (unsigned char)hasLineOfSight(fromX[i], fromY[i], toX, toY);
+      continue;
+    }
+    visible[i] = entry->visible;
+  }
+
+  world->losStats.queries += count;
+  world->losStats.lastBatchSize = count;
+  world->losStats.lastBatchMs = (platformTimer() - batchStart) * 1000.0;
+}
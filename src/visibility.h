@@ -0,0 +1,32 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include "types.h"
+
+#define LOS_CACHE_SIZE 4096 // Entries in the per-target result cache (power of two)
+
+// Line-of-sight statistics
+typedef struct
+{
+  int queries;        // Batched LOS queries so far
+  int cacheHits;      // Batched queries answered from the per-target cache
+  int lastBatchSize;  // Shooters in the most recent batch
+  double lastBatchMs; // Wall time of the most recent batch
+} LosStats;
+
+typedef struct
+{
+  int x, y;
+  unsigned int stamp;
+  unsigned char visible;
+} LosCacheEntry;
+
+// Function declarations for line of sight
+int isTerrainOpaque(int terrainType);
+void buildChunkOpacity(int chunkIndex);
+void updateChunkOpacity(int chunkIndex, int minX, int minY, int maxX, int maxY);
+void invalidateLineOfSight();
+int hasLineOfSight(int fromX, int fromY, int toX, int toY);
+void batchLineOfSight(const int *fromX, const int *fromY, int count, int toX, int toY, unsigned char *visible);
+
+#endif
@@ -1,6 +1,19 @@
 #include "types.h"
 #include "globals.h"
+#include "pathfinding.h"
+#include "visibility.h"
+#include "terrain.h"
+#include "fire.h"
+#include "lighting.h"
+#include "monsters.h"
+#include "platform.h"
+#include "jobs.h"
+#include "rng.h"
+#include "savestate.h"
+#include "throttle.h"
+#include "tunables.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 
@@ -8,6 +21,8 @@
 void unloadChunkEntities(int chunkIndex);
 void generateChunkContent(int chunkX, int chunkY);
 void generateChunkTerrain(int chunkX, int chunkY);
+static void buildChunkTerrain(int chunkIndex);
+static void spawnChunkEntities(int chunkIndex);
 
 // World position conversion
 WorldPosition worldToChunk(int worldX, int worldY)
@@ -43,60 +58,140 @@ WorldPosition worldToChunk(int worldX, int worldY)
 }
 
 // Chunk management
+static unsigned int chunkHash(int chunkX, int chunkY)
+{
+  return ((unsigned int)chunkX * 73856093u ^ (unsigned int)chunkY * 19349663u) & (CHUNK_LOOKUP_SIZE - 1);
+}
+
 int getChunkIndex(int chunkX, int chunkY)
 {
-  for (int i = 0; i < loadedChunkCount; i++)
+  unsigned int slot = chunkHash(chunkX, chunkY);
+
+  while (world->chunkLookup[slot] != 0)
   {
-    if (loadedChunks[i].chunkX == chunkX && loadedChunks[i].chunkY == chunkY)
+    int i = world->chunkLookup[slot] - 1;
+    if (i < world->loadedChunkCount && world->loadedChunks[i].chunkX == chunkX && world->loadedChunks[i].chunkY == chunkY)
     {
       return i;
     }
+    slot = (slot + 1) & (CHUNK_LOOKUP_SIZE - 1);
   }
   return -1;
 }
 
-int loadChunk(int chunkX, int chunkY)
+static void insertChunkLookup(int chunkIndex)
 {
-  // Check if chunk is already loaded
-  if (getChunkIndex(chunkX, chunkY) != -1)
-    return 1;
+  unsigned int slot = chunkHash(world->loadedChunks[chunkIndex].chunkX, world->loadedChunks[chunkIndex].chunkY);
+
+  while (world->chunkLookup[slot] != 0)
+    slot = (slot + 1) & (CHUNK_LOOKUP_SIZE - 1);
+  world->chunkLookup[slot] = chunkIndex + 1;
+}
+
+static void removeChunkLookup(int chunkIndex)
+{
+  unsigned int slot = chunkHash(world->loadedChunks[chunkIndex].chunkX, world->loadedChunks[chunkIndex].chunkY);
+
+  while (world->chunkLookup[slot] != chunkIndex + 1)
+  {
+    if (world->chunkLookup[slot] == 0)
+      return;
+    slot = (slot + 1) & (CHUNK_LOOKUP_SIZE - 1);
+  }
+  world->chunkLookup[slot] = 0;
+
+  // Shift later entries of the probe run back so lookups never stop early
+  unsigned int next = (slot + 1) & (CHUNK_LOOKUP_SIZE - 1);
+  while (world->chunkLookup[next] != 0)
+  {
+    int i = world->chunkLookup[next] - 1;
+    unsigned int home = chunkHash(world->loadedChunks[i].chunkX, world->loadedChunks[i].chunkY);
+    int homeInRun = (slot <= next) ? (home > slot && home <= next) : (home > slot || home <= next);
+
+    if (!homeInRun)
+    {
+      world->chunkLookup[slot] = world->chunkLookup[next];
+      world->chunkLookup[next] = 0;
+      slot = next;
+    }
+    next = (next + 1) & (CHUNK_LOOKUP_SIZE - 1);
+  }
+}
+
+void resetChunkLookup()
+{
+  memset(world->chunkLookup, 0, sizeof(world->chunkLookup));
+}
+
+// Removes entities in a chunk being unloaded, keeping any terrain edits
+static void evictChunk(int chunkIndex)
+{
+  unloadChunkEntities(chunkIndex);
+  extinguishChunk(chunkIndex);
+  saveChunkEdits(chunkIndex);
+  removeChunkLookup(chunkIndex);
+}
+
+// Gives a chunk a slot (evicting the least recently used one when full)
+// without generating anything yet; returns the slot, or -1 if there are none
+static int claimChunkSlot(int chunkX, int chunkY)
+{
+  if (world->loadedChunkCapacity == 0)
+    return -1;
 
   // If we're at max capacity, unload the least recently used chunk
-  if (loadedChunkCount >= MAX_LOADED_CHUNKS)
+  if (world->loadedChunkCount >= world->loadedChunkCapacity)
   {
     int oldestIndex = 0;
-    int oldestAccess = loadedChunks[0].lastAccess;
+    int oldestAccess = world->loadedChunks[0].lastAccess;
 
-    for (int i = 1; i < loadedChunkCount; i++)
+    for (int i = 1; i < world->loadedChunkCount; i++)
     {
-      if (loadedChunks[i].lastAccess < oldestAccess)
+      if (world->loadedChunks[i].lastAccess < oldestAccess)
       {
-        oldestAccess = loadedChunks[i].lastAccess;
+        oldestAccess = world->loadedChunks[i].lastAccess;
         oldestIndex = i;
       }
     }
 
-    // Remove entities in the chunk being unloaded
-    unloadChunkEntities(oldestIndex);
+    evictChunk(oldestIndex);
 
     // Replace the oldest chunk
-    loadedChunks[oldestIndex].chunkX = chunkX;
-    loadedChunks[oldestIndex].chunkY = chunkY;
-    loadedChunks[oldestIndex].loaded = 1;
-    loadedChunks[oldestIndex].lastAccess = (int)(GetTime() * 1000);
+    world->loadedChunks[oldestIndex].chunkX = chunkX;
+    world->loadedChunks[oldestIndex].chunkY = chunkY;
+    world->loadedChunks[oldestIndex].loaded = 1;
+    world->loadedChunks[oldestIndex].portalsValid = 0;
+    world->loadedChunks[oldestIndex].revision = nextTerrainRevision();
+    insertChunkLookup(oldestIndex);
+    world->loadedChunks[oldestIndex].lastAccess = (int)world->gameTick;
+
+    return oldestIndex;
+  }
 
-    // Generate content for the new chunk
-    generateChunkContent(chunkX, chunkY);
+  // Load new chunk
+  world->loadedChunks[world->loadedChunkCount].chunkX = chunkX;
+  world->loadedChunks[world->loadedChunkCount].chunkY = chunkY;
+  world->loadedChunks[world->loadedChunkCount].loaded = 1;
+  world->loadedChunks[world->loadedChunkCount].lastAccess = (int)world->gameTick;
+  world->loadedChunks[world->loadedChunkCount].portalsValid = 0;
+  world->loadedChunks[world->loadedChunkCount].dirty = 0;
+  world->loadedChunks[world->loadedChunkCount].modified = 0;
+  world->loadedChunks[world->loadedChunkCount].burningCells = 0;
+  world->loadedChunks[world->loadedChunkCount].revision = nextTerrainRevision();
+  world->loadedChunkCount++;
+  insertChunkLookup(world->loadedChunkCount - 1);
+
+  return world->loadedChunkCount - 1;
+}
 
+int loadChunk(int chunkX, int chunkY)
+{
+  // Check if chunk is already loaded
+  if (getChunkIndex(chunkX, chunkY) != -1)
     return 1;
-  }
 
-  // Load new chunk
-  loadedChunks[loadedChunkCount].chunkX = chunkX;
-  loadedChunks[loadedChunkCount].chunkY = chunkY;
-  loadedChunks[loadedChunkCount].loaded = 1;
-  loadedChunks[loadedChunkCount].lastAccess = (int)(GetTime() * 1000);
-  loadedChunkCount++;
+  if (claimChunkSlot(chunkX, chunkY) == -1)
+    return 0;
 
   // Generate content for this chunk
   generateChunkContent(chunkX, chunkY);
@@ -106,58 +201,58 @@ int loadChunk(int chunkX, int chunkY)
 
 void unloadChunkEntities(int chunkIndex)
 {
-  int chunkX = loadedChunks[chunkIndex].chunkX;
-  int chunkY = loadedChunks[chunkIndex].chunkY;
+  int chunkX = world->loadedChunks[chunkIndex].chunkX;
+  int chunkY = world->loadedChunks[chunkIndex].chunkY;
 
   // Remove monsters in this chunk (but keep ones near player)
-  for (int i = 0; i < monsterCount; i++)
+  for (int i = 0; i < world->monsterCount; i++)
   {
-    WorldPosition pos = worldToChunk(monsters[i].x, monsters[i].y);
+    WorldPosition pos = worldToChunk(world->monsters[i].x, world->monsters[i].y);
     if (pos.chunkX == chunkX && pos.chunkY == chunkY)
     {
-      float dx = monsters[i].x - player.x;
-      float dy = monsters[i].y - player.y;
+      float dx = world->monsters[i].x - world->player.x;
+      float dy = world->monsters[i].y - world->player.y;
       float distance = sqrt(dx * dx + dy * dy);
 
       if (distance > 200)
       {
-        monsters[i] = monsters[--monsterCount];
+        removeMonster(i);
         i--;
       }
     }
   }
 
   // Remove powerups in this chunk (but keep ones near player)
-  for (int i = 0; i < powerupCount; i++)
+  for (int i = 0; i < world->powerupCount; i++)
   {
-    WorldPosition pos = worldToChunk(powerups[i].x, powerups[i].y);
+    WorldPosition pos = worldToChunk(world->powerups[i].x, world->powerups[i].y);
     if (pos.chunkX == chunkX && pos.chunkY == chunkY)
     {
-      float dx = powerups[i].x - player.x;
-      float dy = powerups[i].y - player.y;
+      float dx = world->powerups[i].x - world->player.x;
+      float dy = world->powerups[i].y - world->player.y;
       float distance = sqrt(dx * dx + dy * dy);
 
       if (distance > 200)
       {
-        powerups[i] = powerups[--powerupCount];
+        world->powerups[i] = world->powerups[--world->powerupCount];
         i--;
       }
     }
   }
 
   // Remove landmines in this chunk (but keep ones near player)
-  for (int i = 0; i < landmineCount; i++)
+  for (int i = 0; i < world->landmineCount; i++)
   {
-    WorldPosition pos = worldToChunk(landmines[i].x, landmines[i].y);
+    WorldPosition pos = worldToChunk(world->landmines[i].x, world->landmines[i].y);
     if (pos.chunkX == chunkX && pos.chunkY == chunkY)
     {
-      float dx = landmines[i].x - player.x;
-      float dy = landmines[i].y - player.y;
+      float dx = world->landmines[i].x - world->player.x;
+      float dy = world->landmines[i].y - world->player.y;
       float distance = sqrt(dx * dx + dy * dy);
 
       if (distance > 200)
       {
-        landmines[i] = landmines[--landmineCount];
+        world->landmines[i] = world->landmines[--world->landmineCount];
         i--;
       }
     }
@@ -170,8 +265,18 @@ void generateChunkTerrain(int chunkX, int chunkY)
   if (chunkIndex == -1)
     return;
 
-  // Use chunk coordinates as seed for consistent terrain generation
-  srand(chunkX * 10000 + chunkY);
+  buildChunkTerrain(chunkIndex);
+}
+
+// Terrain and per-chunk caches for one slot. Touches nothing outside the
+// chunk, so slots can be built in parallel.
+static void buildChunkTerrain(int chunkIndex)
+{
+  int chunkX = world->loadedChunks[chunkIndex].chunkX;
+  int chunkY = world->loadedChunks[chunkIndex].chunkY;
+
+  // Use chunk coordinates as the noise stream for consistent terrain generation
+  uint32_t stream = (uint32_t)(chunkX * 10000 + chunkY);
 
   for (int x = 0; x < CHUNK_SIZE; x++)
   {
@@ -184,35 +289,54 @@ void generateChunkTerrain(int chunkX, int chunkY)
       // Create varied terrain using multiple noise layers
       float noise1 = sin(worldX * 0.01f) * cos(worldY * 0.01f);
       float noise2 = sin(worldX * 0.05f + worldY * 0.03f) * 0.5f;
-      float noise3 = (rand() % 100) / 100.0f * 0.3f;
+      float noise3 = rngRange(rngSeed(RNG_TERRAIN), stream, x * CHUNK_SIZE + y, 100) / 100.0f * 0.3f;
 
       float combinedNoise = noise1 + noise2 + noise3;
 
       // Determine terrain type based on noise
       if (combinedNoise > 0.8f)
-        loadedChunks[chunkIndex].terrain[x][y] = 1; // Mountain
+        world->loadedChunks[chunkIndex].terrain[x][y] = 1; // Mountain
       else if (combinedNoise > 0.3f)
-        loadedChunks[chunkIndex].terrain[x][y] = 2; // Tree
+        world->loadedChunks[chunkIndex].terrain[x][y] = 2; // Tree
       else if (combinedNoise > -0.2f)
-        loadedChunks[chunkIndex].terrain[x][y] = 0; // Grass
+        world->loadedChunks[chunkIndex].terrain[x][y] = 0; // Grass
       else if (combinedNoise > -0.8f)
-        loadedChunks[chunkIndex].terrain[x][y] = 3; // Lake
+        world->loadedChunks[chunkIndex].terrain[x][y] = 3; // Lake
       else
-        loadedChunks[chunkIndex].terrain[x][y] = 4; // Sea
+        world->loadedChunks[chunkIndex].terrain[x][y] = 4; // Sea
     }
   }
+
+  // Bring back any edits made before this chunk was last unloaded
+  restoreChunkEdits(chunkIndex);
+
+  // Cache border portals and their distances for pathfinding
+  buildChunkPortals(chunkIndex);
+  buildChunkOpacity(chunkIndex);
+  resetChunkLight(chunkIndex);
 }
 
 void generateChunkContent(int chunkX, int chunkY)
 {
-  // Generate terrain first
-  generateChunkTerrain(chunkX, chunkY);
-
   // Get chunk index for terrain access
   int chunkIndex = getChunkIndex(chunkX, chunkY);
   if (chunkIndex == -1)
     return;
 
+  // Generate terrain first
+  buildChunkTerrain(chunkIndex);
+  spawnChunkEntities(chunkIndex);
+}
+
+// Entities based on the chunk's terrain, rolled from a stream keyed by the
+// chunk and the tick it loaded (still populated one at a time, in load order,
+// because spawning appends to the shared entity arrays)
+static void spawnChunkEntities(int chunkIndex)
+{
+  int chunkX = world->loadedChunks[chunkIndex].chunkX;
+  int chunkY = world->loadedChunks[chunkIndex].chunkY;
+  RngStream random = rngStream(rngDerive(rngSeed(RNG_CHUNK_CONTENT), world->gameTick), rngCellKey(chunkX, chunkY));
+
   // Generate entities based on terrain
   for (int x = 0; x < CHUNK_SIZE; x++)
   {
@@ -220,60 +344,35 @@ void generateChunkContent(int chunkX, int chunkY)
     {
       int worldX = chunkX * CHUNK_SIZE + x;
       int worldY = chunkY * CHUNK_SIZE + y;
-      int terrainType = loadedChunks[chunkIndex].terrain[x][y];
+      int terrainType = world->loadedChunks[chunkIndex].terrain[x][y];
 
       // Spawn entities based on terrain type and random chance
-      if (rand() % 100 < 2) // 2% chance per cell
+      if (rngNext(&random, 100) < 2) // 2% chance per cell
       {
         if (terrainType == 0 || terrainType == 2) // Grass or trees - spawn monsters
         {
-          if (monsterCount < MAX_MONSTERS)
-          {
-            monsters[monsterCount].x = worldX;
-            monsters[monsterCount].y = worldY;
-            monsters[monsterCount].health = 20 + rand() % 30;
-            monsters[monsterCount].maxHealth = monsters[monsterCount].health;
-            monsters[monsterCount].power = 3 + rand() % 5;
-            monsters[monsterCount].textureIndex = 1 + (rand() % 5);
-            monsters[monsterCount].alive = 1;
-            monsters[monsterCount].speed = 1;
-            monsters[monsterCount].speedMultiplier = 1.0f;
-            monsters[monsterCount].damageMultiplier = 1.0f;
-            monsters[monsterCount].powerupTimer = 0;
-            monsters[monsterCount].movementCooldown = 0;
-            monsters[monsterCount].level = 1;
-            monsters[monsterCount].experience = 0;
-            monsters[monsterCount].experienceToNext = 100;
-            monsters[monsterCount].isInCombat = 0;
-            monsters[monsterCount].invulnerabilityTimer = 0;
-            monsters[monsterCount].stunTimer = 0;
-            monsters[monsterCount].dotTimer = 0;
-            monsters[monsterCount].dotDamage = 0;
-            monsters[monsterCount].speedBoostTimer = 0;
-            monsters[monsterCount].deathTimer = 0;
-            monsterCount++;
-          }
+          spawnMonster(randomArchetype(&random), worldX, worldY);
         }
         else if (terrainType == 1) // Mountains - spawn powerups
         {
-          if (powerupCount < MAX_POWERUPS)
+          if (world->powerupCount < MAX_POWERUPS)
           {
-            powerups[powerupCount].x = worldX;
-            powerups[powerupCount].y = worldY;
-            powerups[powerupCount].type = rand() % POWERUP_COUNT;
-            powerups[powerupCount].active = 1;
-            powerupCount++;
+            world->powerups[world->powerupCount].x = worldX;
+            world->powerups[world->powerupCount].y = worldY;
+            world->powerups[world->powerupCount].type = rngNext(&random, POWERUP_COUNT);
+            world->powerups[world->powerupCount].active = 1;
+            world->powerupCount++;
           }
         }
         else if (terrainType == 3 || terrainType == 4) // Lakes or seas - spawn landmines
         {
-          if (landmineCount < MAX_LANDMINES)
+          if (world->landmineCount < MAX_LANDMINES)
           {
-            landmines[landmineCount].x = worldX;
-            landmines[landmineCount].y = worldY;
-            landmines[landmineCount].damage = 15 + rand() % 10;
-            landmines[landmineCount].active = 1;
-            landmineCount++;
+            world->landmines[world->landmineCount].x = worldX;
+            world->landmines[world->landmineCount].y = worldY;
+            world->landmines[world->landmineCount].damage = 15 + rngNext(&random, 10);
+            world->landmines[world->landmineCount].active = 1;
+            world->landmineCount++;
           }
         }
       }
@@ -281,43 +380,78 @@ void generateChunkContent(int chunkX, int chunkY)
   }
 }
 
-void updateChunks()
+static void buildTerrainRange(int begin, int end, void *context)
 {
-  // Load chunks around player
-  int playerChunkX = player.x / CHUNK_SIZE;
-  int playerChunkY = player.y / CHUNK_SIZE;
+  (void)context;
+  for (int i = begin; i < end; i++)
+    buildChunkTerrain(world->pendingChunks[i]);
+}
 
-  for (int dx = -CHUNK_LOAD_DISTANCE; dx <= CHUNK_LOAD_DISTANCE; dx++)
+void updateChunks()
+{
+  // Load chunks around player: claim slots for the missing ones, build their
+  // terrain in parallel, then populate them in order. While the frame
+  // governor slices chunk loading, only a few of the chunks outside
+  // CHUNK_MIN_LOAD_DISTANCE (which nothing near the player needs yet) load
+  // per frame; the rest follow on later frames.
+  int playerChunkX = world->player.x / CHUNK_SIZE;
+  int playerChunkY = world->player.y / CHUNK_SIZE;
+  int pendingCount = 0;
+  int farBudget = throttled(THROTTLE_CHUNK_SLICES) ? THROTTLE_CHUNK_SLICE : MAX_LOADED_CHUNKS;
+
+  for (int dx = -world->chunkLoadDistance; dx <= world->chunkLoadDistance; dx++)
   {
-    for (int dy = -CHUNK_LOAD_DISTANCE; dy <= CHUNK_LOAD_DISTANCE; dy++)
+    for (int dy = -world->chunkLoadDistance; dy <= world->chunkLoadDistance; dy++)
     {
-      loadChunk(playerChunkX + dx, playerChunkY + dy);
+      if (getChunkIndex(playerChunkX + dx, playerChunkY + dy) != -1)
+        continue;
+      if (abs(dx) > CHUNK_MIN_LOAD_DISTANCE || abs(dy) > CHUNK_MIN_LOAD_DISTANCE)
+      {
+        if (farBudget == 0)
+          continue;
+        farBudget--;
+      }
+      int slot = claimChunkSlot(playerChunkX + dx, playerChunkY + dy);
+      if (slot != -1)
+        world->pendingChunks[pendingCount++] = slot;
     }
   }
 
+  parallelFor(pendingCount, 1, buildTerrainRange, NULL);
+  for (int i = 0; i < pendingCount; i++)
+    spawnChunkEntities(world->pendingChunks[i]);
+
   // Update last access times for loaded chunks
-  for (int i = 0; i < loadedChunkCount; i++)
+  for (int i = 0; i < world->loadedChunkCount; i++)
   {
-    if (loadedChunks[i].loaded)
+    if (world->loadedChunks[i].loaded)
     {
-      loadedChunks[i].lastAccess = (int)(GetTime() * 1000);
+      world->loadedChunks[i].lastAccess = (int)world->gameTick;
     }
   }
 }
 
+// Placement rounds per frame before a spawner gives up (its distance band
+// may not fit the search area); fewer while the frame governor sheds spawning
+static int spawnRoundLimit()
+{
+  int rounds = world->tunables[TUNE_SPAWN_ROUNDS].value;
+  return throttled(THROTTLE_SPAWNS) && rounds > THROTTLE_SPAWN_ROUNDS ? THROTTLE_SPAWN_ROUNDS : rounds;
+}
+
 void ensureNearbyMonsters()
 {
-  int playerChunkX = player.x / CHUNK_SIZE;
-  int playerChunkY = player.y / CHUNK_SIZE;
+  int playerChunkX = world->player.x / CHUNK_SIZE;
+  int playerChunkY = world->player.y / CHUNK_SIZE;
 
   // Count monsters in nearby chunks
   int nearbyMonsterCount = 0;
-  for (int i = 0; i < monsterCount; i++)
+  for (int i = 0; i < world->monsterCount; i++)
   {
-    if (monsters[i].alive)
+    if (world->monsters[i].alive)
     {
-      int monsterChunkX = monsters[i].x / CHUNK_SIZE;
-      int monsterChunkY = monsters[i].y / CHUNK_SIZE;
+      int monsterChunkX = world->monsters[i].x / CHUNK_SIZE;
+      int monsterChunkY = world->monsters[i].y / CHUNK_SIZE;
       int dx = abs(monsterChunkX - playerChunkX);
       int dy = abs(monsterChunkY - playerChunkY);
 
@@ -329,11 +463,15 @@ void ensureNearbyMonsters()
   }
 
   // Spawn more monsters if needed
-  while (nearbyMonsterCount < 50 && monsterCount < MAX_MONSTERS)
+  RngStream random = rngStream(rngDerive(rngSeed(RNG_SPAWN), world->gameTick), 0);
+  int spawnRounds = 0;
+  int wanted = world->tunables[TUNE_NEARBY_MONSTERS].value;
+  int rounds = spawnRoundLimit();
+  while (nearbyMonsterCount < wanted && world->monsterCount < world->tunables[TUNE_MAX_MONSTERS].value && spawnRounds++ < rounds)
   {
     // Find a random position in nearby chunks
-    int offsetX = (rand() % 5) - 2; // -2 to +2 chunks
-    int offsetY = (rand() % 5) - 2;
+    int offsetX = rngNext(&random, 5) - 2; // -2 to +2 chunks
+    int offsetY = rngNext(&random, 5) - 2;
     int spawnChunkX = playerChunkX + offsetX;
     int spawnChunkY = playerChunkY + offsetY;
 
@@ -343,25 +481,27 @@ void ensureNearbyMonsters()
     // Find a suitable spawn position
     for (int attempts = 0; attempts < 10; attempts++)
     {
-      int localX = rand() % CHUNK_SIZE;
-      int localY = rand() % CHUNK_SIZE;
+      int localX = rngNext(&random, CHUNK_SIZE);
+      int localY = rngNext(&random, CHUNK_SIZE);
       int worldX = spawnChunkX * CHUNK_SIZE + localX;
       int worldY = spawnChunkY * CHUNK_SIZE + localY;
 
       // Check distance from player
-      float dx = worldX - player.x;
-      float dy = worldY - player.y;
+      float dx = worldX - world->player.x;
+      float dy = worldY - world->player.y;
       float distance = sqrt(dx * dx + dy * dy);
 
-      if (distance > 50 && distance < 300) // Not too close, not too far
+      // Not too close, not too far
+      if (distance > world->tunables[TUNE_MONSTER_SPAWN_MIN].value &&
+          distance < world->tunables[TUNE_MONSTER_SPAWN_MAX].value)
       {
         // Check if position is free
         int positionFree = 1;
-        for (int j = 0; j < monsterCount; j++)
+        for (int j = 0; j < world->monsterCount; j++)
         {
-          if (monsters[j].alive &&
-              abs(monsters[j].x - worldX) <= 1 &&
-              abs(monsters[j].y - worldY) <= 1)
+          if (world->monsters[j].alive &&
+              abs(world->monsters[j].x - worldX) <= 1 &&
+              abs(world->monsters[j].y - worldY) <= 1)
           {
             positionFree = 0;
             break;
@@ -370,29 +510,7 @@ void ensureNearbyMonsters()
 
         if (positionFree)
         {
-          monsters[monsterCount].x = worldX;
-          monsters[monsterCount].y = worldY;
-          monsters[monsterCount].health = 20 + rand() % 30;
-          monsters[monsterCount].maxHealth = monsters[monsterCount].health;
-          monsters[monsterCount].power = 3 + rand() % 5;
-          monsters[monsterCount].textureIndex = 1 + (rand() % 5);
-          monsters[monsterCount].alive = 1;
-          monsters[monsterCount].speed = 1;
-          monsters[monsterCount].speedMultiplier = 1.0f;
-          monsters[monsterCount].damageMultiplier = 1.0f;
-          monsters[monsterCount].powerupTimer = 0;
-          monsters[monsterCount].movementCooldown = 0;
-          monsters[monsterCount].level = 1;
-          monsters[monsterCount].experience = 0;
-          monsters[monsterCount].experienceToNext = 100;
-          monsters[monsterCount].isInCombat = 0;
-          monsters[monsterCount].invulnerabilityTimer = 0;
-          monsters[monsterCount].stunTimer = 0;
-          monsters[monsterCount].dotTimer = 0;
-          monsters[monsterCount].dotDamage = 0;
-          monsters[monsterCount].speedBoostTimer = 0;
-          monsters[monsterCount].deathTimer = 0;
-          monsterCount++;
+          spawnMonster(randomArchetype(&random), worldX, worldY);
           nearbyMonsterCount++;
           break;
         }
@@ -403,17 +521,17 @@ void ensureNearbyMonsters()
 
 void ensureNearbyPowerups()
 {
-  int playerChunkX = player.x / CHUNK_SIZE;
-  int playerChunkY = player.y / CHUNK_SIZE;
+  int playerChunkX = world->player.x / CHUNK_SIZE;
+  int playerChunkY = world->player.y / CHUNK_SIZE;
 
   // Count powerups in nearby chunks
   int nearbyPowerupCount = 0;
-  for (int i = 0; i < powerupCount; i++)
+  for (int i = 0; i < world->powerupCount; i++)
   {
-    if (powerups[i].active)
+    if (world->powerups[i].active)
     {
-      int powerupChunkX = powerups[i].x / CHUNK_SIZE;
-      int powerupChunkY = powerups[i].y / CHUNK_SIZE;
+      int powerupChunkX = world->powerups[i].x / CHUNK_SIZE;
+      int powerupChunkY = world->powerups[i].y / CHUNK_SIZE;
       int dx = abs(powerupChunkX - playerChunkX);
       int dy = abs(powerupChunkY - playerChunkY);
 
@@ -425,10 +543,14 @@ void ensureNearbyPowerups()
   }
 
   // Spawn more powerups if needed
-  while (nearbyPowerupCount < 5 && powerupCount < MAX_POWERUPS)
+  RngStream random = rngStream(rngDerive(rngSeed(RNG_SPAWN), world->gameTick), 1);
+  int spawnRounds = 0;
+  int wanted = world->tunables[TUNE_NEARBY_POWERUPS].value;
+  int rounds = spawnRoundLimit();
+  while (nearbyPowerupCount < wanted && world->powerupCount < MAX_POWERUPS && spawnRounds++ < rounds)
   {
-    int offsetX = (rand() % 5) - 2;
-    int offsetY = (rand() % 5) - 2;
+    int offsetX = rngNext(&random, 5) - 2;
+    int offsetY = rngNext(&random, 5) - 2;
     int spawnChunkX = playerChunkX + offsetX;
     int spawnChunkY = playerChunkY + offsetY;
 
@@ -436,23 +558,24 @@ void ensureNearbyPowerups()
 
     for (int attempts = 0; attempts < 10; attempts++)
     {
-      int localX = rand() % CHUNK_SIZE;
-      int localY = rand() % CHUNK_SIZE;
+      int localX = rngNext(&random, CHUNK_SIZE);
+      int localY = rngNext(&random, CHUNK_SIZE);
       int worldX = spawnChunkX * CHUNK_SIZE + localX;
       int worldY = spawnChunkY * CHUNK_SIZE + localY;
 
-      float dx = worldX - player.x;
-      float dy = worldY - player.y;
+      float dx = worldX - world->player.x;
+      float dy = worldY - world->player.y;
       float distance = sqrt(dx * dx + dy * dy);
 
-      if (distance > 100 && distance < 400)
+      if (distance > world->tunables[TUNE_POWERUP_SPAWN_MIN].value &&
+          distance < world->tunables[TUNE_POWERUP_SPAWN_MAX].value)
       {
         int positionFree = 1;
-        for (int j = 0; j < powerupCount; j++)
+        for (int j = 0; j < world->powerupCount; j++)
         {
-          if (powerups[j].active &&
-              abs(powerups[j].x - worldX) <= 2 &&
-              abs(powerups[j].y - worldY) <= 2)
+          if (world->powerups[j].active &&
+              abs(world->powerups[j].x - worldX) <= 2 &&
+              abs(world->powerups[j].y - worldY) <= 2)
           {
             positionFree = 0;
             break;
@@ -461,11 +584,11 @@ void ensureNearbyPowerups()
 
         if (positionFree)
         {
-          powerups[powerupCount].x = worldX;
-          powerups[powerupCount].y = worldY;
-          powerups[powerupCount].type = rand() % POWERUP_COUNT;
-          powerups[powerupCount].active = 1;
-          powerupCount++;
+          world->powerups[world->powerupCount].x = worldX;
+          world->powerups[world->powerupCount].y = worldY;
+          world->powerups[world->powerupCount].type = rngNext(&random, POWERUP_COUNT);
+          world->powerups[world->powerupCount].active = 1;
+          world->powerupCount++;
           nearbyPowerupCount++;
           break;
         }
@@ -476,17 +599,17 @@ void ensureNearbyPowerups()
 
 void ensureNearbyLandmines()
 {
-  int playerChunkX = player.x / CHUNK_SIZE;
-  int playerChunkY = player.y / CHUNK_SIZE;
+  int playerChunkX = world->player.x / CHUNK_SIZE;
+  int playerChunkY = world->player.y / CHUNK_SIZE;
 
   // Count landmines in nearby chunks
   int nearbyLandmineCount = 0;
-  for (int i = 0; i < landmineCount; i++)
+  for (int i = 0; i < world->landmineCount; i++)
   {
-    if (landmines[i].active)
+    if (world->landmines[i].active)
     {
-      int landmineChunkX = landmines[i].x / CHUNK_SIZE;
-      int landmineChunkY = landmines[i].y / CHUNK_SIZE;
+      int landmineChunkX = world->landmines[i].x / CHUNK_SIZE;
+      int landmineChunkY = world->landmines[i].y / CHUNK_SIZE;
       int dx = abs(landmineChunkX - playerChunkX);
       int dy = abs(landmineChunkY - playerChunkY);
 
@@ -498,10 +621,14 @@ void ensureNearbyLandmines()
   }
 
   // Spawn more landmines if needed
-  while (nearbyLandmineCount < 10 && landmineCount < MAX_LANDMINES)
+  RngStream random = rngStream(rngDerive(rngSeed(RNG_SPAWN), world->gameTick), 2);
+  int spawnRounds = 0;
+  int wanted = world->tunables[TUNE_NEARBY_LANDMINES].value;
+  int rounds = spawnRoundLimit();
+  while (nearbyLandmineCount < wanted && world->landmineCount < MAX_LANDMINES && spawnRounds++ < rounds)
   {
-    int offsetX = (rand() % 5) - 2;
-    int offsetY = (rand() % 5) - 2;
+    int offsetX = rngNext(&random, 5) - 2;
+    int offsetY = rngNext(&random, 5) - 2;
     int spawnChunkX = playerChunkX + offsetX;
     int spawnChunkY = playerChunkY + offsetY;
 
@@ -509,23 +636,24 @@ void ensureNearbyLandmines()
 
     for (int attempts = 0; attempts < 10; attempts++)
     {
-      int localX = rand() % CHUNK_SIZE;
-      int localY = rand() % CHUNK_SIZE;
+      int localX = rngNext(&random, CHUNK_SIZE);
+      int localY = rngNext(&random, CHUNK_SIZE);
       int worldX = spawnChunkX * CHUNK_SIZE + localX;
       int worldY = spawnChunkY * CHUNK_SIZE + localY;
 
-      float dx = worldX - player.x;
-      float dy = worldY - player.y;
+      float dx = worldX - world->player.x;
+      float dy = worldY - world->player.y;
       float distance = sqrt(dx * dx + dy * dy);
 
-      if (distance > 150 && distance < 500)
+      if (distance > world->tunables[TUNE_LANDMINE_SPAWN_MIN].value &&
+          distance < world->tunables[TUNE_LANDMINE_SPAWN_MAX].value)
       {
         int positionFree = 1;
-        for (int j = 0; j < landmineCount; j++)
+        for (int j = 0; j < world->landmineCount; j++)
         {
-          if (landmines[j].active &&
-              abs(landmines[j].x - worldX) <= 3 &&
-              abs(landmines[j].y - worldY) <= 3)
+          if (world->landmines[j].active &&
+              abs(world->landmines[j].x - worldX) <= 3 &&
+              abs(world->landmines[j].y - worldY) <= 3)
           {
             positionFree = 0;
             break;
@@ -534,11 +662,11 @@ void ensureNearbyLandmines()
 
         if (positionFree)
         {
-          landmines[landmineCount].x = worldX;
-          landmines[landmineCount].y = worldY;
-          landmines[landmineCount].damage = 15 + rand() % 10;
-          landmines[landmineCount].active = 1;
-          landmineCount++;
+          world->landmines[world->landmineCount].x = worldX;
+          world->landmines[world->landmineCount].y = worldY;
+          world->landmines[world->landmineCount].damage = 15 + rngNext(&random, 10);
+          world->landmines[world->landmineCount].active = 1;
+          world->landmineCount++;
           nearbyLandmineCount++;
           break;
         }
@@ -547,271 +675,115 @@ void ensureNearbyLandmines()
   }
 }
 
-void drawWorld()
+// Resizes the chunk slots (never below the loaded count); 0 if out of memory
+static int resizeChunkSlots(int capacity)
 {
-  // Get camera bounds to determine what to draw
-  int camLeft = (camera.target.x - WINDOW_SIZE / 2) / CELL_SIZE - 1;
-  int camRight = (camera.target.x + WINDOW_SIZE / 2) / CELL_SIZE + 1;
-  int camTop = (camera.target.y - WINDOW_SIZE / 2) / CELL_SIZE - 1;
-  int camBottom = (camera.target.y + WINDOW_SIZE / 2) / CELL_SIZE + 1;
-
-  // Draw terrain
-  for (int worldX = camLeft; worldX <= camRight; worldX++)
-  {
-    for (int worldY = camTop; worldY <= camBottom; worldY++)
-    {
-      WorldPosition pos = worldToChunk(worldX, worldY);
-      int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
-
-      if (chunkIndex != -1)
-      {
-        int terrainType = loadedChunks[chunkIndex].terrain[pos.localX][pos.localY];
-        Color terrainColor;
+  if (capacity == world->loadedChunkCapacity)
+    return 1;
+  Chunk *resized = realloc(world->loadedChunks, sizeof(Chunk) * (size_t)capacity);
+  if (resized == NULL)
+    return capacity < world->loadedChunkCapacity; // A shrink that fails keeps the bigger block
+  world->loadedChunks = resized;
+  world->loadedChunkCapacity = capacity;
+  return 1;
+}
 
-        switch (terrainType)
-        {
-        case 0:
-          terrainColor = (Color){80, 140, 80, 220};
-          break; // Grass
-        case 1:
-          terrainColor = (Color){140, 110, 80, 220};
-          break; // Mountain
-        case 2:
-          terrainColor = (Color){50, 110, 50, 220};
-          break; // Tree
-        case 3:
-          terrainColor = (Color){80, 140, 200, 220};
-          break; // Lake
-        case 4:
-          terrainColor = (Color){50, 80, 140, 220};
-          break; // Sea
-        default:
-          terrainColor = (Color){80, 140, 80, 220};
-          break; // Default
-        }
+static int windowCapacity(int distance)
+{
+  return (2 * distance + 1) * (2 * distance + 1);
+}
 
-        DrawRectangle(worldX * CELL_SIZE, worldY * CELL_SIZE, CELL_SIZE, CELL_SIZE, terrainColor);
-      }
-      else
-      {
-        DrawRectangle(worldX * CELL_SIZE, worldY * CELL_SIZE, CELL_SIZE, CELL_SIZE, (Color){80, 140, 80, 220});
-      }
-    }
-  }
+int chunkWindow()
+{
+  return world->chunkLoadDistance;
+}
 
-  // Draw grid
-  for (int x = camLeft; x <= camRight; x++)
-  {
-    Vector2 start = {x * CELL_SIZE, camTop * CELL_SIZE};
-    Vector2 end = {x * CELL_SIZE, camBottom * CELL_SIZE};
-    DrawLineV(start, end, LIGHTGRAY);
-  }
-  for (int y = camTop; y <= camBottom; y++)
-  {
-    Vector2 start = {camLeft * CELL_SIZE, y * CELL_SIZE};
-    Vector2 end = {camRight * CELL_SIZE, y * CELL_SIZE};
-    DrawLineV(start, end, LIGHTGRAY);
-  }
+size_t chunkMemoryUsed()
+{
+  return sizeof(Chunk) * (size_t)world->loadedChunkCapacity;
+}
 
-  // Draw landmines
-  for (int i = 0; i < landmineCount; i++)
-  {
-    if (landmines[i].active)
-    {
-      DrawCircle(landmines[i].x * CELL_SIZE + CELL_SIZE / 2,
-                 landmines[i].y * CELL_SIZE + CELL_SIZE / 2,
-                 CELL_SIZE / 4, RED);
-    }
-  }
+// Bytes setChunkWindow(distance) would add (negative: free)
+long chunkWindowCost(int distance)
+{
+  return (long)sizeof(Chunk) * (windowCapacity(distance) - world->loadedChunkCapacity);
+}
 
-  // Draw powerups
-  for (int i = 0; i < powerupCount; i++)
-  {
-    if (powerups[i].active)
-    {
-      Color color;
-      switch (powerups[i].type)
-      {
-      case POWERUP_DOUBLE_DAMAGE:
-        color = ORANGE;
-        break;
-      case POWERUP_DOUBLE_HEALTH:
-        color = GREEN;
-        break;
-      case POWERUP_DOUBLE_SPEED:
-        color = BLUE;
-        break;
-      default:
-        color = WHITE;
-        break;
-      }
-      DrawCircle(powerups[i].x * CELL_SIZE + CELL_SIZE / 2,
-                 powerups[i].y * CELL_SIZE + CELL_SIZE / 2,
-                 CELL_SIZE / 3, color);
-    }
-  }
+// Sets the resident chunk window (clamped to CHUNK_MIN_LOAD_DISTANCE ..
+// CHUNK_LOAD_DISTANCE). Shrinking unloads every chunk outside the new window
+// at once, as if the LRU had evicted it, and packs the survivors into the
+// front of loadedChunks so the rest can be freed. Returns 0 if it could not
+// grow.
+int setChunkWindow(int distance)
+{
+  if (distance < CHUNK_MIN_LOAD_DISTANCE)
+    distance = CHUNK_MIN_LOAD_DISTANCE;
+  if (distance > CHUNK_LOAD_DISTANCE)
+    distance = CHUNK_LOAD_DISTANCE;
+  int capacity = windowCapacity(distance);
 
-  // Draw monsters
-  for (int i = 0; i < monsterCount; i++)
+  if (capacity > world->loadedChunkCapacity)
   {
-    if (monsters[i].alive)
-    {
-      float screenX = monsters[i].x * CELL_SIZE - camera.target.x + camera.offset.x;
-      float screenY = monsters[i].y * CELL_SIZE - camera.target.y + camera.offset.y;
-
-      if (screenX >= -CELL_SIZE && screenX <= WINDOW_SIZE + CELL_SIZE &&
-          screenY >= -CELL_SIZE && screenY <= WINDOW_SIZE + CELL_SIZE)
-      {
-        DrawTextureEx(textures[monsters[i].textureIndex],
-                      (Vector2){monsters[i].x * CELL_SIZE, monsters[i].y * CELL_SIZE},
-                      0, CELL_SIZE / 72.0f, WHITE);
-
-        // Health bar
-        DrawRectangle(monsters[i].x * CELL_SIZE, monsters[i].y * CELL_SIZE - 5,
-                      CELL_SIZE, 3, RED);
-        DrawRectangle(monsters[i].x * CELL_SIZE, monsters[i].y * CELL_SIZE - 5,
-                      (float)monsters[i].health / monsters[i].maxHealth * CELL_SIZE, 3, GREEN);
-      }
-    }
+    if (!resizeChunkSlots(capacity))
+      return 0;
+    world->chunkLoadDistance = distance;
+    return 1;
   }
 
-  // Draw player
-  if (player.alive)
-  {
-    Color playerColor = WHITE;
-    if (player.invulnerabilityTimer > 0)
-    {
-      if ((player.invulnerabilityTimer / 10) % 2 == 0)
-      {
-        playerColor = YELLOW;
-      }
-      else
-      {
-        playerColor = Fade(WHITE, 0.3f);
-      }
-    }
-
-    DrawTextureEx(textures[player.textureIndex],
-                  (Vector2){player.x * CELL_SIZE, player.y * CELL_SIZE},
-                  0, CELL_SIZE / 72.0f, playerColor);
-
-    // Health bar
-    DrawRectangle(player.x * CELL_SIZE, player.y * CELL_SIZE - 5,
-                  CELL_SIZE, 3, RED);
-    DrawRectangle(player.x * CELL_SIZE, player.y * CELL_SIZE - 5,
-                  (float)player.health / player.maxHealth * CELL_SIZE, 3, GREEN);
-  }
-}
+  // Edits still waiting for a flush name chunks by slot
+  flushTerrainEdits();
 
-void drawMinimap()
-{
-  int minimapSize = 120;
-  int minimapX = WINDOW_SIZE - minimapSize - 10;
-  int minimapY = WINDOW_SIZE - minimapSize - 10;
-  int minimapScale = 3;
-
-  // Draw minimap background
-  DrawRectangle(minimapX, minimapY, minimapSize, minimapSize, (Color){0, 0, 0, 180});
-  DrawRectangleLines(minimapX, minimapY, minimapSize, minimapSize, WHITE);
-
-  // Calculate minimap bounds
-  int minimapCenterX = player.x;
-  int minimapCenterY = player.y;
-  int minimapHalfSize = (minimapSize / 2) * minimapScale;
-
-  int minimapLeft = minimapCenterX - minimapHalfSize;
-  int minimapRight = minimapCenterX + minimapHalfSize;
-  int minimapTop = minimapCenterY - minimapHalfSize;
-  int minimapBottom = minimapCenterY + minimapHalfSize;
-
-  // Draw terrain on minimap
-  for (int worldX = minimapLeft; worldX <= minimapRight; worldX += minimapScale)
+  int playerChunkX = world->player.x / CHUNK_SIZE;
+  int playerChunkY = world->player.y / CHUNK_SIZE;
+  for (int i = 0; i < world->loadedChunkCount; i++)
   {
-    for (int worldY = minimapTop; worldY <= minimapBottom; worldY += minimapScale)
+    if (abs(world->loadedChunks[i].chunkX - playerChunkX) > distance || abs(world->loadedChunks[i].chunkY - playerChunkY) > distance)
     {
-      WorldPosition pos = worldToChunk(worldX, worldY);
-      int chunkIndex = getChunkIndex(pos.chunkX, pos.chunkY);
-
-      if (chunkIndex != -1)
-      {
-        int terrainType = loadedChunks[chunkIndex].terrain[pos.localX][pos.localY];
-        Color terrainColor;
-
-        switch (terrainType)
-        {
-        case 0:
-          terrainColor = (Color){80, 140, 80, 255};
-          break;
-        case 1:
-          terrainColor = (Color){140, 110, 80, 255};
-          break;
-        case 2:
-          terrainColor = (Color){50, 110, 50, 255};
-          break;
-        case 3:
-          terrainColor = (Color){80, 140, 200, 255};
-          break;
-        case 4:
-          terrainColor = (Color){50, 80, 140, 255};
-          break;
-        default:
-          terrainColor = (Color){80, 140, 80, 255};
-          break;
-        }
-
-        int minimapPixelX = minimapX + ((worldX - minimapLeft) / minimapScale);
-        int minimapPixelY = minimapY + ((worldY - minimapTop) / minimapScale);
-
-        if (minimapPixelX >= minimapX && minimapPixelX < minimapX + minimapSize &&
-            minimapPixelY >= minimapY && minimapPixelY < minimapY + minimapSize)
-        {
-          DrawRectangle(minimapPixelX, minimapPixelY, 1, 1, terrainColor);
-        }
-      }
+      evictChunk(i);
+      world->loadedChunks[i].loaded = 0;
     }
   }
 
-  // Draw player on minimap
-  int playerMinimapX = minimapX + (minimapSize / 2);
-  int playerMinimapY = minimapY + (minimapSize / 2);
-  DrawRectangle(playerMinimapX - 1, playerMinimapY - 1, 3, 3, YELLOW);
-
-  // Draw monsters on minimap
-  for (int i = 0; i < monsterCount; i++)
+  int newIndex[MAX_LOADED_CHUNKS];
+  int kept = 0;
+  for (int i = 0; i < world->loadedChunkCount; i++)
   {
-    int monsterMinimapX = minimapX + (minimapSize / 2) + ((monsters[i].x - player.x) / minimapScale);
-    int monsterMinimapY = minimapY + (minimapSize / 2) + ((monsters[i].y - player.y) / minimapScale);
-
-    if (monsterMinimapX >= minimapX && monsterMinimapX < minimapX + minimapSize &&
-        monsterMinimapY >= minimapY && monsterMinimapY < minimapY + minimapSize)
-    {
-      DrawRectangle(monsterMinimapX, monsterMinimapY, 1, 1, RED);
-    }
+    newIndex[i] = kept;
+    if (!world->loadedChunks[i].loaded)
+      continue;
+    if (kept != i)
+      world->loadedChunks[kept] = world->loadedChunks[i];
+    kept++;
   }
+  world->loadedChunkCount = kept;
 
-  // Draw powerups on minimap
-  for (int i = 0; i < powerupCount; i++)
-  {
-    int powerupMinimapX = minimapX + (minimapSize / 2) + ((powerups[i].x - player.x) / minimapScale);
-    int powerupMinimapY = minimapY + (minimapSize / 2) + ((powerups[i].y - player.y) / minimapScale);
+  resetChunkLookup();
+  for (int i = 0; i < world->loadedChunkCount; i++)
+    insertChunkLookup(i);
+  moveFireChunks(newIndex);
+  forgetLightChunk();
+  invalidateLineOfSight();
 
-    if (powerupMinimapX >= minimapX && powerupMinimapX < minimapX + minimapSize &&
-        powerupMinimapY >= minimapY && powerupMinimapY < minimapY + minimapSize)
-    {
-      DrawRectangle(powerupMinimapX, powerupMinimapY, 1, 1, GREEN);
-    }
-  }
+  resizeChunkSlots(capacity);
+  world->chunkLoadDistance = distance;
+  return 1;
+}
 
-  // Draw landmines on minimap
-  for (int i = 0; i < landmineCount; i++)
+// Loaded chunks are streamed up to their count; restoring first sizes the
+// slots for the saved window
+void streamWorldState(StateStream *stream)
+{
+  stateBlock(stream, &world->chunkLoadDistance, sizeof(world->chunkLoadDistance));
+  stateBlock(stream, &world->loadedChunkCount, sizeof(world->loadedChunkCount));
+  if (stream->restoring && !resizeChunkSlots(windowCapacity(world->chunkLoadDistance)))
   {
-    int landmineMinimapX = minimapX + (minimapSize / 2) + ((landmines[i].x - player.x) / minimapScale);
-    int landmineMinimapY = minimapY + (minimapSize / 2) + ((landmines[i].y - player.y) / minimapScale);
-
-    if (landmineMinimapX >= minimapX && landmineMinimapX < minimapX + minimapSize &&
-        landmineMinimapY >= minimapY && landmineMinimapY < minimapY + minimapSize)
-    {
-      DrawRectangle(landmineMinimapX, landmineMinimapY, 1, 1, ORANGE);
-    }
+    // Out of memory: drop the chunks and let updateChunks load them again
+    stream->offset += sizeof(Chunk) * (size_t)world->loadedChunkCount + sizeof(world->chunkLookup);
+    world->chunkLoadDistance = CHUNK_MIN_LOAD_DISTANCE;
+    world->loadedChunkCount = 0;
+    resetChunkLookup();
+    return;
   }
+  stateBlock(stream, world->loadedChunks, sizeof(Chunk) * (size_t)world->loadedChunkCount);
+  stateBlock(stream, world->chunkLookup, sizeof(world->chunkLookup));
 }
@@ -2,19 +2,25 @@
 #define WORLD_H
 
 #include "types.h"
+#include <stddef.h>
+
+#define CHUNK_LOOKUP_SIZE 2048 // Slots of the chunk coordinate hash table (World.chunkLookup)
 
 // Function declarations for world management
 void updateChunks();
 void ensureNearbyMonsters();
 void ensureNearbyPowerups();
 void ensureNearbyLandmines();
-void drawWorld();
-void drawMinimap();
 WorldPosition worldToChunk(int worldX, int worldY);
 int getChunkIndex(int chunkX, int chunkY);
+void resetChunkLookup();
 int loadChunk(int chunkX, int chunkY);
 void unloadChunkEntities(int chunkIndex);
 void generateChunkContent(int chunkX, int chunkY);
 void generateChunkTerrain(int chunkX, int chunkY);
+int chunkWindow();
+int setChunkWindow(int distance);
+long chunkWindowCost(int distance);
+size_t chunkMemoryUsed();
 
 #endif